@@ -0,0 +1,114 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+	// 64 位进程为每个数组预留 8 GB 地址空间（不占物理内存），超出后迁移到堆内存
+	const qint64 kReserveBytes = sizeof(void*) >= 8 ? (qint64(8) << 30) : 0;
+	const qint64 kCommitChunk = qint64(64) << 10;	//首次提交 64 KB，之后按已提交量翻倍，均为其整数倍
+}
+
+VirtualArena::VirtualArena()
+	: m_base(nullptr), m_size(0), m_committed(0), m_reserved(0), b_fallback(false) {
+}
+
+VirtualArena::~VirtualArena() {
+	clear();
+}
+
+bool VirtualArena::reserve() {
+	if (kReserveBytes == 0) return false;
+#ifdef Q_OS_WIN
+	void* base = VirtualAlloc(nullptr, static_cast<SIZE_T>(kReserveBytes), MEM_RESERVE, PAGE_NOACCESS);
+	if (!base) return false;
+#else
+	void* base = mmap(nullptr, static_cast<size_t>(kReserveBytes), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED) return false;
+#endif
+	m_base = static_cast<char*>(base);
+	m_reserved = kReserveBytes;
+	return true;
+}
+
+bool VirtualArena::commit(qint64 bytes) {
+	// 小数组只占少量物理页，大数组的 mprotect/VirtualAlloc 次数按对数增长
+	const qint64 wanted = std::max(bytes, m_committed * 2);
+	const qint64 target = std::min(m_reserved, (wanted + kCommitChunk - 1) / kCommitChunk * kCommitChunk);
+#ifdef Q_OS_WIN
+	if (!VirtualAlloc(m_base + m_committed, static_cast<SIZE_T>(target - m_committed), MEM_COMMIT, PAGE_READWRITE)) return false;
+#else
+	if (mprotect(m_base + m_committed, static_cast<size_t>(target - m_committed), PROT_READ | PROT_WRITE) != 0) return false;
+#endif
+	m_committed = target;
+	return true;
+}
+
+bool VirtualArena::resize(qint64 bytes) {
+	if (bytes <= m_committed) {
+		m_size = bytes;
+		return true;
+	}
+	if (!m_base && !b_fallback && !reserve()) b_fallback = true;
+	if (!b_fallback && bytes > m_reserved) {
+		// 预留的地址空间用尽：一次性复制到堆内存，之后按 realloc 增长
+		char* heap = static_cast<char*>(std::malloc(static_cast<size_t>(bytes)));
+		if (!heap) return false;
+		std::memcpy(heap, m_base, static_cast<size_t>(m_size));
+#ifdef Q_OS_WIN
+		VirtualFree(m_base, 0, MEM_RELEASE);
+#else
+		munmap(m_base, static_cast<size_t>(m_reserved));
+#endif
+		m_base = heap;
+		m_committed = bytes;
+		m_reserved = 0;
+		b_fallback = true;
+	}
+
+	if (b_fallback) {
+		if (bytes <= m_committed) {
+			m_size = bytes;
+			return true;
+		}
+		// 无法预留地址空间：按 1.5 倍增长的普通堆内存
+		const qint64 capacity = std::max(bytes, m_committed + m_committed / 2);
+		char* grown = static_cast<char*>(std::realloc(m_base, static_cast<size_t>(capacity)));
+		if (!grown) return false;
+		m_base = grown;
+		m_committed = capacity;
+	}
+	else if (!commit(bytes)) {
+		return false;
+	}
+	m_size = bytes;
+	return true;
+}
+
+void VirtualArena::clear() {
+	if (m_base) {
+		if (b_fallback) {
+			std::free(m_base);
+		}
+		else {
+#ifdef Q_OS_WIN
+			VirtualFree(m_base, 0, MEM_RELEASE);
+#else
+			munmap(m_base, static_cast<size_t>(m_reserved));
+#endif
+		}
+	}
+	m_base = nullptr;
+	m_size = 0;
+	m_committed = 0;
+	m_reserved = 0;
+	b_fallback = false;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <QtGlobal>
+#include <type_traits>
+
+// 按需提交的连续内存区：一次预留大段地址空间，增长时只提交新的物理页，
+// 已有数据从不搬移，也不会像 QVector 扩容那样短时间内同时持有新旧两份；
+// 析构或 clear() 时整段归还。首次增长时才预留；预留失败（如 32 位进程）或用尽时退化为 realloc
+class VirtualArena {
+public:
+	VirtualArena();
+	~VirtualArena();
+	VirtualArena(const VirtualArena&) = delete;
+	VirtualArena& operator=(const VirtualArena&) = delete;
+
+	char* data() const { return m_base; }
+	qint64 size() const { return m_size; }	//已使用的字节数
+	qint64 committed() const { return m_committed; }	//已提交的字节数
+
+	bool resize(qint64 bytes);	//扩大时从 64 KB 起倍增提交，缩小时保留已提交的页
+	void clear();	//归还全部内存
+
+private:
+	bool reserve();
+	bool commit(qint64 bytes);
+
+	char* m_base;
+	qint64 m_size;
+	qint64 m_committed;
+	qint64 m_reserved;	//预留的地址空间；0 表示使用 realloc
+	bool b_fallback;
+};
+
+// 基于 VirtualArena 的平凡类型数组，元素的地址在增长过程中保持不变
+template <typename T>
+class ArenaArray {
+	static_assert(std::is_trivially_copyable<T>::value, "ArenaArray holds trivially copyable types only");
+public:
+	qint64 size() const { return m_arena.size() / qint64(sizeof(T)); }
+	bool isEmpty() const { return m_arena.size() == 0; }
+	T* data() { return reinterpret_cast<T*>(m_arena.data()); }
+	const T* constData() const { return reinterpret_cast<const T*>(m_arena.data()); }
+	T& operator[](qint64 i) { return data()[i]; }
+	const T& operator[](qint64 i) const { return constData()[i]; }
+	const T& last() const { return constData()[size() - 1]; }
+	qint64 memoryUsage() const { return m_arena.committed(); }
+
+	// 末尾追加 count 个未初始化的元素，返回其起始地址
+	T* grow(qint64 count) {
+		const qint64 start = size();
+		if (!m_arena.resize((start + count) * qint64(sizeof(T)))) qFatal("ArenaArray: out of memory");
+		return data() + start;
+	}
+	void append(const T& value) { *grow(1) = value; }
+	void resize(qint64 count) {
+		if (!m_arena.resize(count * qint64(sizeof(T)))) qFatal("ArenaArray: out of memory");
+	}
+	void clear() { m_arena.clear(); }
+
+private:
+	VirtualArena m_arena;
+};
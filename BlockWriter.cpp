@@ -0,0 +1,58 @@
+#include "BlockWriter.h"
+#include <QPromise>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <atomic>
+#include <vector>
+#include <gdal_priv.h>
+#include "GdalRuntime.h"
+
+QString BlockWriter::run(GDALDataset* target, const QVector<QRect>& windows, GDALDataType bufferType,
+	const Producer& produce, QPromise<QString>* promise) {
+	const QByteArray outputPath(target->GetDescription());
+	GDALDriver* driver = target->GetDriver();
+	GDALRasterBand* targetBand = target->GetRasterBand(1);
+	const int pixelBytes = GDALGetDataTypeSizeBytes(bufferType);
+
+	if (promise) promise->setProgressRange(0, windows.size());
+
+	QMutex writeMutex;
+	QString workerError;
+	std::atomic<bool> failed(false);
+	std::atomic<int> finished(0);
+	QtConcurrent::blockingMap(GdalRuntime::analysisPool(), windows, [&](const QRect& window) {
+		if (failed.load() || (promise && promise->isCanceled())) return;
+
+		// 输出缓冲区按线程复用
+		thread_local std::vector<char> buffer;
+		buffer.resize(static_cast<size_t>(window.width()) * window.height() * pixelBytes);
+		const QString error = produce(window, buffer.data());
+		if (!error.isEmpty()) {
+			QMutexLocker locker(&writeMutex);
+			if (!failed.exchange(true)) workerError = error;
+			return;
+		}
+
+		QMutexLocker locker(&writeMutex);
+		if (failed.load()) return;
+		if (targetBand->RasterIO(GF_Write, window.x(), window.y(), window.width(), window.height(),
+			buffer.data(), window.width(), window.height(), bufferType, 0, 0, nullptr) != CE_None) {
+			failed = true;
+			workerError = QString("写入输出失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+			return;
+		}
+		locker.unlock();
+		if (promise) promise->setProgressValue(++finished);
+		});
+	GDALClose(target);
+
+	const bool canceled = promise && promise->isCanceled();
+	if (failed.load() || canceled) {
+		CPLPushErrorHandler(CPLQuietErrorHandler);
+		if (driver) driver->Delete(outputPath.constData());
+		CPLPopErrorHandler();
+		return canceled ? QString("已取消") : workerError;
+	}
+	return QString();
+}
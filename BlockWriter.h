@@ -0,0 +1,23 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QRect>
+#include <functional>
+#include <gdal.h>
+
+class GDALDataset;
+template<typename T> class QPromise;
+
+// 按窗口并行生成、串行写出单波段栅格：工作线程在共享分析线程池中计算各窗口的像素，
+// 写入目标数据集时加锁（GDALDataset 不能被多个线程同时写入）。
+// 任一窗口失败或任务被取消时不再处理剩余窗口，并删除输出文件
+namespace BlockWriter {
+	// 在工作线程中调用：把 window 的像素按行连续写入 pixels（类型为 run 的 bufferType），
+	// 成功返回空字符串，否则返回错误信息
+	using Producer = std::function<QString(const QRect& window, void* pixels)>;
+
+	// 写入 target 的第 1 波段，结束后关闭 target。成功返回空字符串，否则返回错误信息；
+	// promise 非空时以窗口数汇报进度并响应取消
+	QString run(GDALDataset* target, const QVector<QRect>& windows, GDALDataType bufferType,
+		const Producer& produce, QPromise<QString>* promise);
+}
@@ -0,0 +1,229 @@
+#include "DataConversion.h"
+#include <QPromise>
+#include <QFileInfo>
+#include <QRect>
+#include <QRectF>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <gdal_priv.h>
+#include <gdal_alg.h>
+#include <ogrsf_frmts.h>
+#include "BlockWriter.h"
+#include "DatasetPool.h"
+#include "SpatialIndex.h"
+
+namespace {
+	const int kTileSize = 256;	//输出分块边长，也是栅格化窗口的行数
+	const int kWindowPixels = 1 << 22;	//每个栅格化窗口的像素上限
+
+	// GDAL 进度回调 -> QPromise（0 - 100），取消时返回 FALSE 中止
+	int CPL_STDCALL promiseProgress(double complete, const char*, void* data) {
+		QPromise<QString>* promise = static_cast<QPromise<QString>*>(data);
+		if (!promise) return TRUE;
+		if (promise->isCanceled()) return FALSE;
+		promise->setProgressValue(static_cast<int>(complete * 100));
+		return TRUE;
+	}
+
+	void deleteOutput(const char* driverName, const QString& outputPath) {
+		if (GDALDriver* driver = GetGDALDriverManager()->GetDriverByName(driverName)) {
+			CPLPushErrorHandler(CPLQuietErrorHandler);
+			driver->Delete(outputPath.toUtf8().constData());
+			CPLPopErrorHandler();
+		}
+	}
+}
+
+QString DataConversion::polygonize(const QString& rasterPath, int bandIndex, const QString& outputPath,
+	QPromise<QString>* promise) {
+	DatasetHandle source = DatasetPool::instance().acquire(rasterPath);
+	if (!source) return QString("无法打开栅格：%1").arg(rasterPath);
+	if (bandIndex < 1 || bandIndex > source->GetRasterCount()) return QString("波段 %1 不存在").arg(bandIndex);
+	GDALRasterBand* band = source->GetRasterBand(bandIndex);
+	const bool isFloating = GDALDataTypeIsFloating(band->GetRasterDataType());
+
+	// NoData 或掩膜波段以外的像元不参与
+	GDALRasterBand* mask = (band->GetMaskFlags() & GMF_ALL_VALID) ? nullptr : band->GetMaskBand();
+
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("ESRI Shapefile");
+	if (!driver) return QString("无法获取 Shapefile 驱动");
+	DatasetPool::instance().prepareOutput(outputPath, driver);
+	GDALDataset* output = driver->Create(outputPath.toUtf8().constData(), 0, 0, 0, GDT_Unknown, nullptr);
+	if (!output) return QString("无法创建输出文件：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+
+	OGRSpatialReference srs;
+	const char* wkt = source->GetProjectionRef();
+	const bool hasSrs = wkt && wkt[0] && srs.importFromWkt(wkt) == OGRERR_NONE;
+	OGRLayer* layer = output->CreateLayer(QFileInfo(outputPath).completeBaseName().toUtf8().constData(),
+		hasSrs ? &srs : nullptr, wkbPolygon, nullptr);
+	OGRFieldDefn valueField("value", isFloating ? OFTReal : OFTInteger);
+	if (!layer || layer->CreateField(&valueField) != OGRERR_NONE) {
+		GDALClose(output);
+		return QString("无法创建输出图层");
+	}
+
+	// 逐行扫描，内存只与影像宽度有关
+	if (promise) promise->setProgressRange(0, 100);
+	const CPLErr err = isFloating
+		? GDALFPolygonize(static_cast<GDALRasterBandH>(band), mask ? static_cast<GDALRasterBandH>(mask) : nullptr,
+			static_cast<OGRLayerH>(layer), 0, nullptr, promiseProgress, promise)
+		: GDALPolygonize(static_cast<GDALRasterBandH>(band), mask ? static_cast<GDALRasterBandH>(mask) : nullptr,
+			static_cast<OGRLayerH>(layer), 0, nullptr, promiseProgress, promise);
+	GDALClose(output);
+
+	if (promise && promise->isCanceled()) {
+		deleteOutput("ESRI Shapefile", outputPath);
+		return QString("已取消");
+	}
+	if (err != CE_None) {
+		deleteOutput("ESRI Shapefile", outputPath);
+		return QString("栅格转面失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+	}
+	return QString();
+}
+
+QString DataConversion::rasterize(const QString& vectorPath, const QString& attribute, double pixelSize, const QString& outputPath,
+	QPromise<QString>* promise) {
+	if (!(pixelSize > 0.0)) return QString("像元大小须大于 0");
+
+	DatasetHandle vector = DatasetPool::instance().acquire(vectorPath);
+	if (!vector || !vector->GetLayer(0)) return QString("无法打开矢量图层：%1").arg(vectorPath);
+	OGRLayer* layer = vector->GetLayer(0);
+
+	// 输出类型与 NoData 由写入的值决定
+	int fieldIndex = -1;
+	GDALDataType dataType = GDT_Byte;
+	double noData = 0.0;
+	if (!attribute.isEmpty()) {
+		fieldIndex = layer->GetLayerDefn()->GetFieldIndex(attribute.toUtf8().constData());
+		if (fieldIndex < 0) return QString("字段 %1 不存在").arg(attribute);
+		const OGRFieldType fieldType = layer->GetLayerDefn()->GetFieldDefn(fieldIndex)->GetType();
+		if (fieldType == OFTInteger) {
+			dataType = GDT_Int32;
+			noData = INT_MIN;
+		}
+		else if (fieldType == OFTInteger64 || fieldType == OFTReal) {
+			dataType = GDT_Float32;
+			noData = -3.4028234663852886e+38;
+		}
+		else {
+			return QString("字段 %1 不是数值字段").arg(attribute);
+		}
+	}
+
+	// 范围对齐到像元大小的整数倍
+	OGREnvelope envelope;
+	if (layer->GetExtent(&envelope, TRUE) != OGRERR_NONE) return QString("无法读取图层范围");
+	const double originX = std::floor(envelope.MinX / pixelSize) * pixelSize;
+	const double originY = std::ceil(envelope.MaxY / pixelSize) * pixelSize;
+	const double columns = std::ceil((envelope.MaxX - originX) / pixelSize);
+	const double rows = std::ceil((originY - envelope.MinY) / pixelSize);
+	if (columns > INT_MAX / 2 || rows > INT_MAX / 2) return QString("像元大小过小，输出栅格过大");
+	const int width = std::max(1, static_cast<int>(columns));
+	const int height = std::max(1, static_cast<int>(rows));
+	const double geoTransform[6] = { originX, pixelSize, 0.0, originY, 0.0, -pixelSize };
+
+	// 几何读入一次，建立 R 树；每个分块只栅格化与之相交的要素
+	SpatialIndex index;
+	std::vector<OGRGeometryH> geometries;
+	std::vector<double> burnValues;
+	struct T_GeometryGuard {
+		std::vector<OGRGeometryH>& geometries;
+		~T_GeometryGuard() { for (OGRGeometryH geometry : geometries) OGR_G_DestroyGeometry(geometry); }
+	} guard{ geometries };
+
+	layer->ResetReading();
+	while (OGRFeature* feature = layer->GetNextFeature()) {
+		OGRGeometry* geometry = feature->StealGeometry();
+		const double value = fieldIndex < 0 ? 1.0 : feature->GetFieldAsDouble(fieldIndex);
+		const bool hasValue = fieldIndex < 0 || feature->IsFieldSetAndNotNull(fieldIndex);
+		OGRFeature::DestroyFeature(feature);
+		if (!geometry) continue;
+		if (!hasValue || geometry->IsEmpty()) {
+			delete geometry;
+			continue;
+		}
+		OGREnvelope bounds;
+		geometry->getEnvelope(&bounds);
+		index.add(QRectF(QPointF(bounds.MinX, bounds.MinY), QPointF(bounds.MaxX, bounds.MaxY)));
+		geometries.push_back(static_cast<OGRGeometryH>(geometry));
+		burnValues.push_back(value);
+	}
+	index.finish();
+	const OGRSpatialReference* layerSrs = layer->GetSpatialRef();
+	char* wkt = nullptr;
+	if (layerSrs) layerSrs->exportToWkt(&wkt);
+	const QByteArray projection(wkt ? wkt : "");
+	CPLFree(wkt);
+	vector.reset();
+
+	// 输出：分块、LZW 压缩
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+	GDALDriver* memDriver = GetGDALDriverManager()->GetDriverByName("MEM");
+	if (!driver || !memDriver) return QString("无法获取 GTiff 驱动");
+	char** options = nullptr;
+	options = CSLSetNameValue(options, "TILED", "YES");
+	options = CSLSetNameValue(options, "BLOCKXSIZE", QByteArray::number(kTileSize).constData());
+	options = CSLSetNameValue(options, "BLOCKYSIZE", QByteArray::number(kTileSize).constData());
+	options = CSLSetNameValue(options, "COMPRESS", "LZW");
+	options = CSLSetNameValue(options, "BIGTIFF", "IF_NEEDED");
+	options = CSLSetNameValue(options, "NUM_THREADS", "ALL_CPUS");
+	DatasetPool::instance().prepareOutput(outputPath, driver);
+	GDALDataset* target = driver->Create(outputPath.toUtf8().constData(), width, height, 1, dataType, options);
+	CSLDestroy(options);
+	if (!target) return QString("无法创建输出文件：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+	target->SetGeoTransform(const_cast<double*>(geoTransform));
+	if (!projection.isEmpty()) target->SetProjection(projection.constData());
+	GDALRasterBand* targetBand = target->GetRasterBand(1);
+	targetBand->SetNoDataValue(noData);
+
+	// 窗口与输出分块对齐
+	const int windowColumns = std::min(width, std::max(kTileSize, kWindowPixels / kTileSize / kTileSize * kTileSize));
+	QVector<QRect> windows;
+	for (int y = 0; y < height; y += kTileSize) {
+		for (int x = 0; x < width; x += windowColumns) {
+			windows.append(QRect(x, y, std::min(windowColumns, width - x), std::min(kTileSize, height - y)));
+		}
+	}
+	return BlockWriter::run(target, windows, GDT_Float64, [&](const QRect& window, void* pixels) {
+		// 窗口对应的内存数据集，先填充 NoData
+		std::unique_ptr<GDALDataset> tile(memDriver->Create("", window.width(), window.height(), 1, dataType, nullptr));
+		if (!tile) return QString("无法创建内存数据集");
+		double tileTransform[6] = { originX + window.x() * pixelSize, pixelSize, 0.0, originY - window.y() * pixelSize, 0.0, -pixelSize };
+		tile->SetGeoTransform(tileTransform);
+		GDALRasterBand* tileBand = tile->GetRasterBand(1);
+		tileBand->Fill(noData);
+
+		const QRectF tileExtent(QPointF(tileTransform[0], tileTransform[3] - window.height() * pixelSize),
+			QPointF(tileTransform[0] + window.width() * pixelSize, tileTransform[3]));
+		QVector<int> hits = index.search(tileExtent);
+		if (!hits.isEmpty()) {
+			// 条目编号即读入顺序，按此顺序栅格化，重叠处后读入的要素覆盖先读入的
+			std::sort(hits.begin(), hits.end());
+			std::vector<OGRGeometryH> tileGeometries;
+			std::vector<double> tileValues;
+			tileGeometries.reserve(hits.size());
+			tileValues.reserve(hits.size());
+			for (int hit : hits) {
+				tileGeometries.push_back(geometries[hit]);
+				tileValues.push_back(burnValues[hit]);
+			}
+
+			int bandList = 1;
+			if (GDALRasterizeGeometries(static_cast<GDALDatasetH>(tile.get()), 1, &bandList,
+				static_cast<int>(tileGeometries.size()), tileGeometries.data(), nullptr, nullptr,
+				tileValues.data(), nullptr, nullptr, nullptr) != CE_None) {
+				return QString("栅格化失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+			}
+		}
+
+		if (tileBand->RasterIO(GF_Read, 0, 0, window.width(), window.height(), pixels,
+			window.width(), window.height(), GDT_Float64, 0, 0, nullptr) != CE_None) {
+			return QString("栅格化失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+		}
+		return QString();
+		}, promise);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <QString>
+
+template<typename T> class QPromise;
+
+// 栅格与矢量互转。两者都只在工作窗口内占用像素内存，与影像大小无关；
+// 成功返回空字符串，否则返回错误信息。promise 非空时汇报进度并响应取消。耗时较长，应在后台线程调用
+namespace DataConversion {
+	// 栅格转面（GDALPolygonize）：相同像素值的连通区域生成一个面，像素值写入 value 字段；
+	// NoData 与掩膜外的像元不生成面。浮点波段按浮点值比较。输出 Shapefile，进度范围 0 - 100
+	QString polygonize(const QString& rasterPath, int bandIndex, const QString& outputPath,
+		QPromise<QString>* promise = nullptr);
+
+	// 矢量转栅格（GDALRasterizeGeometries）：按 pixelSize 覆盖图层范围，attribute 为空时要素写 1（Byte），
+	// 否则写该数值字段的值（整数字段为 Int32，其余为 Float32）；要素以外为 NoData。
+	// 几何读入一次并建立 R 树，输出按 256 行的分块在工作线程中并行栅格化，每块只处理与之相交的要素。
+	// 输出分块压缩的 GeoTIFF，进度范围为分块数
+	QString rasterize(const QString& vectorPath, const QString& attribute, double pixelSize, const QString& outputPath,
+		QPromise<QString>* promise = nullptr);
+}
@@ -0,0 +1,195 @@
+#include "DatasetPool.h"
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+#include <utility>
+#include <gdal_priv.h>
+#include "GdalRuntime.h"
+
+namespace {
+	const int kDefaultIdleTimeout = 30000;	//空闲 30 秒后关闭
+	const int kSweepInterval = 5000;
+	const int kRecheckInterval = 2000;	//两次核对文件修改时间的最小间隔
+
+	QString entryKey(const QString& filePath) {
+		return filePath + QLatin1Char('|') +
+			QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId()), 16);
+	}
+}
+
+DatasetHandle::DatasetHandle(DatasetHandle&& other) noexcept
+	: m_dataset(other.m_dataset) {
+	other.m_dataset = nullptr;
+}
+
+DatasetHandle& DatasetHandle::operator=(DatasetHandle&& other) noexcept {
+	if (this != &other) {
+		reset();
+		m_dataset = other.m_dataset;
+		other.m_dataset = nullptr;
+	}
+	return *this;
+}
+
+DatasetHandle::~DatasetHandle() {
+	reset();
+}
+
+void DatasetHandle::reset() {
+	if (m_dataset) {
+		DatasetPool::instance().release(m_dataset);
+		m_dataset = nullptr;
+	}
+}
+
+DatasetPool& DatasetPool::instance() {
+	static DatasetPool pool;
+	return pool;
+}
+
+DatasetPool::DatasetPool()
+	: m_idleTimeout(kDefaultIdleTimeout), m_sweepTimer(nullptr) {
+	// 定时清理须在主线程的事件循环中进行，池可能首先在瓦片线程中被访问
+	if (QCoreApplication* app = QCoreApplication::instance()) {
+		m_sweepTimer = new QTimer;
+		m_sweepTimer->setInterval(kSweepInterval);
+		m_sweepTimer->moveToThread(app->thread());
+		QObject::connect(m_sweepTimer, &QTimer::timeout, m_sweepTimer, [this]() { closeIdle(); });
+		QObject::connect(app, &QCoreApplication::aboutToQuit, m_sweepTimer, [this]() {
+			m_sweepTimer->stop();
+			closeAll();
+			});
+		QMetaObject::invokeMethod(m_sweepTimer, qOverload<>(&QTimer::start), Qt::QueuedConnection);
+	}
+}
+
+DatasetPool::~DatasetPool() {
+	closeAll();
+	delete m_sweepTimer;
+}
+
+DatasetHandle DatasetPool::acquire(const QString& filePath) {
+	if (filePath.isEmpty()) return DatasetHandle();
+	GdalRuntime::initialize();	//工作线程可能先于主窗口打开数据集
+
+	const QString key = entryKey(filePath);
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	{
+		QMutexLocker locker(&m_mutex);
+		if (T_PoolEntry* entry = m_entries.value(key)) {
+			if (!isOutdated(entry, now)) {
+				entry->refCount++;
+				return DatasetHandle(entry->dataset);
+			}
+			// 文件已在外部被改写：旧句柄不再复用
+			m_entries.remove(key);
+			entry->stale = true;
+			if (entry->refCount == 0) closeEntry(entry);
+		}
+	}
+
+	// 在锁外打开文件，网络或压缩数据可能很慢
+	GDALDataset* dataset = static_cast<GDALDataset*>(GDALOpenEx(filePath.toUtf8().constData(),
+		GDAL_OF_RASTER | GDAL_OF_VECTOR | GDAL_OF_READONLY | GDAL_OF_VERBOSE_ERROR, nullptr, nullptr, nullptr));
+	if (!dataset) return DatasetHandle();
+
+	T_PoolEntry* entry = new T_PoolEntry;
+	entry->dataset = dataset;
+	entry->key = key;
+	entry->filePath = filePath;
+	entry->refCount = 1;
+	entry->lastUsed = entry->lastChecked = now;
+	QFileInfo fileInfo(filePath);
+	if (fileInfo.exists()) {
+		entry->modified = fileInfo.lastModified();
+		entry->fileSize = fileInfo.size();
+	}
+
+	QMutexLocker locker(&m_mutex);
+	m_entries.insert(key, entry);	//同一线程内不会并发打开同一路径
+	m_byDataset.insert(dataset, entry);
+	return DatasetHandle(dataset);
+}
+
+bool DatasetPool::isOutdated(T_PoolEntry* entry, qint64 now) const {
+	// 使用中的句柄不核对；同一文件的瓦片请求很密集，核对频率也要限制
+	if (entry->refCount > 0 || entry->fileSize < 0 || now - entry->lastChecked < kRecheckInterval) return false;
+	entry->lastChecked = now;
+	QFileInfo fileInfo(entry->filePath);
+	return !fileInfo.exists() || fileInfo.lastModified() != entry->modified || fileInfo.size() != entry->fileSize;
+}
+
+void DatasetPool::release(GDALDataset* dataset) {
+	QMutexLocker locker(&m_mutex);
+	T_PoolEntry* entry = m_byDataset.value(dataset);
+	if (!entry) return;
+
+	entry->refCount--;
+	entry->lastUsed = QDateTime::currentMSecsSinceEpoch();
+	if (entry->refCount == 0 && entry->stale) closeEntry(entry);
+}
+
+void DatasetPool::invalidate(const QString& filePath) {
+	QMutexLocker locker(&m_mutex);
+	for (auto it = m_entries.begin(); it != m_entries.end();) {
+		T_PoolEntry* entry = it.value();
+		if (entry->filePath != filePath) {
+			++it;
+			continue;
+		}
+		it = m_entries.erase(it);
+		entry->stale = true;
+		if (entry->refCount == 0) closeEntry(entry);
+	}
+}
+
+void DatasetPool::prepareOutput(const QString& filePath, GDALDriver* driver) {
+	invalidate(filePath);	//Windows 下文件打开时无法删除
+	CPLPushErrorHandler(CPLQuietErrorHandler);	//文件不存在时的错误无需提示
+	if (driver) driver->Delete(filePath.toUtf8().constData());
+	else GDALDeleteDataset(nullptr, filePath.toUtf8().constData());
+	CPLPopErrorHandler();
+}
+
+void DatasetPool::setIdleTimeout(int msecs) {
+	QMutexLocker locker(&m_mutex);
+	m_idleTimeout = msecs;
+}
+
+void DatasetPool::closeIdle() {
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	QMutexLocker locker(&m_mutex);
+	for (auto it = m_entries.begin(); it != m_entries.end();) {
+		T_PoolEntry* entry = it.value();
+		if (entry->refCount > 0 || now - entry->lastUsed < m_idleTimeout) {
+			++it;
+			continue;
+		}
+		it = m_entries.erase(it);
+		closeEntry(entry);
+	}
+}
+
+void DatasetPool::closeAll() {
+	QMutexLocker locker(&m_mutex);
+	for (T_PoolEntry* entry : std::as_const(m_entries)) {
+		entry->stale = true;
+		if (entry->refCount == 0) closeEntry(entry);	//仍被使用的归还后关闭
+	}
+	m_entries.clear();
+}
+
+int DatasetPool::openCount() const {
+	QMutexLocker locker(&m_mutex);
+	return m_byDataset.size();
+}
+
+void DatasetPool::closeEntry(T_PoolEntry* entry) {
+	// 调用方持有锁，并负责把 entry 从 m_entries 中移除
+	m_byDataset.remove(entry->dataset);
+	GDALClose(entry->dataset);
+	delete entry;
+}
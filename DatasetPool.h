@@ -0,0 +1,86 @@
+#pragma once
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QDateTime>
+
+class GDALDataset;
+class GDALDriver;
+class QTimer;
+
+// 数据集句柄：析构时把数据集归还给 DatasetPool，不关闭文件
+class DatasetHandle {
+public:
+	DatasetHandle() : m_dataset(nullptr) {}
+	DatasetHandle(DatasetHandle&& other) noexcept;
+	DatasetHandle& operator=(DatasetHandle&& other) noexcept;
+	DatasetHandle(const DatasetHandle&) = delete;
+	DatasetHandle& operator=(const DatasetHandle&) = delete;
+	~DatasetHandle();
+
+	GDALDataset* get() const { return m_dataset; }
+	GDALDataset* operator->() const { return m_dataset; }
+	explicit operator bool() const { return m_dataset != nullptr; }
+
+	void reset();	//提前归还
+
+private:
+	friend class DatasetPool;
+	explicit DatasetHandle(GDALDataset* dataset) : m_dataset(dataset) {}
+
+	GDALDataset* m_dataset;
+};
+
+// 共享的只读数据集池：按“路径 + 线程”缓存已打开的 GDALDataset，引用计数，
+// 空闲超时后关闭。同一文件的头信息、元数据与块缓存只需解析一次。
+// GDAL 数据集不能被多个线程同时使用，因此每个线程各持有一份
+class DatasetPool {
+public:
+	static DatasetPool& instance();
+
+	// 以只读方式获取数据集（栅格与矢量驱动均可）；打开失败时返回空句柄
+	DatasetHandle acquire(const QString& filePath);
+
+	// 文件将被改写或已被改写：关闭空闲的句柄，使用中的句柄归还后关闭
+	void invalidate(const QString& filePath);
+
+	// 准备写出到 filePath：丢弃已打开的旧句柄并静默删除已有文件（含附属文件）。
+	// driver 为空时按已有文件识别驱动
+	void prepareOutput(const QString& filePath, GDALDriver* driver = nullptr);
+
+	void setIdleTimeout(int msecs);
+	int idleTimeout() const { return m_idleTimeout; }
+
+	void closeIdle();	//关闭空闲超时的数据集
+	void closeAll();	//关闭全部空闲数据集（程序退出时调用）
+	int openCount() const;
+
+private:
+	friend class DatasetHandle;
+
+	// 池中的一个数据集
+	struct T_PoolEntry {
+		GDALDataset* dataset = nullptr;
+		QString key;
+		QString filePath;
+		int refCount = 0;
+		qint64 lastUsed = 0;	//最近归还时间（毫秒时间戳）
+		qint64 lastChecked = 0;	//最近一次核对文件修改时间的时间戳
+		QDateTime modified;	//打开时文件的修改时间
+		qint64 fileSize = -1;
+		bool stale = false;	//已失效，归还后关闭
+	};
+
+	DatasetPool();
+	~DatasetPool();
+
+	void release(GDALDataset* dataset);
+	bool isOutdated(T_PoolEntry* entry, qint64 now) const;
+	void closeEntry(T_PoolEntry* entry);
+
+	mutable QMutex m_mutex;
+	QHash<QString, T_PoolEntry*> m_entries;	//路径 + 线程 -> 数据集
+	QHash<GDALDataset*, T_PoolEntry*> m_byDataset;	//用于归还时查找
+	int m_idleTimeout;
+	QTimer* m_sweepTimer;
+};
@@ -4,11 +4,28 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QInputDialog>
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QDirIterator>
+#include <QMimeData>
+#include <QSet>
+#include <QUrl>
 #include <gdal.h>
 #include <gdal_priv.h>
 #include <ogrsf_frmts.h>
 #include "FileWidget.h"
 #include "TextWidget.h"
+#include "LayerMetadata.h"
+#include "RasterMosaic.h"
+#include "RasterCalculator.h"
+#include "ZonalStatistics.h"
+#include "RasterClip.h"
+#include "VectorOverlay.h"
+#include "DataConversion.h"
+#include "VsiSupport.h"
+#include "DatasetPool.h"
+#include "GdalRuntime.h"
+#include "ThematicStyle.h"
 
 
 
@@ -19,20 +36,54 @@ namespace CustomRole {
 		FileTypeRole,	//文件种类
 		FileBaseName,	//文件名
 		GraphicStatus,	//显示状态
-		Color	//矢量的颜色
+		Color,	//矢量的颜色
+		MetadataRole,	//图层元数据（T_LayerMetadata），扫描完成前为空
+		RenderModeRole,	//栅格显示方式（RasterLayerItem::RenderMode）
+		StyleRole,	//矢量符号化（T_VectorStyle）
+		LabelRole,	//矢量标注（T_LabelStyle）
+		TransparencyRole,	//栅格透明度（0-100）
+		BlendModeRole	//栅格混合方式（RasterLayerItem::BlendMode）
 	};
 }
 
+// 可导入的文件扩展名
+static const QStringList kSupportedSuffixes = { "tif", "tiff", "vrt", "shp" };
+
+// 按几何类型选择矢量图层的显示颜色
+static QString geometryColor(int wkbType) {
+	switch (wkbType) {
+	case wkbPoint:
+	case wkbMultiPoint:
+		return "red";
+	case wkbLineString:
+	case wkbMultiLineString:
+		return "blue";
+	case wkbPolygon:
+	case wkbMultiPolygon:
+		return "green";
+	default:
+		return "gray";
+	}
+}
+
 FileWidget::FileWidget(QWidget* parent)
 	: QDockWidget("文件列表", parent), m_treeView(nullptr) { // 初始化 treeview
 	m_container = new QWidget(this);
 
 	m_treeView = new QTreeView(m_container);
+	m_treeView->setSelectionMode(QAbstractItemView::ExtendedSelection); // 多选后可创建镶嵌图层
 
 	QVBoxLayout* layout = new QVBoxLayout(m_container);
 	layout->setContentsMargins(0, 0, 0, 0); // 去除边距
 	layout->addWidget(m_treeView);
 
+	// 导入与分析任务的进度条，同时运行的任务各占一行
+	m_progressLayout = new QVBoxLayout;
+	m_progressLayout->setSpacing(2);
+	layout->addLayout(m_progressLayout);
+
+	setAcceptDrops(true); // 可拖入文件或文件夹
+
 	m_model = new QStandardItemModel(m_container);
 
 	m_treeView->setModel(m_model);
@@ -58,82 +109,337 @@ FileWidget::FileWidget(QWidget* parent)
 	this->setWidget(m_container);
 
 	connect(m_rasterInfoWidget, &RasterInfoWidget::resampleCompleted, this, &FileWidget::addResampledFile);
+	connect(m_vectorElement, &VectorElement::elementSaved, this, &FileWidget::layerDataChanged); // 要素删除后重建该图层
+	connect(m_vectorElement, &VectorElement::elementSaved, this, &FileWidget::requestMetadata); // 要素数、范围随之变化
+	connect(m_vectorElement, &VectorElement::featuresSelected, this, &FileWidget::featuresSelected);
+	connect(m_vectorElement, &VectorElement::featuresSelected, this, [this](const QString& filePath, const QList<qint64>& featureIds) {
+		m_selectedLayer = filePath;
+		m_selectedIds = featureIds;
+		});
 }
 
 void FileWidget::appendFile() {
-	QString fileName = QFileDialog::getOpenFileName(this, "选择文件",
+	QStringList fileNames = QFileDialog::getOpenFileNames(this, "选择文件",
 		"/",
-		"栅格数据(*.tif *.tiff);;矢量数据(*.shp)");
+		"栅格与矢量数据(*.tif *.tiff *.vrt *.shp);;栅格数据(*.tif *.tiff *.vrt);;矢量数据(*.shp);;压缩包(*.zip *.tar *.tgz *.gz)");
 
-	if (fileName.isEmpty()) {
+	if (fileNames.isEmpty()) {
 		return; // 如果未选择文件，则返回
 	}
 
-	QString baseName = QFileInfo(fileName).fileName(); // "example.tif"
+	importFiles(fileNames);
+}
+
+void FileWidget::appendFolder() {
+	QString dirName = QFileDialog::getExistingDirectory(this, "选择文件夹", "/");
+	if (dirName.isEmpty()) {
+		return;
+	}
 
-	QStandardItem* fileItem = new QStandardItem(baseName);
-	fileItem->setData(baseName, CustomRole::FileBaseName);
-	fileItem->setData(fileName, CustomRole::FilePathRole);
-	fileItem->setData(true, CustomRole::GraphicStatus);
-	fileItem->setFlags(fileItem->flags() | Qt::ItemIsUserCheckable); // 启用复选框
-	fileItem->setCheckState(Qt::Checked); // 设置初始状态
+	importFiles(QStringList{ dirName });
+}
 
-	if (fileName.endsWith(".tif", Qt::CaseInsensitive) || fileName.endsWith(".tiff", Qt::CaseInsensitive)) {
-		fileItem->setData("Raster", CustomRole::FileTypeRole);
+void FileWidget::appendVirtualPath() {
+	bool ok = false;
+	QString input = QInputDialog::getText(this, "打开路径或 URL",
+		"GDAL 路径或 URL，例如：\n"
+		"https://example.com/data/cog.tif\n"
+		"/vsizip/D:/data/tiles.zip/tile_01.tif\n"
+		"/vsigzip/D:/data/dem.tif.gz",
+		QLineEdit::Normal, QString(), &ok);
+	if (!ok || input.trimmed().isEmpty()) {
+		return;
 	}
-	else if (fileName.endsWith(".shp", Qt::CaseInsensitive)) {
-		fileItem->setData("Vector", CustomRole::FileTypeRole);
-		GDALDataset* poDS = (GDALDataset*)GDALOpenEx(
-			fileName.toUtf8(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr);
-		if (!poDS) {
-			qDebug() << "打开SHP文件失败";
+
+	importFiles(QStringList{ VsiSupport::toGdalPath(input) });
+}
+
+void FileWidget::importFiles(const QStringList& paths) {
+	// 展开文件夹，跳过不支持的文件和已在列表中的文件
+	QSet<QString> knownPaths;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		knownPaths.insert(m_model->item(row)->data(CustomRole::FilePathRole).toString());
+	}
+
+	QStringList files;
+	auto appendCandidate = [&](const QString& filePath) {
+		// 虚拟路径（URL 等）不一定带扩展名，交给元数据扫描判断能否读取
+		if (!VsiSupport::isVirtualPath(filePath) && !kSupportedSuffixes.contains(QFileInfo(filePath).suffix().toLower())) return;
+		if (knownPaths.contains(filePath)) {
+			qDebug() << "文件已在列表中：" << filePath;
 			return;
 		}
+		knownPaths.insert(filePath);
+		files.append(filePath);
+	};
+	for (const QString& path : paths) {
+		// QFileInfo 会合并 "//"，虚拟路径必须原样保留
+		if (VsiSupport::isVirtualPath(path)) {
+			appendCandidate(path);
+			continue;
+		}
+		const QFileInfo fileInfo(path);
+		const QStringList archiveEntries = VsiSupport::expandArchive(fileInfo.absoluteFilePath());
+		if (!archiveEntries.isEmpty()) {
+			for (const QString& entry : archiveEntries) appendCandidate(entry);
+		}
+		else if (fileInfo.isDir()) {
+			QStringList nameFilters;
+			for (const QString& suffix : kSupportedSuffixes) nameFilters << "*." + suffix;
+			QDirIterator it(fileInfo.absoluteFilePath(), nameFilters, QDir::Files, QDirIterator::Subdirectories);
+			while (it.hasNext()) appendCandidate(it.next());
+		}
+		else {
+			appendCandidate(fileInfo.absoluteFilePath());
+		}
+	}
+	if (files.isEmpty()) return;
+
+	// 在线程池中并行扫描元数据，全部完成后一次性加入模型
+	QProgressBar* progress = createProgressBar("正在读取 %v / %m", files.size());
+	QFutureWatcher<T_LayerMetadata>* watcher = new QFutureWatcher<T_LayerMetadata>(this);
+	connect(watcher, &QFutureWatcher<T_LayerMetadata>::progressValueChanged, progress, &QProgressBar::setValue);
+	connect(watcher, &QFutureWatcher<T_LayerMetadata>::finished, this, [this, watcher, progress]() {
+		addScannedFiles(watcher->future().results());
+		watcher->deleteLater();
+		progress->deleteLater();
+		});
+	watcher->setFuture(QtConcurrent::mapped(GdalRuntime::analysisPool(), files, &LayerMetadata::scan));
+}
 
-		OGRLayer* poLayer = poDS->GetLayer(0);
-		if (!poLayer) {
-			GDALClose(poDS);
+void FileWidget::newMosaic() {
+	QStringList sourcePaths = QFileDialog::getOpenFileNames(this, "选择镶嵌的栅格文件",
+		"/",
+		"栅格数据(*.tif *.tiff)");
+	if (sourcePaths.size() < 2) {
+		return;
+	}
+
+	createMosaic(sourcePaths);
+}
+
+void FileWidget::createMosaic(const QStringList& sourcePaths) {
+	const QString defaultPath = QFileInfo(sourcePaths.first()).absoluteDir().filePath("mosaic.vrt");
+	const QString vrtPath = QFileDialog::getSaveFileName(this, "保存镶嵌图层", defaultPath, "GDAL VRT (*.vrt)");
+	if (vrtPath.isEmpty()) {
+		return;
+	}
+	const bool buildOverviews = QMessageBox::question(this, "创建镶嵌图层",
+		"是否生成金字塔？\n生成后缩小显示时不必读取每个源文件。") == QMessageBox::Yes;
+
+	// 镶嵌图层加入后，列表中的源图层不再需要单独显示
+	QSet<QString> sourceSet(sourcePaths.begin(), sourcePaths.end());
+
+	QProgressBar* progress = createProgressBar("正在生成镶嵌图层...", 0);
+	QFutureWatcher<QString>* watcher = new QFutureWatcher<QString>(this);
+	connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, progress, vrtPath, sourceSet]() {
+		const QString error = watcher->result();
+		watcher->deleteLater();
+		progress->deleteLater();
+
+		if (!error.isEmpty()) {
+			QMessageBox::critical(this, "错误", error);
 			return;
 		}
-		// 判断矢量要素类型
-        OGRFeature* poFeature = poLayer->GetNextFeature(); // 获取第一个要素
-		if (poFeature) {
-			OGRGeometry* poGeometry = poFeature->GetGeometryRef();
-			if (poGeometry) {
-				switch (wkbFlatten(poGeometry->getGeometryType())) {
-					case wkbPoint: {
-						fileItem->setData("red", CustomRole::Color);
-						break;
-					}
-					case wkbLineString: {
-						fileItem->setData("blue", CustomRole::Color);
-						break;
-					}
-					case wkbPolygon: {
-						fileItem->setData("green", CustomRole::Color);
-						break;
-					}
-				}
+		for (int row = m_model->rowCount() - 1; row >= 0; --row) {
+			if (sourceSet.contains(m_model->item(row)->data(CustomRole::FilePathRole).toString())) {
+				m_model->removeRow(row);
 			}
-			OGRFeature::DestroyFeature(poFeature); // 清理要素
 		}
+		addOutputFile(vrtPath); // 随后的扫描完成时统一通知地图
+		});
+	watcher->setFuture(QtConcurrent::run(&RasterMosaic::buildVrt, sourcePaths, vrtPath, buildOverviews));
+}
 
-        OGRGeometry* poGeometry = poFeature->GetGeometryRef();  
-        if (!poGeometry) {  
-           OGRFeature::DestroyFeature(poFeature); // Clean up the feature  
-           GDALClose(poDS);  
-           return;  
-        }    
+QStandardItem* FileWidget::createFileItem(const QString& filePath, bool isVisible) {
+	QString baseName = QFileInfo(filePath).fileName(); // "example.tif"
 
+	QStandardItem* fileItem = new QStandardItem(baseName);
+	fileItem->setData(baseName, CustomRole::FileBaseName);
+	fileItem->setData(filePath, CustomRole::FilePathRole);
+	fileItem->setData(isVisible, CustomRole::GraphicStatus);
+	fileItem->setFlags(fileItem->flags() | Qt::ItemIsUserCheckable); // 启用复选框
+	fileItem->setCheckState(isVisible ? Qt::Checked : Qt::Unchecked); // 设置初始状态
+	return fileItem;
+}
+
+QList<T_ProjectLayer> FileWidget::projectLayers() const {
+	QList<T_ProjectLayer> layers;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		const QStandardItem* item = m_model->item(row);
+		T_ProjectLayer layer;
+		layer.filePath = item->data(CustomRole::FilePathRole).toString();
+		layer.isVisible = item->data(CustomRole::GraphicStatus).toBool();
+		layer.color = item->data(CustomRole::Color).value<QColor>();
+		layer.renderMode = item->data(CustomRole::RenderModeRole).toInt();
+		layer.style = item->data(CustomRole::StyleRole).value<T_VectorStyle>();
+		layer.label = item->data(CustomRole::LabelRole).value<T_LabelStyle>();
+		layer.transparency = item->data(CustomRole::TransparencyRole).toInt();
+		layer.blendMode = item->data(CustomRole::BlendModeRole).toInt();
+		layer.metadata = item->data(CustomRole::MetadataRole).value<T_LayerMetadata>();
+		layers.append(layer);
 	}
-	else {
-		fileItem->setData("Unknown", CustomRole::FileTypeRole);
+	return layers;
+}
+
+void FileWidget::restoreLayers(const QList<T_ProjectLayer>& layers) {
+	// 工程中保存的元数据与文件一致时直接采用，其余文件在后台重新扫描，完成后各自加入地图
+	QList<QStandardItem*> items;
+	QStringList staleFiles;
+	QSet<QString> knownPaths;
+	for (const T_ProjectLayer& layer : layers) {
+		if (knownPaths.contains(layer.filePath)) continue;
+		knownPaths.insert(layer.filePath);
+
+		QStandardItem* fileItem = createFileItem(layer.filePath, layer.isVisible);
+		if (layer.color.isValid()) fileItem->setData(layer.color, CustomRole::Color);
+		if (layer.renderMode != 0) fileItem->setData(layer.renderMode, CustomRole::RenderModeRole);
+		if (layer.style.mode != 0) fileItem->setData(QVariant::fromValue(layer.style), CustomRole::StyleRole);
+		if (!layer.label.field.isEmpty()) fileItem->setData(QVariant::fromValue(layer.label), CustomRole::LabelRole);
+		if (layer.transparency != 0) fileItem->setData(layer.transparency, CustomRole::TransparencyRole);
+		if (layer.blendMode != 0) fileItem->setData(layer.blendMode, CustomRole::BlendModeRole);
+		if (LayerMetadata::restore(layer.metadata)) {
+			setItemMetadata(fileItem, layer.metadata);
+		}
+		else {
+			staleFiles.append(layer.filePath);
+		}
+		items.append(fileItem);
+	}
+
+	m_model->removeRows(0, m_model->rowCount());
+	if (!items.isEmpty()) m_model->invisibleRootItem()->appendRows(items);
+	updateFileListSignal();
+
+	for (const QString& filePath : staleFiles) {
+		requestMetadata(filePath);
+	}
+}
+
+void FileWidget::addScannedFiles(const QList<T_LayerMetadata>& records) {
+	QSet<QString> knownPaths;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		knownPaths.insert(m_model->item(row)->data(CustomRole::FilePathRole).toString());
+	}
+
+	QList<QStandardItem*> items;
+	for (const T_LayerMetadata& metadata : records) {
+		if (!metadata.isValid) {
+			qDebug() << "无法读取文件：" << metadata.filePath << metadata.errorMessage;
+			continue;
+		}
+		if (knownPaths.contains(metadata.filePath)) continue; // 扫描期间已被其他途径加入
+
+		QStandardItem* fileItem = createFileItem(metadata.filePath, true);
+		setItemMetadata(fileItem, metadata);
+
+		knownPaths.insert(metadata.filePath);
+		items.append(fileItem);
 	}
-	m_model->appendRow(fileItem);
+	if (items.isEmpty()) return;
 
+	// 一次插入全部行，地图只收到一次文件列表更新
+	m_model->invisibleRootItem()->appendRows(items);
 	updateFileListSignal();
 }
 
+void FileWidget::runOutputJob(const QString& progressFormat, const QString& errorTitle, const QString& outputPath,
+	const std::function<QString(QPromise<QString>&)>& job) {
+	QProgressBar* progress = createProgressBar(progressFormat, 0); // 任务设置进度范围之前为忙碌状态
+	QFutureWatcher<QString>* watcher = new QFutureWatcher<QString>(this);
+	connect(watcher, &QFutureWatcher<QString>::progressRangeChanged, progress, &QProgressBar::setRange);
+	connect(watcher, &QFutureWatcher<QString>::progressValueChanged, progress, &QProgressBar::setValue);
+	connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, progress, errorTitle, outputPath]() {
+		const QString error = watcher->result();
+		watcher->deleteLater();
+		progress->deleteLater();
+
+		if (!error.isEmpty()) {
+			QMessageBox::critical(this, "错误", QString("%1：\n%2").arg(errorTitle, error));
+			return;
+		}
+		addOutputFile(outputPath);
+		});
+	watcher->setFuture(QtConcurrent::run([job](QPromise<QString>& promise) {
+		promise.addResult(job(promise));
+		}));
+}
+
+QProgressBar* FileWidget::createProgressBar(const QString& format, int maximum) {
+	QProgressBar* progress = new QProgressBar(m_container);
+	progress->setTextVisible(true);
+	progress->setFormat(format);
+	progress->setRange(0, maximum);
+	progress->setValue(0);
+	m_progressLayout->addWidget(progress);
+	return progress;
+}
+
+void FileWidget::addOutputFile(const QString& outputPath) {
+	LayerMetadata::invalidate(outputPath); // 输出可能覆盖了已缓存的文件
+
+	// 覆盖列表中已有的文件时只需刷新该图层
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		if (m_model->item(row)->data(CustomRole::FilePathRole).toString() == outputPath) {
+			emit layerDataChanged(outputPath);
+			requestMetadata(outputPath);
+			return;
+		}
+	}
+	importFiles(QStringList{ outputPath });
+}
+
+void FileWidget::requestMetadata(const QString& filePath) {
+	QFutureWatcher<T_LayerMetadata>* watcher = new QFutureWatcher<T_LayerMetadata>(this);
+	connect(watcher, &QFutureWatcher<T_LayerMetadata>::finished, this, [this, watcher]() {
+		applyMetadata(watcher->result());
+		watcher->deleteLater();
+		});
+	watcher->setFuture(QtConcurrent::run(GdalRuntime::analysisPool(), &LayerMetadata::scan, filePath));
+}
+
+void FileWidget::setItemMetadata(QStandardItem* item, const T_LayerMetadata& metadata) {
+	item->setData(QVariant::fromValue(metadata), CustomRole::MetadataRole);
+	item->setData(metadata.fileType, CustomRole::FileTypeRole);
+	if (metadata.fileType == "Vector" && !item->data(CustomRole::Color).isValid()) {
+		item->setData(geometryColor(metadata.wkbType), CustomRole::Color); // 保留工程中保存的颜色
+	}
+	item->setToolTip(metadata.summary());
+}
+
+void FileWidget::applyMetadata(const T_LayerMetadata& metadata) {
+	if (!metadata.isValid) {
+		qDebug() << "无法读取文件：" << metadata.filePath << metadata.errorMessage;
+		return;
+	}
+
+	// 扫描期间该文件可能已被移出列表
+	bool found = false;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		QStandardItem* item = m_model->item(row);
+		if (item->data(CustomRole::FilePathRole).toString() != metadata.filePath) continue;
+		setItemMetadata(item, metadata);
+		found = true;
+	}
+	if (found) updateFileListSignal();
+}
+
+void FileWidget::dragEnterEvent(QDragEnterEvent* event) {
+	if (event->mimeData()->hasUrls()) {
+		event->acceptProposedAction();
+	}
+}
+
+void FileWidget::dropEvent(QDropEvent* event) {
+	QStringList paths;
+	for (const QUrl& url : event->mimeData()->urls()) {
+		if (url.isLocalFile()) paths.append(url.toLocalFile());
+	}
+	if (paths.isEmpty()) return;
+
+	event->acceptProposedAction();
+	importFiles(paths);
+}
 
 void FileWidget::onCustomContextMenuRequested(const QPoint& pos) {
 	QModelIndex index = m_treeView->indexAt(pos);
@@ -143,6 +449,21 @@ void FileWidget::onCustomContextMenuRequested(const QPoint& pos) {
 
 	QMenu menu;
 
+	// 选中多个栅格时可合并为一个镶嵌图层
+	QStringList selectedRasters;
+	for (const QModelIndex& selected : m_treeView->selectionModel()->selectedRows()) {
+		if (selected.data(CustomRole::FileTypeRole).toString() == "Raster") {
+			selectedRasters.append(selected.data(CustomRole::FilePathRole).toString());
+		}
+	}
+	if (selectedRasters.size() > 1) {
+		QAction* mosaicAction = menu.addAction(QString("创建镶嵌图层（%1 个栅格）").arg(selectedRasters.size()));
+		connect(mosaicAction, &QAction::triggered, [=] {
+			createMosaic(selectedRasters);
+			});
+		menu.addSeparator();
+	}
+
 	QAction* visibilityAction = menu.addAction(
 		index.data(CustomRole::GraphicStatus).toBool() ? "隐藏文件" : "显示文件"
 	);
@@ -152,6 +473,56 @@ void FileWidget::onCustomContextMenuRequested(const QPoint& pos) {
 		connect(resampleAction, &QAction::triggered, [=] {
 			rasterResample(index.data(CustomRole::FilePathRole).toString());
 			});
+		QAction* calculatorAction = menu.addAction("栅格计算器");
+		connect(calculatorAction, &QAction::triggered, [=] {
+			rasterCalculator(index.data(CustomRole::FilePathRole).toString());
+			});
+		if (!m_selectedLayer.isEmpty() && !m_selectedIds.isEmpty()) {
+			QAction* clipAction = menu.addAction(QString("按选中的 %1 个要素裁剪").arg(m_selectedIds.size()));
+			connect(clipAction, &QAction::triggered, [=] {
+				clipRasterToFeatures(index.data(CustomRole::FilePathRole).toString());
+				});
+		}
+		// 单波段栅格（DEM）可切换为地形显示
+		if (index.data(CustomRole::MetadataRole).value<T_LayerMetadata>().bands.size() == 1) {
+			QMenu* renderMenu = menu.addMenu("显示方式");
+			const QStringList modeNames = { "默认", "山体阴影", "坡度", "坡向" };
+			const int currentMode = index.data(CustomRole::RenderModeRole).toInt();
+			for (int mode = 0; mode < modeNames.size(); ++mode) {
+				QAction* modeAction = renderMenu->addAction(modeNames[mode]);
+				modeAction->setCheckable(true);
+				modeAction->setChecked(mode == currentMode);
+				connect(modeAction, &QAction::triggered, [=] {
+					m_model->setData(index, mode, CustomRole::RenderModeRole);
+					updateFileListSignal();
+					});
+			}
+		}
+		QAction* transparencyAction = menu.addAction("透明度");
+		connect(transparencyAction, &QAction::triggered, [=] {
+			bool ok = false;
+			const int transparency = QInputDialog::getInt(this, "透明度", "透明度（%）：",
+				index.data(CustomRole::TransparencyRole).toInt(), 0, 100, 10, &ok);
+			if (!ok) return;
+			m_model->setData(index, transparency, CustomRole::TransparencyRole);
+			updateFileListSignal();
+			});
+		QMenu* blendMenu = menu.addMenu("混合方式");
+		const QStringList blendNames = { "正常", "正片叠底", "滤色", "叠加", "变暗", "变亮" };
+		const int currentBlend = index.data(CustomRole::BlendModeRole).toInt();
+		for (int mode = 0; mode < blendNames.size(); ++mode) {
+			QAction* blendAction = blendMenu->addAction(blendNames[mode]);
+			blendAction->setCheckable(true);
+			blendAction->setChecked(mode == currentBlend);
+			connect(blendAction, &QAction::triggered, [=] {
+				m_model->setData(index, mode, CustomRole::BlendModeRole);
+				updateFileListSignal();
+				});
+		}
+		QAction* polygonizeAction = menu.addAction("栅格转矢量");
+		connect(polygonizeAction, &QAction::triggered, [=] {
+			rasterPolygonize(index.data(CustomRole::FilePathRole).toString());
+			});
 	}
 
 	if (index.data(CustomRole::FileTypeRole).toString() == "Vector") {
@@ -164,6 +535,30 @@ void FileWidget::onCustomContextMenuRequested(const QPoint& pos) {
 		connect(bufferAction, &QAction::triggered, [=] {
 			vectorBuffer(index.data(CustomRole::FilePathRole).toString());
 			});
+		QAction* overlayAction = menu.addAction("叠加分析");
+		connect(overlayAction, &QAction::triggered, [=] {
+			vectorOverlay(index.data(CustomRole::FilePathRole).toString());
+			});
+		QAction* symbologyAction = menu.addAction("符号化");
+		connect(symbologyAction, &QAction::triggered, [=] {
+			vectorSymbology(index.data(CustomRole::FilePathRole).toString());
+			});
+		QAction* labelAction = menu.addAction("标注");
+		connect(labelAction, &QAction::triggered, [=] {
+			vectorLabels(index.data(CustomRole::FilePathRole).toString());
+			});
+		QAction* rasterizeAction = menu.addAction("矢量转栅格");
+		connect(rasterizeAction, &QAction::triggered, [=] {
+			vectorRasterize(index.data(CustomRole::FilePathRole).toString());
+			});
+		const OGRwkbGeometryType geometryType = static_cast<OGRwkbGeometryType>(
+			index.data(CustomRole::MetadataRole).value<T_LayerMetadata>().wkbType);
+		if (OGR_GT_IsSubClassOf(geometryType, wkbCurvePolygon) || OGR_GT_IsSubClassOf(geometryType, wkbMultiSurface)) {
+			QAction* zonalAction = menu.addAction("分区统计");
+			connect(zonalAction, &QAction::triggered, [=] {
+				zonalStatistics(index.data(CustomRole::FilePathRole).toString());
+				});
+		}
 	}
 	QAction* deleteAction = menu.addAction("删除文件");
 	QAction* showPropertiesAction = menu.addAction("属性");
@@ -186,40 +581,19 @@ void FileWidget::deleteSelectedItem() {
 void FileWidget::toggleVisibility() {
     if (m_contextMenuIndex.isValid()) {
         QStandardItem* item = m_model->itemFromIndex(m_contextMenuIndex);
-        bool newStatus = !item->data(CustomRole::GraphicStatus).toBool();
-
-        // 更新数据角色和复选框状态
-        item->setData(newStatus, CustomRole::GraphicStatus);
-        item->setCheckState(newStatus ? Qt::Checked : Qt::Unchecked);
-
-        // 获取文件路径
-        QString filePath = item->data(CustomRole::FilePathRole).toString();
-
-        // 更新 QMap 状态
-        QMap<QString, T_Information> fileList;
-        for (int i = 0; i < m_model->rowCount(); ++i) {
-            QStandardItem* currentItem = m_model->item(i);
-            QString currentFilePath = currentItem->data(CustomRole::FilePathRole).toString();
-            bool currentStatus = currentItem->data(CustomRole::GraphicStatus).toBool();
-			QColor color = currentItem->data(CustomRole::Color).value<QColor>();
-            fileList.insert(currentFilePath, T_Information{currentStatus,color});
-        }
-        // 发射信号，传递更新后的文件列表
-        emit fileListUpdated(fileList);
+
+        // 只切换复选框，显示状态与地图由 onItemChanged 同步
+        item->setCheckState(item->checkState() == Qt::Checked ? Qt::Unchecked : Qt::Checked);
     }
 }
 
 void FileWidget::onItemChanged(QStandardItem* item) {
-	static bool inProgress = false;
-	if (inProgress) return;
-	inProgress = true;
-
-	if (item->isCheckable()) {
-		m_contextMenuIndex = m_model->indexFromItem(item);
-		toggleVisibility();
-	}
-
-	inProgress = false;
+	// 修改任何角色都会发出 itemChanged，只在复选框与显示状态不一致时处理
+	if (!item->isCheckable()) return;
+	const bool checked = item->checkState() == Qt::Checked;
+	if (checked == item->data(CustomRole::GraphicStatus).toBool()) return;
+	item->setData(checked, CustomRole::GraphicStatus);
+	updateFileListSignal();
 }
 
 void FileWidget::deliverDataPath() {
@@ -239,10 +613,16 @@ void FileWidget::updateFileListSignal() {
    QMap<QString, T_Information> fileList;
    for (int i = 0; i < m_model->rowCount(); ++i) {
        QStandardItem* item = m_model->item(i);
+       if (!item->data(CustomRole::MetadataRole).isValid()) continue; // 元数据尚未就绪的文件暂不显示
        QString filePath = item->data(CustomRole::FilePathRole).toString();
        bool status = item->data(CustomRole::GraphicStatus).toBool();
        QColor color = item->data(CustomRole::Color).value<QColor>(); // Explicitly convert QVariant to QColor
-       fileList.insert(filePath, T_Information{status, color});
+       int renderMode = item->data(CustomRole::RenderModeRole).toInt();
+       T_VectorStyle style = item->data(CustomRole::StyleRole).value<T_VectorStyle>();
+       T_LabelStyle label = item->data(CustomRole::LabelRole).value<T_LabelStyle>();
+       int transparency = item->data(CustomRole::TransparencyRole).toInt();
+       int blendMode = item->data(CustomRole::BlendModeRole).toInt();
+       fileList.insert(filePath, T_Information{status, color, renderMode, style, label, transparency, blendMode});
    }
    emit fileListUpdated(fileList);
 }
@@ -285,27 +665,57 @@ void FileWidget::rasterResample(const QString& filePath) {
 	}
 }
 
-void FileWidget::addResampledFile(const QString& outputPath) {
-	QString baseName = QFileInfo(outputPath).fileName(); // 获取文件名
-
-	QStandardItem* fileItem = new QStandardItem(baseName);
-	fileItem->setData(baseName, CustomRole::FileBaseName);
-	fileItem->setData(outputPath, CustomRole::FilePathRole);
-	fileItem->setData(true, CustomRole::GraphicStatus);
-	fileItem->setFlags(fileItem->flags() | Qt::ItemIsUserCheckable); // 启用复选框
-	fileItem->setCheckState(Qt::Checked); // 设置初始状态
+void FileWidget::rasterCalculator(const QString& filePath) {
+	int bandCount = 0;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		QStandardItem* item = m_model->item(row);
+		if (item->data(CustomRole::FilePathRole).toString() == filePath) {
+			bandCount = item->data(CustomRole::MetadataRole).value<T_LayerMetadata>().bands.size();
+			break;
+		}
+	}
 
-	if (outputPath.endsWith(".tif", Qt::CaseInsensitive) || outputPath.endsWith(".tiff", Qt::CaseInsensitive)) {
-		fileItem->setData("Raster", CustomRole::FileTypeRole);
+	// 先在界面线程编译表达式，语法错误时重新输入
+	QString expression = bandCount >= 4 ? "(B4-B3)/(B4+B3)" : "B1";
+	BandExpression program;
+	while (true) {
+		bool ok = false;
+		expression = QInputDialog::getText(this, "栅格计算器",
+			QString("输入波段表达式（B1..B%1，支持 + - * / 与括号）：").arg(bandCount),
+			QLineEdit::Normal, expression, &ok);
+		if (!ok) return;
+
+		QString error = program.compile(expression);
+		if (error.isEmpty() && bandCount > 0 && !program.bands().isEmpty() && program.bands().last() > bandCount) {
+			error = QString("表达式引用了 B%1，该栅格只有 %2 个波段").arg(program.bands().last()).arg(bandCount);
+		}
+		if (error.isEmpty()) break;
+		QMessageBox::warning(this, "表达式错误", error);
 	}
-	else {
-		fileItem->setData("Unknown", CustomRole::FileTypeRole);
+
+	const QString defaultPath = QFileInfo(filePath).absoluteDir().filePath(QFileInfo(filePath).completeBaseName() + "_calc.tif");
+	const QString outputPath = QFileDialog::getSaveFileName(this, "保存计算结果", defaultPath, "GeoTIFF (*.tif)");
+	if (outputPath.isEmpty()) {
+		return;
 	}
 
-	m_model->appendRow(fileItem);
+	runOutputJob("正在计算 %v / %m", "栅格计算失败", outputPath, [filePath, expression, outputPath](QPromise<QString>& promise) {
+		return RasterCalculator::calculate(filePath, expression, outputPath, &promise);
+		});
+}
 
-	// 更新文件列表信号
-	updateFileListSignal();
+void FileWidget::addResampledFile(const QString& outputPath) {
+	addOutputFile(outputPath);
+}
+
+void FileWidget::selectFeatures(const QString& filePath, const QList<qint64>& featureIds) {
+	m_selectedLayer = filePath;
+	m_selectedIds = featureIds;
+	if (filePath.isEmpty() && m_vectorElement->isHidden()) return;
+
+	m_vectorElement->show();
+	m_vectorElement->raise();
+	m_vectorElement->selectFeatures(filePath, featureIds);
 }
 
 void FileWidget::vectorBuffer(const QString& filePath) {  
@@ -326,60 +736,294 @@ void FileWidget::vectorBuffer(const QString& filePath) {
 }
 
 void FileWidget::addBufferFile(const QString& outputPath) {
-	// 获取文件名
-	QString baseName = QFileInfo(outputPath).fileName();
+	addOutputFile(outputPath);
+}
 
-	// 创建文件项
-	QStandardItem* fileItem = new QStandardItem(baseName);
-	fileItem->setData(baseName, CustomRole::FileBaseName);
-	fileItem->setData(outputPath, CustomRole::FilePathRole);
-	fileItem->setData(true, CustomRole::GraphicStatus); // 默认显示
-	fileItem->setFlags(fileItem->flags() | Qt::ItemIsUserCheckable); // 启用复选框
-	fileItem->setCheckState(Qt::Checked); // 设置初始状态
-
-	// 判断文件类型
-	if (outputPath.endsWith(".shp", Qt::CaseInsensitive)) {
-		fileItem->setData("Vector", CustomRole::FileTypeRole);
-
-		// 打开矢量文件以确定几何类型
-		GDALDataset* poDS = (GDALDataset*)GDALOpenEx(
-			outputPath.toUtf8(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr);
-		if (poDS) {
-			OGRLayer* poLayer = poDS->GetLayer(0);
-			if (poLayer) {
-				OGRFeature* poFeature = poLayer->GetNextFeature();
-				if (poFeature) {
-					OGRGeometry* poGeometry = poFeature->GetGeometryRef();
-					if (poGeometry) {
-						switch (wkbFlatten(poGeometry->getGeometryType())) {
-						case wkbPoint:
-							fileItem->setData("red", CustomRole::Color);
-							break;
-						case wkbLineString:
-							fileItem->setData("blue", CustomRole::Color);
-							break;
-						case wkbPolygon:
-							fileItem->setData("green", CustomRole::Color);
-							break;
-						default:
-							fileItem->setData("gray", CustomRole::Color);
-							break;
-						}
-					}
-					OGRFeature::DestroyFeature(poFeature);
+void FileWidget::zonalStatistics(const QString& filePath) {
+	// 统计的栅格从列表中选择
+	QStringList rasterPaths;
+	QStringList rasterNames;
+	QList<int> bandCounts;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		QStandardItem* item = m_model->item(row);
+		if (item->data(CustomRole::FileTypeRole).toString() != "Raster") continue;
+		rasterPaths.append(item->data(CustomRole::FilePathRole).toString());
+		rasterNames.append(item->data(CustomRole::FileBaseName).toString());
+		bandCounts.append(item->data(CustomRole::MetadataRole).value<T_LayerMetadata>().bands.size());
+	}
+	if (rasterPaths.isEmpty()) {
+		QMessageBox::information(this, "分区统计", "列表中没有栅格图层，请先导入要统计的栅格");
+		return;
+	}
+
+	bool ok = true;
+	int rasterIndex = 0;
+	if (rasterPaths.size() > 1) {
+		const QString name = QInputDialog::getItem(this, "分区统计", "选择栅格：", rasterNames, 0, false, &ok);
+		if (!ok) return;
+		rasterIndex = rasterNames.indexOf(name);
+	}
+	int bandIndex = 1;
+	if (bandCounts[rasterIndex] > 1) {
+		bandIndex = QInputDialog::getInt(this, "分区统计", "统计的波段：", 1, 1, bandCounts[rasterIndex], 1, &ok);
+		if (!ok) return;
+	}
+
+	const QString defaultPath = QFileInfo(filePath).absoluteDir().filePath(QFileInfo(filePath).completeBaseName() + "_zonal.shp");
+	const QString outputPath = QFileDialog::getSaveFileName(this, "保存统计结果", defaultPath, "Shapefile (*.shp)");
+	if (outputPath.isEmpty()) {
+		return;
+	}
+
+	const QString rasterPath = rasterPaths[rasterIndex];
+	runOutputJob("正在统计 %v / %m", "分区统计失败", outputPath, [rasterPath, bandIndex, filePath, outputPath](QPromise<QString>& promise) {
+		return ZonalStatistics::compute(rasterPath, bandIndex, filePath, outputPath, &promise);
+		});
+}
+
+void FileWidget::clipRasterToExtent(const QRectF& extent) {
+	// 与框选范围相交的可见栅格
+	QStringList rasterPaths;
+	QStringList rasterNames;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		QStandardItem* item = m_model->item(row);
+		if (item->data(CustomRole::FileTypeRole).toString() != "Raster" || !item->data(CustomRole::GraphicStatus).toBool()) continue;
+		if (!item->data(CustomRole::MetadataRole).value<T_LayerMetadata>().extent.intersects(extent)) continue;
+		rasterPaths.append(item->data(CustomRole::FilePathRole).toString());
+		rasterNames.append(item->data(CustomRole::FileBaseName).toString());
+	}
+	if (rasterPaths.isEmpty()) {
+		QMessageBox::information(this, "裁剪", "框选范围内没有可见的栅格图层");
+		return;
+	}
+
+	int rasterIndex = 0;
+	if (rasterPaths.size() > 1) {
+		bool ok = false;
+		const QString name = QInputDialog::getItem(this, "裁剪", "选择要裁剪的栅格：", rasterNames, 0, false, &ok);
+		if (!ok) return;
+		rasterIndex = rasterNames.indexOf(name);
+	}
+
+	const QString filePath = rasterPaths[rasterIndex];
+	const QString defaultPath = QFileInfo(filePath).absoluteDir().filePath(QFileInfo(filePath).completeBaseName() + "_clip.tif");
+	const QString outputPath = QFileDialog::getSaveFileName(this, "保存裁剪结果", defaultPath, "GeoTIFF (*.tif)");
+	if (outputPath.isEmpty()) {
+		return;
+	}
+
+	runOutputJob("正在裁剪...", "裁剪失败", outputPath, [filePath, extent, outputPath](QPromise<QString>&) {
+		return RasterClip::clipToExtent(filePath, extent, outputPath);
+		});
+}
+
+void FileWidget::clipRasterToFeatures(const QString& filePath) {
+	const QString defaultPath = QFileInfo(filePath).absoluteDir().filePath(QFileInfo(filePath).completeBaseName() + "_clip.tif");
+	const QString outputPath = QFileDialog::getSaveFileName(this, "保存裁剪结果", defaultPath, "GeoTIFF (*.tif)");
+	if (outputPath.isEmpty()) {
+		return;
+	}
+
+	const QString vectorPath = m_selectedLayer;
+	const QList<qint64> featureIds = m_selectedIds;
+	runOutputJob("正在裁剪...", "裁剪失败", outputPath, [filePath, vectorPath, featureIds, outputPath](QPromise<QString>&) {
+		return RasterClip::clipToFeatures(filePath, vectorPath, featureIds, outputPath);
+		});
+}
+
+void FileWidget::vectorOverlay(const QString& filePath) {
+	// 叠加的面图层从列表中选择
+	QStringList overlayPaths;
+	QStringList overlayNames;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		QStandardItem* item = m_model->item(row);
+		const QString path = item->data(CustomRole::FilePathRole).toString();
+		if (path == filePath || item->data(CustomRole::FileTypeRole).toString() != "Vector") continue;
+		const OGRwkbGeometryType geometryType = static_cast<OGRwkbGeometryType>(
+			item->data(CustomRole::MetadataRole).value<T_LayerMetadata>().wkbType);
+		if (!OGR_GT_IsSubClassOf(geometryType, wkbCurvePolygon) && !OGR_GT_IsSubClassOf(geometryType, wkbMultiSurface)) continue;
+		overlayPaths.append(path);
+		overlayNames.append(item->data(CustomRole::FileBaseName).toString());
+	}
+	if (overlayPaths.isEmpty()) {
+		QMessageBox::information(this, "叠加分析", "列表中没有其他面图层，请先导入用于叠加的面图层");
+		return;
+	}
+
+	const QStringList operationNames = { "相交", "裁剪", "擦除" };
+	const QStringList operationSuffixes = { "_intersect", "_clip", "_erase" };
+	bool ok = false;
+	const int operation = operationNames.indexOf(
+		QInputDialog::getItem(this, "叠加分析", "选择运算：", operationNames, 0, false, &ok));
+	if (!ok || operation < 0) return;
+
+	int overlayIndex = 0;
+	if (overlayPaths.size() > 1) {
+		const QString name = QInputDialog::getItem(this, "叠加分析", "选择叠加的面图层：", overlayNames, 0, false, &ok);
+		if (!ok) return;
+		overlayIndex = overlayNames.indexOf(name);
+	}
+
+	const QString defaultPath = QFileInfo(filePath).absoluteDir().filePath(
+		QFileInfo(filePath).completeBaseName() + operationSuffixes[operation] + ".shp");
+	const QString outputPath = QFileDialog::getSaveFileName(this, "保存叠加结果", defaultPath, "Shapefile (*.shp)");
+	if (outputPath.isEmpty()) {
+		return;
+	}
+
+	const QString overlayPath = overlayPaths[overlayIndex];
+	const VectorOverlay::Operation overlayOperation = static_cast<VectorOverlay::Operation>(operation);
+	runOutputJob("正在叠加 %v / %m", "叠加分析失败", outputPath,
+		[overlayOperation, filePath, overlayPath, outputPath](QPromise<QString>& promise) {
+		return VectorOverlay::run(overlayOperation, filePath, overlayPath, outputPath, &promise);
+		});
+}
+
+void FileWidget::rasterPolygonize(const QString& filePath) {
+	int bandCount = 0;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		QStandardItem* item = m_model->item(row);
+		if (item->data(CustomRole::FilePathRole).toString() == filePath) {
+			bandCount = item->data(CustomRole::MetadataRole).value<T_LayerMetadata>().bands.size();
+			break;
+		}
+	}
+
+	int bandIndex = 1;
+	if (bandCount > 1) {
+		bool ok = false;
+		bandIndex = QInputDialog::getInt(this, "栅格转矢量", "转换的波段：", 1, 1, bandCount, 1, &ok);
+		if (!ok) return;
+	}
+
+	const QString defaultPath = QFileInfo(filePath).absoluteDir().filePath(QFileInfo(filePath).completeBaseName() + "_polygon.shp");
+	const QString outputPath = QFileDialog::getSaveFileName(this, "保存转换结果", defaultPath, "Shapefile (*.shp)");
+	if (outputPath.isEmpty()) {
+		return;
+	}
+
+	runOutputJob("正在转换 %p%", "栅格转矢量失败", outputPath, [filePath, bandIndex, outputPath](QPromise<QString>& promise) {
+		return DataConversion::polygonize(filePath, bandIndex, outputPath, &promise);
+		});
+}
+
+void FileWidget::vectorRasterize(const QString& filePath) {
+	T_LayerMetadata metadata;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		QStandardItem* item = m_model->item(row);
+		if (item->data(CustomRole::FilePathRole).toString() == filePath) {
+			metadata = item->data(CustomRole::MetadataRole).value<T_LayerMetadata>();
+			break;
+		}
+	}
+
+	// 第一项表示不取字段，要素统一写 1
+	const QString constantItem = "（常数 1）";
+	bool ok = false;
+	const QString field = QInputDialog::getItem(this, "矢量转栅格", "写入的数值字段：",
+		QStringList{ constantItem } + metadata.fieldNames, 0, false, &ok);
+	if (!ok) return;
+	const QString attribute = field == constantItem ? QString() : field;
+
+	// 默认长边约 2048 个像元
+	const double longestSide = qMax(metadata.extent.width(), metadata.extent.height());
+	const double defaultSize = longestSide > 0.0 ? longestSide / 2048.0 : 1.0;
+	const double pixelSize = QInputDialog::getDouble(this, "矢量转栅格", "像元大小（图层坐标单位）：",
+		defaultSize, 1e-9, 1e9, 6, &ok);
+	if (!ok) return;
+
+	const QString defaultPath = QFileInfo(filePath).absoluteDir().filePath(QFileInfo(filePath).completeBaseName() + "_raster.tif");
+	const QString outputPath = QFileDialog::getSaveFileName(this, "保存转换结果", defaultPath, "GeoTIFF (*.tif)");
+	if (outputPath.isEmpty()) {
+		return;
+	}
+
+	runOutputJob("正在转换 %v / %m", "矢量转栅格失败", outputPath, [filePath, attribute, pixelSize, outputPath](QPromise<QString>& promise) {
+		return DataConversion::rasterize(filePath, attribute, pixelSize, outputPath, &promise);
+		});
+}
+
+void FileWidget::vectorSymbology(const QString& filePath) {
+	QStandardItem* fileItem = nullptr;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		if (m_model->item(row)->data(CustomRole::FilePathRole).toString() == filePath) {
+			fileItem = m_model->item(row);
+			break;
+		}
+	}
+	if (!fileItem) return;
+	T_VectorStyle style = fileItem->data(CustomRole::StyleRole).value<T_VectorStyle>();
+
+	const QStringList modeNames = { "单一颜色", "按字段分类", "按字段分级" };
+	bool ok = false;
+	const int mode = modeNames.indexOf(
+		QInputDialog::getItem(this, "符号化", "显示方式：", modeNames, style.mode, false, &ok));
+	if (!ok || mode < 0) return;
+
+	style.mode = mode;
+	if (mode != ThematicStyle::Single) {
+		// 分级只列出数值字段，字段类型从图层定义中读取，不遍历要素
+		QStringList fields;
+		if (DatasetHandle dataset = DatasetPool::instance().acquire(filePath)) {
+			if (OGRLayer* layer = dataset->GetLayer(0)) {
+				OGRFeatureDefn* definition = layer->GetLayerDefn();
+				for (int i = 0; i < definition->GetFieldCount(); ++i) {
+					const OGRFieldType type = definition->GetFieldDefn(i)->GetType();
+					const bool isNumeric = type == OFTInteger || type == OFTInteger64 || type == OFTReal;
+					if (mode == ThematicStyle::Categorized || isNumeric) fields.append(QString::fromUtf8(definition->GetFieldDefn(i)->GetNameRef()));
 				}
 			}
-			GDALClose(poDS);
 		}
-	}
-	else {
-		fileItem->setData("Unknown", CustomRole::FileTypeRole);
+		if (fields.isEmpty()) {
+			QMessageBox::information(this, "符号化", mode == ThematicStyle::Graduated ? "图层没有数值字段，不能分级" : "图层没有属性字段");
+			return;
+		}
+		style.field = QInputDialog::getItem(this, "符号化", "依据的字段：", fields, std::max<qsizetype>(0, fields.indexOf(style.field)), false, &ok);
+		if (!ok) return;
+
+		if (mode == ThematicStyle::Graduated) {
+			style.classCount = QInputDialog::getInt(this, "符号化", "分级数：", style.classCount, 2, 32, 1, &ok);
+			if (!ok) return;
+			const QStringList methodNames = { "等间距", "分位数" };
+			style.method = methodNames.indexOf(
+				QInputDialog::getItem(this, "符号化", "分级方法：", methodNames, style.method, false, &ok));
+			if (!ok || style.method < 0) return;
+		}
 	}
 
-	// 将文件项添加到模型中
-	m_model->appendRow(fileItem);
+	fileItem->setData(QVariant::fromValue(style), CustomRole::StyleRole);
+	updateFileListSignal(); // 地图只重新归类并重绘，不重新读取几何
+}
 
-	// 更新文件列表信号
+void FileWidget::vectorLabels(const QString& filePath) {
+	QStandardItem* fileItem = nullptr;
+	for (int row = 0; row < m_model->rowCount(); ++row) {
+		if (m_model->item(row)->data(CustomRole::FilePathRole).toString() == filePath) {
+			fileItem = m_model->item(row);
+			break;
+		}
+	}
+	if (!fileItem) return;
+	T_LabelStyle label = fileItem->data(CustomRole::LabelRole).value<T_LabelStyle>();
+	const T_LayerMetadata metadata = fileItem->data(CustomRole::MetadataRole).value<T_LayerMetadata>();
+
+	// 第一项表示关闭标注
+	const QString noneItem = "（不显示）";
+	bool ok = false;
+	const QStringList fields = QStringList{ noneItem } + metadata.fieldNames;
+	const QString field = QInputDialog::getItem(this, "标注", "标注字段：", fields,
+		std::max<qsizetype>(0, fields.indexOf(label.field)), false, &ok);
+	if (!ok) return;
+	label.field = field == noneItem ? QString() : field;
+
+	if (!label.field.isEmpty()) {
+		label.fontSize = QInputDialog::getInt(this, "标注", "字号：", label.fontSize, 6, 48, 1, &ok);
+		if (!ok) return;
+		label.maxResolution = QInputDialog::getDouble(this, "标注", "每像素地图单位大于此值时隐藏（0 为始终显示）：",
+			label.maxResolution, 0.0, 1e9, 6, &ok);
+		if (!ok) return;
+	}
+
+	fileItem->setData(QVariant::fromValue(label), CustomRole::LabelRole);
 	updateFileListSignal();
 }
-
@@ -3,9 +3,17 @@
 #include <QDockWidget>
 #include <QTreeView>
 #include <QStandardItemModel>
+#include <QProgressBar>
+#include <QVBoxLayout>
+#include <QDragEnterEvent>
+#include <QDropEvent>
+#include <QPromise>
+#include <functional>
 #include "Public.h"
 #include "RasterInfoWidget.h"
 #include "VectorElement.h"
+#include "LayerMetadata.h"
+#include "ProjectSession.h"
 
 class FileWidget : public QDockWidget 
 {
@@ -17,17 +25,50 @@ public:
 
     void rasterResample(const QString& filePath);  //栅格重采样
 
+    void rasterCalculator(const QString& filePath); // 波段表达式计算，后台写出新栅格
+
     void vectorBuffer(const QString& filePath);
 
+    void zonalStatistics(const QString& filePath); // 面图层对列表中的栅格做分区统计
+
+    void clipRasterToFeatures(const QString& filePath); // 按地图或要素表中选中的面裁剪
+
+    void vectorOverlay(const QString& filePath); // 与列表中的面图层求交、裁剪或擦除
+
+    void rasterPolygonize(const QString& filePath); // 栅格转面，输出 Shapefile
+
+    void vectorRasterize(const QString& filePath); // 矢量转栅格，输出 GeoTIFF
+
+    void vectorSymbology(const QString& filePath); // 单一颜色 / 按字段分类 / 分级显示
+
+    void vectorLabels(const QString& filePath); // 按字段标注要素
+
+    void importFiles(const QStringList& paths); // 导入文件或文件夹，并行读取元数据后一次性加入列表
+
+    QList<T_ProjectLayer> projectLayers() const; // 按列表顺序导出图层、样式与元数据
+    void restoreLayers(const QList<T_ProjectLayer>& layers); // 替换整个列表；元数据仍有效的图层立即显示
+
 public slots:
     void appendFile();
 
+    void appendFolder();
+
+    void appendVirtualPath(); // 输入 /vsi 路径或 URL
+
+    void newMosaic(); // 选择一组栅格生成镶嵌图层
+
     void openInfoWidget(QString filePath);
 
     void addResampledFile(const QString& outputPath);
 
     void addBufferFile(const QString& outputPath);
 
+    void selectFeatures(const QString& filePath, const QList<qint64>& featureIds); // 地图选择同步到要素表
+
+    void requestMetadata(const QString& filePath); // 后台（重新）读取元数据
+
+    void clipRasterToExtent(const QRectF& extent); // 裁剪工具框选范围后选择栅格并裁剪
+
 signals:
     void bufferPathDeliverer(const QString& filePath,double radius);
 
@@ -35,6 +76,10 @@ signals:
 
     void fileListUpdated(const QMap<QString, T_Information>& fileList);
 
+    void layerDataChanged(const QString& filePath); // 图层数据已写回文件，需要重建
+
+    void featuresSelected(const QString& filePath, const QList<qint64>& featureIds); // 要素表中选中的要素
+
 
 
 
@@ -46,6 +91,26 @@ private:
     QStandardItemModel* m_model;
     QModelIndex m_contextMenuIndex; // 保存右键时的项索引
 
+    QString m_selectedLayer; // 当前选中要素所在图层
+    QList<qint64> m_selectedIds; // 当前选中要素的 FID
+
+    QVBoxLayout* m_progressLayout; // 后台任务进度：每个导入批次或分析任务一行，互不覆盖
+
+    QProgressBar* createProgressBar(const QString& format, int maximum); // maximum 为 0 时为忙碌状态，任务结束后由调用方删除
+
+    QStandardItem* createFileItem(const QString& filePath, bool isVisible);
+    void addScannedFiles(const QList<T_LayerMetadata>& records); // 一批扫描结果加入模型
+    void addOutputFile(const QString& outputPath); // 加入分析结果文件
+    void runOutputJob(const QString& progressFormat, const QString& errorTitle, const QString& outputPath,
+        const std::function<QString(QPromise<QString>&)>& job); // 后台执行分析任务，成功后加入结果文件
+    void createMosaic(const QStringList& sourcePaths); // 后台生成 VRT 后替换源图层
+    void setItemMetadata(QStandardItem* item, const T_LayerMetadata& metadata);
+    void applyMetadata(const T_LayerMetadata& metadata); // 写入模型角色并通知地图
+
+protected:
+    void dragEnterEvent(QDragEnterEvent* event) override;
+    void dropEvent(QDropEvent* event) override;
+
 private slots:
     // 新增右键菜单槽函数
     void onCustomContextMenuRequested(const QPoint& pos);
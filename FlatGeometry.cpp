@@ -0,0 +1,313 @@
+#include "FlatGeometry.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "VsiSupport.h"
+
+// 映射内存按原样解释为坐标数组，要求 qreal 为 double
+static_assert(sizeof(QPointF) == 2 * sizeof(double), "QPointF must be two doubles");
+static_assert(sizeof(QRectF) == 4 * sizeof(double), "QRectF must be four doubles");
+
+namespace {
+	const char kMagic[8] = { 'Y', 'G', 'I', 'S', 'G', 'E', 'O', 'M' };
+	const quint32 kCacheVersion = 1;	//格式变化时递增，旧缓存自动失效
+	const quint32 kByteOrderMark = 0x01020304;
+
+	enum Section {
+		PointSection,
+		PartSection,
+		FeaturePartSection,
+		FeatureIdSection,
+		BoundsSection,
+		KindSection,
+		NodeBoxSection,
+		NodeIndexSection,
+		LevelSection,
+		SectionCount
+	};
+
+	// 文件头，其后各数组按 8 字节对齐依次存放
+	struct T_CacheHeader {
+		char magic[8];
+		quint32 version;
+		quint32 byteOrder;	//写入端的字节序，与读取端不同则不使用
+		qint64 sourceSize;
+		qint64 sourceModified;
+		qint64 featureCount;
+		qint64 partCount;
+		qint64 pointCount;
+		qint64 nodeCount;
+		qint64 levelCount;
+		quint32 nodeSize;
+		quint32 featureIdsSorted;
+		qint64 sectionOffset[SectionCount];
+		qint64 sectionSize[SectionCount];
+	};
+
+	qint64 alignUp(qint64 value) {
+		return (value + 7) & ~qint64(7);
+	}
+
+	// 各数组的字节数
+	void sectionSizes(const T_CacheHeader& header, qint64 sizes[SectionCount]) {
+		sizes[PointSection] = header.pointCount * qint64(sizeof(QPointF));
+		sizes[PartSection] = (header.partCount + 1) * qint64(sizeof(qint64));
+		sizes[FeaturePartSection] = (header.featureCount + 1) * qint64(sizeof(qint64));
+		sizes[FeatureIdSection] = header.featureCount * qint64(sizeof(qint64));
+		sizes[BoundsSection] = header.featureCount * qint64(sizeof(QRectF));
+		sizes[KindSection] = header.featureCount * qint64(sizeof(uchar));
+		sizes[NodeBoxSection] = header.nodeCount * 4 * qint64(sizeof(double));
+		sizes[NodeIndexSection] = header.nodeCount * qint64(sizeof(int));
+		sizes[LevelSection] = header.levelCount * qint64(sizeof(int));
+	}
+
+	// Shapefile 的几何、索引与属性分属三个文件，删除要素只改动 .dbf，三者一起核对
+	bool sourceStamp(const QString& filePath, qint64& size, qint64& modified) {
+		const QFileInfo fileInfo(filePath);
+		if (!fileInfo.exists()) return false;
+		size = fileInfo.size();
+		modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+		const QString suffix = fileInfo.suffix();
+		if (suffix.compare("shp", Qt::CaseInsensitive) != 0) return true;
+		const bool upper = suffix == "SHP";
+		for (const char* sibling : { "shx", "dbf" }) {
+			const QFileInfo siblingInfo(fileInfo.absoluteDir().filePath(
+				fileInfo.completeBaseName() + '.' + (upper ? QString(sibling).toUpper() : QString(sibling))));
+			if (!siblingInfo.exists()) continue;
+			size += siblingInfo.size();
+			modified = std::max(modified, siblingInfo.lastModified().toMSecsSinceEpoch());
+		}
+		return true;
+	}
+
+	QString cacheFilePath(const QString& filePath) {
+		const QByteArray hash = QCryptographicHash::hash(
+			QFileInfo(filePath).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+		return QDir(GeometryCache::cacheDirectory()).filePath(QString::fromLatin1(hash) + ".ygeom");
+	}
+}
+
+FlatGeometry::FlatGeometry() {
+	clear();
+}
+
+FlatGeometry::~FlatGeometry() = default;
+
+void FlatGeometry::clear() {
+	m_points.clear();
+	m_partOffsets.clear();	//偏移数组的首个 0 在加入第一个要素时写入，映射的图层不占用内存区
+	m_featureParts.clear();
+	m_featureIds.clear();
+	m_bounds.clear();
+	m_kinds.clear();
+	m_index.clear();
+	m_pendingFeatureId = -1;
+	b_featureIdsSorted = true;
+	m_mappedFile.reset();	//视图指向的映射随之释放
+	updateViews();
+}
+
+void FlatGeometry::reserve(int featureCount) {
+	m_index.reserve(featureCount);	//其余数组按需提交，无需预先分配
+}
+
+qint64 FlatGeometry::memoryUsage() const {
+	return m_points.memoryUsage() + m_partOffsets.memoryUsage() + m_featureParts.memoryUsage() +
+		m_featureIds.memoryUsage() + m_bounds.memoryUsage() + m_kinds.memoryUsage();
+}
+
+void FlatGeometry::beginFeature(qint64 featureId) {
+	if (m_featureParts.isEmpty()) {
+		m_partOffsets.append(0);
+		m_featureParts.append(0);
+	}
+	m_pendingFeatureId = featureId;
+}
+
+QPointF* FlatGeometry::appendPart(qint64 pointCount) {
+	QPointF* points = m_points.grow(pointCount);
+	m_partOffsets.append(m_points.size());
+	return points;
+}
+
+bool FlatGeometry::endFeature(uchar kind) {
+	const qint64 firstPart = m_featureParts.last();
+	const qint64 endPart = m_partOffsets.size() - 1;
+	const qint64 firstPoint = m_partOffsets[firstPart];
+	const qint64 endPoint = m_points.size();
+	if (endPoint == firstPoint) {
+		// 没有点：撤销空部件
+		m_partOffsets.resize(firstPart + 1);
+		return false;
+	}
+
+	double minX = std::numeric_limits<double>::infinity(), minY = minX;
+	double maxX = -std::numeric_limits<double>::infinity(), maxY = maxX;
+	for (const QPointF* pt = m_points.constData() + firstPoint, *end = m_points.constData() + endPoint; pt != end; ++pt) {
+		minX = std::min(minX, pt->x());
+		minY = std::min(minY, pt->y());
+		maxX = std::max(maxX, pt->x());
+		maxY = std::max(maxY, pt->y());
+	}
+	const QRectF bounds(QPointF(minX, minY), QPointF(maxX, maxY));
+
+	if (!m_featureIds.isEmpty() && m_pendingFeatureId <= m_featureIds.last()) b_featureIdsSorted = false;
+	m_featureParts.append(endPart);
+	m_featureIds.append(m_pendingFeatureId);
+	m_bounds.append(bounds);
+	m_kinds.append(kind);
+	m_index.add(bounds);
+	return true;
+}
+
+void FlatGeometry::finish() {
+	m_index.finish();
+	updateViews();
+}
+
+void FlatGeometry::updateViews() {
+	static const qint64 kEmptyOffsets[1] = { 0 };	//没有要素时的偏移数组
+	m_featureCount = static_cast<int>(m_featureIds.size());
+	m_pointData = m_points.constData();
+	m_partData = m_partOffsets.isEmpty() ? kEmptyOffsets : m_partOffsets.constData();
+	m_featurePartData = m_featureParts.isEmpty() ? kEmptyOffsets : m_featureParts.constData();
+	m_featureIdData = m_featureIds.constData();
+	m_boundsData = m_bounds.constData();
+	m_kindData = m_kinds.constData();
+}
+
+int FlatGeometry::slotOf(qint64 featureId) const {
+	// 多数驱动的 FID 即从 0 开始的顺序号
+	if (featureId >= 0 && featureId < m_featureCount && m_featureIdData[featureId] == featureId) {
+		return static_cast<int>(featureId);
+	}
+	const qint64* begin = m_featureIdData;
+	const qint64* end = m_featureIdData + m_featureCount;
+	const qint64* it = b_featureIdsSorted ? std::lower_bound(begin, end, featureId) : std::find(begin, end, featureId);
+	return (it != end && *it == featureId) ? static_cast<int>(it - begin) : -1;
+}
+
+bool FlatGeometry::save(const QString& cachePath, qint64 sourceSize, qint64 sourceModified) const {
+	T_CacheHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kCacheVersion;
+	header.byteOrder = kByteOrderMark;
+	header.sourceSize = sourceSize;
+	header.sourceModified = sourceModified;
+	header.featureCount = m_featureCount;
+	header.partCount = m_featurePartData[m_featureCount];
+	header.pointCount = m_partData[header.partCount];
+	header.nodeCount = m_index.nodeCount();
+	header.levelCount = m_index.levelCount();
+	header.nodeSize = static_cast<quint32>(m_index.nodeSize());
+	header.featureIdsSorted = b_featureIdsSorted ? 1 : 0;
+
+	const void* sections[SectionCount] = {
+		m_pointData, m_partData, m_featurePartData, m_featureIdData, m_boundsData, m_kindData,
+		m_index.nodeBoxes(), m_index.nodeIndices(), m_index.levelBounds()
+	};
+	sectionSizes(header, header.sectionSize);
+	qint64 offset = alignUp(sizeof(T_CacheHeader));
+	for (int i = 0; i < SectionCount; ++i) {
+		header.sectionOffset[i] = offset;
+		offset = alignUp(offset + header.sectionSize[i]);
+	}
+
+	QSaveFile file(cachePath);
+	if (!file.open(QIODevice::WriteOnly)) return false;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (int i = 0; i < SectionCount; ++i) {
+		const QByteArray padding(header.sectionOffset[i] - file.pos(), '\0');
+		file.write(padding);
+		if (header.sectionSize[i] > 0 &&
+			file.write(static_cast<const char*>(sections[i]), header.sectionSize[i]) != header.sectionSize[i]) {
+			file.cancelWriting();
+			return false;
+		}
+	}
+	return file.commit();
+}
+
+bool FlatGeometry::map(const QString& cachePath, qint64 sourceSize, qint64 sourceModified) {
+	std::unique_ptr<QFile> file(new QFile(cachePath));
+	if (!file->open(QIODevice::ReadOnly)) return false;
+	const qint64 fileSize = file->size();
+	if (fileSize < qint64(sizeof(T_CacheHeader))) return false;
+
+	const uchar* base = file->map(0, fileSize);
+	if (!base) return false;
+
+	T_CacheHeader header;
+	std::memcpy(&header, base, sizeof(header));
+	if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kCacheVersion ||
+		header.byteOrder != kByteOrderMark) return false;
+	if (header.sourceSize != sourceSize || header.sourceModified != sourceModified) return false;
+	if (header.featureCount < 0 || header.featureCount > std::numeric_limits<int>::max() ||
+		header.nodeCount < 0 || header.nodeCount > std::numeric_limits<int>::max() / 4 ||
+		header.levelCount < 0 || header.partCount < 0 || header.pointCount < 0) return false;
+
+	// 只做常数时间的一致性检查，打开时不遍历数据
+	qint64 expected[SectionCount];
+	sectionSizes(header, expected);
+	for (int i = 0; i < SectionCount; ++i) {
+		if (header.sectionSize[i] != expected[i] || header.sectionOffset[i] % 8 != 0 ||
+			header.sectionOffset[i] < qint64(sizeof(T_CacheHeader)) ||
+			header.sectionOffset[i] + header.sectionSize[i] > fileSize) return false;
+	}
+	const qint64* featureParts = reinterpret_cast<const qint64*>(base + header.sectionOffset[FeaturePartSection]);
+	const qint64* parts = reinterpret_cast<const qint64*>(base + header.sectionOffset[PartSection]);
+	if (featureParts[0] != 0 || featureParts[header.featureCount] != header.partCount ||
+		parts[0] != 0 || parts[header.partCount] != header.pointCount) return false;
+
+	clear();
+	m_featureCount = static_cast<int>(header.featureCount);
+	m_pointData = reinterpret_cast<const QPointF*>(base + header.sectionOffset[PointSection]);
+	m_partData = parts;
+	m_featurePartData = featureParts;
+	m_featureIdData = reinterpret_cast<const qint64*>(base + header.sectionOffset[FeatureIdSection]);
+	m_boundsData = reinterpret_cast<const QRectF*>(base + header.sectionOffset[BoundsSection]);
+	m_kindData = base + header.sectionOffset[KindSection];
+	b_featureIdsSorted = header.featureIdsSorted != 0;
+	m_index.wrap(static_cast<int>(header.nodeSize), m_featureCount,
+		reinterpret_cast<const double*>(base + header.sectionOffset[NodeBoxSection]),
+		reinterpret_cast<const int*>(base + header.sectionOffset[NodeIndexSection]), static_cast<int>(header.nodeCount),
+		reinterpret_cast<const int*>(base + header.sectionOffset[LevelSection]), static_cast<int>(header.levelCount));
+	m_mappedFile = std::move(file);
+	return true;
+}
+
+bool GeometryCache::isEnabled() {
+	return QSettings().value("vector/geometryCache", true).toBool();
+}
+
+bool GeometryCache::load(const QString& filePath, FlatGeometry& geometry) {
+	if (!isEnabled() || VsiSupport::isVirtualPath(filePath)) return false;
+	qint64 size = 0, modified = 0;
+	if (!sourceStamp(filePath, size, modified)) return false;
+	return geometry.map(cacheFilePath(filePath), size, modified);
+}
+
+void GeometryCache::store(const QString& filePath, const FlatGeometry& geometry) {
+	if (!isEnabled() || VsiSupport::isVirtualPath(filePath) || geometry.isMapped()) return;
+	qint64 size = 0, modified = 0;
+	if (!sourceStamp(filePath, size, modified)) return;
+	if (!QDir().mkpath(cacheDirectory())) return;
+	geometry.save(cacheFilePath(filePath), size, modified);
+}
+
+void GeometryCache::invalidate(const QString& filePath) {
+	QFile::remove(cacheFilePath(filePath));
+}
+
+QString GeometryCache::cacheDirectory() {
+	return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("geometry-cache");
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+#include <memory>
+#include "SpatialIndex.h"
+#include "Arena.h"
+
+class QFile;
+
+// 扁平几何：全部要素的坐标连续存放，按 要素 -> 部件 -> 点 两级偏移索引。
+// 数组可以是读取 OGR 时自建的，也可以直接指向内存映射的旁路缓存文件：
+// 后者打开时不解析、不复制，绘制与查询直接读映射内存，多个进程通过页缓存共享
+class FlatGeometry {
+public:
+	FlatGeometry();
+	~FlatGeometry();
+	FlatGeometry(const FlatGeometry&) = delete;
+	FlatGeometry& operator=(const FlatGeometry&) = delete;
+
+	void clear();
+	void reserve(int featureCount);
+
+	// 构建：beginFeature 后追加若干部件，endFeature 计算外包矩形；全部要素加入后 finish 建立空间索引
+	void beginFeature(qint64 featureId);
+	QPointF* appendPart(qint64 pointCount);	//返回新部件的坐标区，由调用方填写（场景坐标）
+	bool endFeature(uchar kind);	//没有任何点的要素被丢弃，返回是否加入
+	void finish();
+
+	bool isMapped() const { return m_mappedFile != nullptr; }
+	qint64 memoryUsage() const;	//自建数组占用的字节数（映射时为 0）
+
+	// 只读访问，自建与映射两种来源相同
+	int featureCount() const { return m_featureCount; }
+	qint64 featureId(int slot) const { return m_featureIdData[slot]; }
+	uchar kind(int slot) const { return m_kindData[slot]; }	//VectorLayerItem::GeometryKind
+	const QRectF& bounds(int slot) const { return m_boundsData[slot]; }
+	qint64 partBegin(int slot) const { return m_featurePartData[slot]; }
+	qint64 partEnd(int slot) const { return m_featurePartData[slot + 1]; }
+	const QPointF* partPoints(qint64 part) const { return m_pointData + m_partData[part]; }
+	int partSize(qint64 part) const { return static_cast<int>(m_partData[part + 1] - m_partData[part]); }
+	int slotOf(qint64 featureId) const;	//FID -> 条目编号，不存在时返回 -1
+
+	const SpatialIndex& index() const { return m_index; }
+	QRectF extent() const { return m_index.bounds(); }
+
+	// 旁路缓存：source* 为源文件的大小与修改时间，打开时不一致则视为失效
+	bool save(const QString& cachePath, qint64 sourceSize, qint64 sourceModified) const;
+	bool map(const QString& cachePath, qint64 sourceSize, qint64 sourceModified);
+
+private:
+	void updateViews();	//自建数组 -> 只读视图
+
+	// 自建数组（映射时为空），放在各自的内存区中，加载过程中不搬移，图层释放时整段归还
+	ArenaArray<QPointF> m_points;
+	ArenaArray<qint64> m_partOffsets;	//部件 i 的点为 [m_partOffsets[i], m_partOffsets[i + 1])
+	ArenaArray<qint64> m_featureParts;	//要素 i 的部件为 [m_featureParts[i], m_featureParts[i + 1])
+	ArenaArray<qint64> m_featureIds;
+	ArenaArray<QRectF> m_bounds;
+	ArenaArray<uchar> m_kinds;
+	SpatialIndex m_index;
+
+	qint64 m_pendingFeatureId;
+	bool b_featureIdsSorted;	//FID 递增时按二分查找定位要素
+
+	// 只读视图：指向自建数组或映射内存
+	int m_featureCount;
+	const QPointF* m_pointData;
+	const qint64* m_partData;
+	const qint64* m_featurePartData;
+	const qint64* m_featureIdData;
+	const QRectF* m_boundsData;
+	const uchar* m_kindData;
+
+	std::unique_ptr<QFile> m_mappedFile;
+};
+
+// 矢量图层的几何旁路缓存，存放在用户缓存目录，以源文件（及 Shapefile 的 .shx/.dbf）的大小与修改时间核对
+namespace GeometryCache {
+	bool isEnabled();	//设置项 vector/geometryCache，默认开启
+	bool load(const QString& filePath, FlatGeometry& geometry);	//映射有效的缓存
+	void store(const QString& filePath, const FlatGeometry& geometry);	//写入缓存（只针对本地文件）
+	void invalidate(const QString& filePath);
+	QString cacheDirectory();
+}
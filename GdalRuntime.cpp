@@ -0,0 +1,147 @@
+#include "GdalRuntime.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <mutex>
+#include <gdal.h>
+#include <ogr_api.h>
+#include <cpl_conv.h>
+#include <cpl_string.h>
+
+namespace {
+	std::once_flag g_initializeOnce;
+
+	QMutex& settingsMutex() {
+		static QMutex mutex;
+		return mutex;
+	}
+
+	T_GdalSettings loadSettings() {
+		const T_GdalSettings defaults;
+		T_GdalSettings result;
+		QSettings settings;
+		settings.beginGroup("gdal");
+		result.cacheMaxMB = settings.value("cacheMaxMB", defaults.cacheMaxMB).toInt();
+		result.numThreads = settings.value("numThreads", defaults.numThreads).toInt();
+		result.datasetPoolSize = settings.value("datasetPoolSize", defaults.datasetPoolSize).toInt();
+		settings.endGroup();
+
+		// 虚拟文件系统选项沿用原来的 vsi 分组
+		settings.beginGroup("vsi");
+		result.vsiCacheEnabled = settings.value("cacheEnabled", defaults.vsiCacheEnabled).toBool();
+		result.vsiCacheMB = settings.value("cacheSizeMB", defaults.vsiCacheMB).toInt();
+		result.curlCacheMB = settings.value("curlCacheSizeMB", defaults.curlCacheMB).toInt();
+		result.disableReadDir = settings.value("disableReadDir", defaults.disableReadDir).toString();
+		result.multiRange = settings.value("multiRange", defaults.multiRange).toString();
+		settings.endGroup();
+		return result;
+	}
+
+	void saveSettings(const T_GdalSettings& value) {
+		QSettings settings;
+		settings.beginGroup("gdal");
+		settings.setValue("cacheMaxMB", value.cacheMaxMB);
+		settings.setValue("numThreads", value.numThreads);
+		settings.setValue("datasetPoolSize", value.datasetPoolSize);
+		settings.endGroup();
+		settings.beginGroup("vsi");
+		settings.setValue("cacheEnabled", value.vsiCacheEnabled);
+		settings.setValue("cacheSizeMB", value.vsiCacheMB);
+		settings.setValue("curlCacheSizeMB", value.curlCacheMB);
+		settings.setValue("disableReadDir", value.disableReadDir);
+		settings.setValue("multiRange", value.multiRange);
+		settings.endGroup();
+	}
+
+	// overrideEnvironment 为 false 时，环境变量或命令行已设置的选项保持不变
+	bool setOption(const char* key, const QByteArray& value, bool overrideEnvironment) {
+		if (!overrideEnvironment && CPLGetConfigOption(key, nullptr)) return false;
+		CPLSetConfigOption(key, value.constData());
+		return true;
+	}
+
+	void applyOptions(const T_GdalSettings& value, bool overrideEnvironment) {
+		// 块缓存上限直接设置，GDAL 已经读取过 GDAL_CACHEMAX 时同样生效
+		if (setOption("GDAL_CACHEMAX", QByteArray::number(value.cacheMaxMB), overrideEnvironment)) {
+			GDALSetCacheMax64(static_cast<GIntBig>(value.cacheMaxMB) * 1024 * 1024);
+		}
+		setOption("GDAL_NUM_THREADS", value.numThreads > 0 ? QByteArray::number(value.numThreads) : QByteArray("ALL_CPUS"), overrideEnvironment);
+		setOption("GDAL_MAX_DATASET_POOL_SIZE", QByteArray::number(value.datasetPoolSize), overrideEnvironment);
+
+		// 远程与压缩文件的块缓存：重复读取同一区域时不再发起请求或重新解压
+		setOption("VSI_CACHE", value.vsiCacheEnabled ? "TRUE" : "FALSE", overrideEnvironment);
+		setOption("VSI_CACHE_SIZE", QByteArray::number(static_cast<qint64>(value.vsiCacheMB) * 1024 * 1024), overrideEnvironment);
+		setOption("CPL_VSIL_CURL_CACHE_SIZE", QByteArray::number(static_cast<qint64>(value.curlCacheMB) * 1024 * 1024), overrideEnvironment);
+
+		// 打开远程文件时不列目录，避免一次额外的请求；多个范围请求并行发出并合并相邻范围
+		setOption("GDAL_DISABLE_READDIR_ON_OPEN", value.disableReadDir.toUtf8(), overrideEnvironment);
+		setOption("GDAL_HTTP_MULTIRANGE", value.multiRange.toUtf8(), overrideEnvironment);
+		setOption("GDAL_HTTP_MERGE_CONSECUTIVE_RANGES", "YES", overrideEnvironment);
+	}
+
+	// 读取实际生效的值（可能来自环境变量）
+	T_GdalSettings effectiveSettings() {
+		T_GdalSettings result = loadSettings();
+		result.cacheMaxMB = static_cast<int>(GDALGetCacheMax64() / (1024 * 1024));
+		const QByteArray threads = CPLGetConfigOption("GDAL_NUM_THREADS", "ALL_CPUS");
+		result.numThreads = threads.compare("ALL_CPUS", Qt::CaseInsensitive) == 0 ? 0 : threads.toInt();
+		result.datasetPoolSize = QByteArray(CPLGetConfigOption("GDAL_MAX_DATASET_POOL_SIZE", "100")).toInt();
+		result.vsiCacheEnabled = CPLTestBool(CPLGetConfigOption("VSI_CACHE", "FALSE"));
+		result.vsiCacheMB = static_cast<int>(QByteArray(CPLGetConfigOption("VSI_CACHE_SIZE", "25000000")).toLongLong() / (1024 * 1024));
+		result.curlCacheMB = static_cast<int>(QByteArray(CPLGetConfigOption("CPL_VSIL_CURL_CACHE_SIZE", "16384000")).toLongLong() / (1024 * 1024));
+		result.disableReadDir = QString::fromUtf8(CPLGetConfigOption("GDAL_DISABLE_READDIR_ON_OPEN", "FALSE"));
+		result.multiRange = QString::fromUtf8(CPLGetConfigOption("GDAL_HTTP_MULTIRANGE", "SINGLE_GET"));
+		return result;
+	}
+}
+
+void GdalRuntime::initialize() {
+	std::call_once(g_initializeOnce, [] {
+		GDALAllRegister();
+		OGRRegisterAll();
+		const QMutexLocker locker(&settingsMutex());
+		applyOptions(loadSettings(), false);
+		});
+}
+
+T_GdalSettings GdalRuntime::settings() {
+	initialize();
+	const QMutexLocker locker(&settingsMutex());
+	return effectiveSettings();
+}
+
+T_GdalSettings GdalRuntime::defaults() {
+	return T_GdalSettings();
+}
+
+void GdalRuntime::apply(const T_GdalSettings& settings) {
+	initialize();
+	const QMutexLocker locker(&settingsMutex());
+	saveSettings(settings);
+	applyOptions(settings, true);
+}
+
+bool GdalRuntime::requiresRestart(const T_GdalSettings& before, const T_GdalSettings& after) {
+	return before.datasetPoolSize != after.datasetPoolSize || before.vsiCacheMB != after.vsiCacheMB
+		|| before.curlCacheMB != after.curlCacheMB;
+}
+
+QThreadPool* GdalRuntime::analysisPool() {
+	static QThreadPool* pool = [] {
+		QThreadPool* threadPool = new QThreadPool;
+		threadPool->setMaxThreadCount(std::max(2, QThread::idealThreadCount()));
+		return threadPool;
+	}();
+	return pool;
+}
+
+qint64 GdalRuntime::cacheUsed() {
+	return GDALGetCacheUsed64();
+}
+
+qint64 GdalRuntime::cacheMax() {
+	return GDALGetCacheMax64();
+}
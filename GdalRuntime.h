@@ -0,0 +1,40 @@
+#pragma once
+#include <QString>
+
+class QThreadPool;
+
+// GDAL 运行参数，保存在 QSettings 中
+struct T_GdalSettings {
+	int cacheMaxMB = 512;	//GDAL_CACHEMAX：栅格块缓存
+	int numThreads = 0;	//GDAL_NUM_THREADS：驱动内部的解码 / 压缩线程数，0 为全部核心
+	int datasetPoolSize = 64;	//GDAL_MAX_DATASET_POOL_SIZE：镶嵌图层（VRT）同时打开的源文件数
+	bool vsiCacheEnabled = true;	//VSI_CACHE：远程与压缩文件的块缓存
+	int vsiCacheMB = 64;	//VSI_CACHE_SIZE
+	int curlCacheMB = 128;	//CPL_VSIL_CURL_CACHE_SIZE：HTTP 范围请求的缓存
+	QString disableReadDir = "EMPTY_DIR";	//GDAL_DISABLE_READDIR_ON_OPEN：打开远程文件时不列目录
+	QString multiRange = "YES";	//GDAL_HTTP_MULTIRANGE：多个范围请求并行发出
+};
+
+// GDAL 运行环境：注册驱动并按设置配置块缓存、线程数与虚拟文件系统选项，整个进程只初始化一次。
+// 可在任意线程调用；DatasetPool 打开数据集前会确保已初始化
+namespace GdalRuntime {
+	// 第一次调用时注册全部驱动并应用保存的设置；环境变量中已设置的选项不覆盖
+	void initialize();
+
+	T_GdalSettings settings();	//当前生效的设置
+	T_GdalSettings defaults();
+
+	// 保存并设置配置项（覆盖环境变量）。块缓存上限立即生效，缩小时 GDAL 会逐步释放多余的块；
+	// 线程数、VSI_CACHE、列目录与多范围请求对之后打开或读取的文件生效；
+	// 数据集池大小与两种缓存大小只在 GDAL 第一次创建池或缓存时读取，重启程序后才生效
+	void apply(const T_GdalSettings& settings);
+
+	bool requiresRestart(const T_GdalSettings& before, const T_GdalSettings& after);	//修改了只在启动时读取的选项
+
+	// 后台分析共用的线程池（栅格计算、分区统计、叠加、转换、符号化与元数据扫描），线程数为 CPU 核心数。
+	// 多个任务同时运行时分摊这些线程，不会各自占满全部核心
+	QThreadPool* analysisPool();
+
+	qint64 cacheUsed();	//块缓存当前占用（字节）
+	qint64 cacheMax();	//块缓存上限（字节）
+}
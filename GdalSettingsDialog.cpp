@@ -0,0 +1,136 @@
+#include "GdalSettingsDialog.h"
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include "DatasetPool.h"
+
+GdalSettingsDialog::GdalSettingsDialog(QWidget* parent)
+	: QDialog(parent) {
+	setWindowTitle("GDAL 设置");
+
+	// 块缓存与线程
+	m_cacheMaxSpin = new QSpinBox(this);
+	m_cacheMaxSpin->setRange(16, 65536);
+	m_cacheMaxSpin->setSingleStep(64);
+	m_cacheMaxSpin->setSuffix(" MB");
+	m_threadSpin = new QSpinBox(this);
+	m_threadSpin->setRange(0, 256);
+	m_threadSpin->setSpecialValueText(QString("全部核心（%1）").arg(QThread::idealThreadCount()));
+	m_poolSizeSpin = new QSpinBox(this);
+	m_poolSizeSpin->setRange(8, 4096);
+	m_usageLabel = new QLabel(this);
+	m_usageBar = new QProgressBar(this);
+	m_usageBar->setRange(0, 1000);
+	m_usageBar->setTextVisible(false);
+
+	QGroupBox* cacheGroup = new QGroupBox("块缓存与线程", this);
+	QFormLayout* cacheLayout = new QFormLayout(cacheGroup);
+	cacheLayout->addRow("块缓存上限（GDAL_CACHEMAX）：", m_cacheMaxSpin);
+	cacheLayout->addRow("当前占用：", m_usageLabel);
+	cacheLayout->addRow(QString(), m_usageBar);
+	cacheLayout->addRow("驱动线程数（GDAL_NUM_THREADS）：", m_threadSpin);
+	cacheLayout->addRow("* 镶嵌源文件上限（GDAL_MAX_DATASET_POOL_SIZE）：", m_poolSizeSpin);
+
+	// 压缩包与远程文件
+	m_vsiCacheCheck = new QCheckBox("启用（VSI_CACHE）", this);
+	m_vsiCacheSpin = new QSpinBox(this);
+	m_vsiCacheSpin->setRange(1, 16384);
+	m_vsiCacheSpin->setSuffix(" MB");
+	m_curlCacheSpin = new QSpinBox(this);
+	m_curlCacheSpin->setRange(1, 16384);
+	m_curlCacheSpin->setSuffix(" MB");
+	m_readDirCombo = new QComboBox(this);
+	m_readDirCombo->addItems({ "EMPTY_DIR", "TRUE", "FALSE" });
+	m_multiRangeCombo = new QComboBox(this);
+	m_multiRangeCombo->addItems({ "YES", "NO", "SINGLE_GET" });
+	connect(m_vsiCacheCheck, &QCheckBox::toggled, m_vsiCacheSpin, &QSpinBox::setEnabled);
+
+	QGroupBox* ioGroup = new QGroupBox("压缩包与远程文件", this);
+	QFormLayout* ioLayout = new QFormLayout(ioGroup);
+	ioLayout->addRow("文件块缓存：", m_vsiCacheCheck);
+	ioLayout->addRow("* 文件块缓存大小（VSI_CACHE_SIZE）：", m_vsiCacheSpin);
+	ioLayout->addRow("* HTTP 缓存（CPL_VSIL_CURL_CACHE_SIZE）：", m_curlCacheSpin);
+	ioLayout->addRow("打开时不列目录（GDAL_DISABLE_READDIR_ON_OPEN）：", m_readDirCombo);
+	ioLayout->addRow("多范围请求（GDAL_HTTP_MULTIRANGE）：", m_multiRangeCombo);
+
+	QDialogButtonBox* buttons = new QDialogButtonBox(
+		QDialogButtonBox::Ok | QDialogButtonBox::Cancel | QDialogButtonBox::RestoreDefaults, this);
+	connect(buttons, &QDialogButtonBox::accepted, this, &GdalSettingsDialog::accept);
+	connect(buttons, &QDialogButtonBox::rejected, this, &GdalSettingsDialog::reject);
+	connect(buttons->button(QDialogButtonBox::RestoreDefaults), &QPushButton::clicked, this, [=] {
+		setValues(GdalRuntime::defaults());
+		});
+
+	QLabel* restartNote = new QLabel("* 重启程序后生效；其余选项对之后打开或读取的文件生效", this);
+	restartNote->setEnabled(false);
+
+	QVBoxLayout* layout = new QVBoxLayout(this);
+	layout->addWidget(cacheGroup);
+	layout->addWidget(ioGroup);
+	layout->addWidget(restartNote);
+	layout->addWidget(buttons);
+
+	m_initial = GdalRuntime::settings();
+	setValues(m_initial);
+
+	// 块缓存占用随地图绘制变化，对话框打开期间持续刷新
+	m_usageTimer = new QTimer(this);
+	m_usageTimer->setInterval(500);
+	connect(m_usageTimer, &QTimer::timeout, this, &GdalSettingsDialog::updateUsage);
+	m_usageTimer->start();
+	updateUsage();
+}
+
+void GdalSettingsDialog::setValues(const T_GdalSettings& settings) {
+	m_cacheMaxSpin->setValue(settings.cacheMaxMB);
+	m_threadSpin->setValue(settings.numThreads);
+	m_poolSizeSpin->setValue(settings.datasetPoolSize);
+	m_vsiCacheCheck->setChecked(settings.vsiCacheEnabled);
+	m_vsiCacheSpin->setEnabled(settings.vsiCacheEnabled);
+	m_vsiCacheSpin->setValue(settings.vsiCacheMB);
+	m_curlCacheSpin->setValue(settings.curlCacheMB);
+	m_readDirCombo->setCurrentIndex(std::max(0, m_readDirCombo->findText(settings.disableReadDir, Qt::MatchFixedString)));
+	m_multiRangeCombo->setCurrentIndex(std::max(0, m_multiRangeCombo->findText(settings.multiRange, Qt::MatchFixedString)));
+}
+
+T_GdalSettings GdalSettingsDialog::values() const {
+	T_GdalSettings settings;
+	settings.cacheMaxMB = m_cacheMaxSpin->value();
+	settings.numThreads = m_threadSpin->value();
+	settings.datasetPoolSize = m_poolSizeSpin->value();
+	settings.vsiCacheEnabled = m_vsiCacheCheck->isChecked();
+	settings.vsiCacheMB = m_vsiCacheSpin->value();
+	settings.curlCacheMB = m_curlCacheSpin->value();
+	settings.disableReadDir = m_readDirCombo->currentText();
+	settings.multiRange = m_multiRangeCombo->currentText();
+	return settings;
+}
+
+void GdalSettingsDialog::updateUsage() {
+	const qint64 used = GdalRuntime::cacheUsed();
+	const qint64 maximum = GdalRuntime::cacheMax();
+	m_usageLabel->setText(QString("%1 / %2 MB").arg(used / 1048576.0, 0, 'f', 1).arg(maximum / 1048576.0, 0, 'f', 1));
+	m_usageBar->setValue(maximum > 0 ? static_cast<int>(std::min<qint64>(1000, used * 1000 / maximum)) : 0);
+}
+
+void GdalSettingsDialog::accept() {
+	const T_GdalSettings settings = values();
+	GdalRuntime::apply(settings);
+	// VSI_CACHE 在打开文件时读取：丢弃池中的句柄（使用中的归还后关闭），之后的读取按新设置重新打开
+	if (settings.vsiCacheEnabled != m_initial.vsiCacheEnabled) DatasetPool::instance().closeAll();
+	if (GdalRuntime::requiresRestart(m_initial, settings)) {
+		QMessageBox::information(this, "GDAL 设置", "数据集池与缓存大小的修改将在重启程序后生效。");
+	}
+	QDialog::accept();
+}
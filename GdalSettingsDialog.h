@@ -0,0 +1,38 @@
+#pragma once
+#include <QDialog>
+#include "GdalRuntime.h"
+
+class QSpinBox;
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QProgressBar;
+class QTimer;
+
+// GDAL 设置对话框：块缓存、线程数与 I/O 选项，确定后保存。
+// 标 * 的选项只在启动时读取，重启程序后生效；打开期间每半秒刷新块缓存占用
+class GdalSettingsDialog : public QDialog {
+	Q_OBJECT
+public:
+	explicit GdalSettingsDialog(QWidget* parent = nullptr);
+
+	void accept() override;
+
+private:
+	void setValues(const T_GdalSettings& settings);
+	T_GdalSettings values() const;
+	void updateUsage();
+
+	QSpinBox* m_cacheMaxSpin;
+	QSpinBox* m_threadSpin;
+	QSpinBox* m_poolSizeSpin;
+	QCheckBox* m_vsiCacheCheck;
+	QSpinBox* m_vsiCacheSpin;
+	QSpinBox* m_curlCacheSpin;
+	QComboBox* m_readDirCombo;
+	QComboBox* m_multiRangeCombo;
+	QLabel* m_usageLabel;
+	QProgressBar* m_usageBar;
+	QTimer* m_usageTimer;
+	T_GdalSettings m_initial;	//打开对话框时的设置，用于判断是否需要重启
+};
@@ -0,0 +1,192 @@
+#include "LabelEngine.h"
+#include <QPainter>
+#include <QFontMetricsF>
+#include <algorithm>
+#include <cmath>
+#include "FlatGeometry.h"
+#include "VectorLayerItem.h"
+
+namespace {
+	const int kLevelsPerOctave = 4;	//缩放级别为四分之一倍程
+	const double kCellSize = 64.0;	//碰撞网格单元（像素）
+	const double kPadding = 2.0;	//标注框与文字的间距（像素）
+	const double kMaxLabelWidth = 256.0;	//更长的文字截断显示
+	const int kCacheKilobytes = 64 * 1024;
+	const int kGridEntryBytes = 48;	//网格中一个标注序号的估计开销（含哈希节点与数组）
+
+	inline quint64 cellKey(int x, int y) {
+		return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+	}
+}
+
+LabelEngine::LabelEngine()
+	: d_maxResolution(0.0), m_layouts(kCacheKilobytes) {
+	m_font.setPointSize(9);
+}
+
+void LabelEngine::setColumn(const T_AttributeColumn& column) {
+	m_column = column;	//隐式共享，不复制数据
+	m_layouts.clear();
+}
+
+void LabelEngine::setStyle(int fontSize, double maxResolution) {
+	d_maxResolution = maxResolution;
+	if (m_font.pointSize() == fontSize) return;
+	m_font.setPointSize(fontSize);
+	m_layouts.clear();	//标注框大小变了，布局作废
+}
+
+void LabelEngine::clear() {
+	m_column = T_AttributeColumn();
+	m_layouts.clear();
+}
+
+LabelEngine::T_Layout* LabelEngine::layout(int level, int featureCount) {
+	if (T_Layout* cached = m_layouts.object(level)) return cached;
+	T_Layout* entry = new T_Layout;
+	entry->scale = std::exp2(static_cast<double>(level) / kLevelsPerOctave);
+	entry->state.fill(-1, featureCount);
+	entry->bytes = qint64(featureCount) * sizeof(qint32);
+	T_Layout* inserted = entry;
+	return m_layouts.insert(level, entry, cacheCost(*entry)) ? inserted : nullptr;
+}
+
+qsizetype LabelEngine::cacheCost(const T_Layout& layout) {
+	return std::clamp<qsizetype>(layout.bytes / 1024, 1, kCacheKilobytes);
+}
+
+QString LabelEngine::text(int slot) const {
+	if (m_column.isNumeric) {
+		const double value = m_column.numbers.value(slot, std::nan(""));
+		return std::isnan(value) ? QString() : QString::number(value, 'g', 8);
+	}
+	const qint32 code = m_column.codes.value(slot, -1);
+	return code < 0 ? QString() : m_column.codeNames.value(code);
+}
+
+QPointF LabelEngine::anchor(const FlatGeometry& geometry, int slot) const {
+	const qint64 part = geometry.partBegin(slot);
+	switch (geometry.kind(slot)) {
+	case VectorLayerItem::PointKind:
+		return geometry.partPoints(part)[0];
+	case VectorLayerItem::LineKind:
+		return geometry.partPoints(part)[geometry.partSize(part) / 2];	//第一段折线的中间节点
+	default:
+		return geometry.bounds(slot).center();
+	}
+}
+
+bool LabelEngine::collides(const T_Layout& layout, const QRectF& pixelBox) const {
+	const int left = static_cast<int>(std::floor(pixelBox.left() / kCellSize));
+	const int right = static_cast<int>(std::floor(pixelBox.right() / kCellSize));
+	const int top = static_cast<int>(std::floor(pixelBox.top() / kCellSize));
+	const int bottom = static_cast<int>(std::floor(pixelBox.bottom() / kCellSize));
+	for (int y = top; y <= bottom; ++y) {
+		for (int x = left; x <= right; ++x) {
+			const auto it = layout.grid.constFind(cellKey(x, y));
+			if (it == layout.grid.cend()) continue;
+			for (int index : it.value()) {
+				if (layout.labels[index].pixelBox.intersects(pixelBox)) return true;
+			}
+		}
+	}
+	return false;
+}
+
+void LabelEngine::place(T_Layout& layout, const FlatGeometry& geometry, int slot, const QFontMetricsF& metrics) const {
+	layout.state[slot] = -2;
+	const QString labelText = text(slot);
+	if (labelText.isEmpty()) return;
+
+	// 锚点已被其他标注覆盖时直接舍弃，不再测量文字；缩小时绝大多数要素在这里结束
+	const QPointF origin = anchor(geometry, slot) * layout.scale;
+	if (collides(layout, QRectF(origin, QSizeF(1.0, 1.0)))) return;
+
+	const QString shown = metrics.elidedText(labelText, Qt::ElideRight, kMaxLabelWidth);
+	const double width = metrics.horizontalAdvance(shown) + 2 * kPadding;
+	const double height = metrics.height() + 2 * kPadding;
+
+	// 比文字一半还小的线、面不标注
+	const QRectF& bounds = geometry.bounds(slot);
+	const bool isPoint = geometry.kind(slot) == VectorLayerItem::PointKind;
+	if (!isPoint && std::max(bounds.width(), bounds.height()) * layout.scale < width * 0.5) return;
+
+	// 点标注依次尝试右、上、左、下；线、面标注居中
+	QVector<QPointF> offsets;
+	if (isPoint) {
+		offsets = { QPointF(4.0, -height / 2), QPointF(-width / 2, -height - 4.0),
+			QPointF(-width - 4.0, -height / 2), QPointF(-width / 2, 4.0) };
+	}
+	else {
+		offsets = { QPointF(-width / 2, -height / 2) };
+	}
+	for (const QPointF& offset : offsets) {
+		const QRectF box(offset, QSizeF(width, height));
+		const QRectF pixelBox = box.translated(origin);
+		if (collides(layout, pixelBox)) continue;
+
+		const int index = layout.labels.size();
+		layout.labels.append(T_PlacedLabel{ slot, box, pixelBox, shown });
+		layout.bytes += sizeof(T_PlacedLabel) + shown.size() * qint64(sizeof(QChar));
+		const int left = static_cast<int>(std::floor(pixelBox.left() / kCellSize));
+		const int right = static_cast<int>(std::floor(pixelBox.right() / kCellSize));
+		const int top = static_cast<int>(std::floor(pixelBox.top() / kCellSize));
+		const int bottom = static_cast<int>(std::floor(pixelBox.bottom() / kCellSize));
+		for (int y = top; y <= bottom; ++y) {
+			for (int x = left; x <= right; ++x) {
+				layout.grid[cellKey(x, y)].append(index);
+				layout.bytes += kGridEntryBytes;
+			}
+		}
+		layout.state[slot] = index;
+		return;
+	}
+}
+
+void LabelEngine::draw(QPainter* painter, const FlatGeometry& geometry, const QRectF& exposedRect, double lod) {
+	if (isEmpty() || lod <= 0.0) return;
+	if (d_maxResolution > 0.0 && 1.0 / lod > d_maxResolution) return;	//缩得太小时不显示
+
+	const int level = static_cast<int>(std::floor(std::log2(lod) * kLevelsPerOctave));
+	T_Layout* current = layout(level, geometry.featureCount());
+	if (!current) return;
+
+	// 锚点在暴露区域外、文字伸入区域内的标注也要绘制，查询范围外扩一个最大标注宽度
+	const double margin = (kMaxLabelWidth + 8.0) / lod;
+	QVector<int> slots = geometry.index().search(exposedRect.adjusted(-margin, -margin, margin, margin));
+	std::sort(slots.begin(), slots.end());	//按要素顺序放置，先出现的要素优先
+
+	// 只为本级别内第一次出现的要素计算位置
+	const QFontMetricsF metrics(m_font, painter->device());
+	const qsizetype oldCost = cacheCost(*current);
+	for (int slot : slots) {
+		if (current->state[slot] == -1) place(*current, geometry, slot, metrics);
+	}
+
+	// 平移时布局不断增长：代价变化后重新放入缓存，使总量上限对已放置的标注同样有效
+	if (cacheCost(*current) != oldCost) {
+		m_layouts.take(level);
+		if (!m_layouts.insert(level, current, cacheCost(*current))) return;
+	}
+
+	// 文字在设备坐标下绘制，加浅色描边便于在深色要素上阅读
+	const QTransform deviceTransform = painter->worldTransform();
+	const QPointF haloOffsets[] = { QPointF(-1, 0), QPointF(1, 0), QPointF(0, -1), QPointF(0, 1) };
+	painter->save();
+	painter->setWorldTransform(QTransform());
+	painter->setFont(m_font);
+	for (int slot : slots) {
+		const qint32 index = current->state[slot];
+		if (index < 0) continue;
+		const T_PlacedLabel& label = current->labels[index];
+		const QPointF baseline = deviceTransform.map(anchor(geometry, slot)) + label.box.topLeft()
+			+ QPointF(kPadding, kPadding + metrics.ascent());
+		painter->setPen(QColor(255, 255, 255, 220));
+		for (const QPointF& offset : haloOffsets) {
+			painter->drawText(baseline + offset, label.text);
+		}
+		painter->setPen(QColor(30, 30, 30));
+		painter->drawText(baseline, label.text);
+	}
+	painter->restore();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <QCache>
+#include <QFont>
+#include <QHash>
+#include <QRectF>
+#include <QVector>
+#include "ThematicStyle.h"
+
+class QPainter;
+class QFontMetricsF;
+class FlatGeometry;
+
+// 矢量标注：文字取自一个属性列，在设备坐标下绘制，字号不随缩放变化。
+// 标注框放入按像素划分的空间哈希网格，与已放置的标注重叠时舍弃。
+// 布局按缩放级别缓存：同一级别内平移只为新出现的要素计算位置，已放置的标注原样复用
+class LabelEngine {
+public:
+	LabelEngine();
+
+	void setColumn(const T_AttributeColumn& column);	//更换文字来源，清空全部布局
+	void setStyle(int fontSize, double maxResolution);
+	void clear();
+	bool isEmpty() const { return m_column.field.isEmpty(); }
+
+	// painter 为图层绘制时的场景变换；exposedRect 为需要重绘的场景范围，lod 为每单位场景坐标的像素数
+	void draw(QPainter* painter, const FlatGeometry& geometry, const QRectF& exposedRect, double lod);
+
+	int cachedLevels() const { return m_layouts.count(); }
+
+private:
+	// 一个已放置的标注
+	struct T_PlacedLabel {
+		int slot;
+		QRectF box;	//相对锚点
+		QRectF pixelBox;	//布局比例下的像素坐标，用于碰撞检测
+		QString text;	//过长时已截断
+	};
+
+	// 一个缩放级别的布局。state 按条目编号记录：-1 未计算，-2 不显示，>= 0 为标注序号
+	struct T_Layout {
+		double scale;	//布局使用的像素比例（级别内最小的比例，放大时标注只会更稀疏）
+		QVector<qint32> state;
+		QVector<T_PlacedLabel> labels;
+		QHash<quint64, QVector<int>> grid;	//网格单元 -> 覆盖它的标注序号
+		qint64 bytes = 0;	//估计的内存占用，随放置的标注增长
+	};
+
+	T_Layout* layout(int level, int featureCount);
+	static qsizetype cacheCost(const T_Layout& layout);
+	QString text(int slot) const;
+	QPointF anchor(const FlatGeometry& geometry, int slot) const;	//场景坐标
+	void place(T_Layout& layout, const FlatGeometry& geometry, int slot, const QFontMetricsF& metrics) const;
+	bool collides(const T_Layout& layout, const QRectF& pixelBox) const;
+
+	T_AttributeColumn m_column;
+	QFont m_font;
+	double d_maxResolution;
+	QCache<int, T_Layout> m_layouts;	//缩放级别 -> 布局，代价以 KB 计
+};
@@ -0,0 +1,417 @@
+#include "LayerMetadata.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+#include "DatasetPool.h"
+
+namespace {
+	const int kCacheVersion = 1;	//记录格式变化时递增，旧缓存自动失效
+
+	QMutex& registryMutex() {
+		static QMutex mutex;
+		return mutex;
+	}
+
+	QHash<QString, T_LayerMetadata>& registry() {
+		static QHash<QString, T_LayerMetadata> records;
+		return records;
+	}
+
+	// 旁路缓存文件名取路径的哈希，避免路径中的特殊字符
+	QString cacheFilePath(const QString& filePath) {
+		const QByteArray hash = QCryptographicHash::hash(
+			QFileInfo(filePath).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+		return QDir(LayerMetadata::cacheDirectory()).filePath(QString::fromLatin1(hash) + ".json");
+	}
+
+	// 记录与磁盘上的文件是否一致
+	bool matchesFile(const T_LayerMetadata& metadata, const QFileInfo& fileInfo) {
+		return metadata.fileSize >= 0 && fileInfo.exists() &&
+			fileInfo.size() == metadata.fileSize && fileInfo.lastModified() == metadata.modified;
+	}
+
+	QString crsNameOf(const OGRSpatialReference* srs) {
+		if (!srs) return QString();
+		const char* name = srs->IsProjected() ? srs->GetAttrValue("PROJCS") : srs->GetAttrValue("GEOGCS");
+		return name ? QString::fromUtf8(name) : QString();
+	}
+
+	QString crsWktOf(const OGRSpatialReference* srs) {
+		if (!srs) return QString();
+		char* wkt = nullptr;
+		srs->exportToWkt(&wkt);
+		const QString result = QString::fromUtf8(wkt ? wkt : "");
+		CPLFree(wkt);
+		return result;
+	}
+
+	void readRaster(GDALDataset* dataset, T_LayerMetadata& metadata) {
+		metadata.fileType = "Raster";
+		metadata.width = dataset->GetRasterXSize();
+		metadata.height = dataset->GetRasterYSize();
+
+		double geoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, -1.0 };
+		dataset->GetGeoTransform(geoTransform);
+		metadata.pixelSizeX = std::abs(geoTransform[1]);
+		metadata.pixelSizeY = std::abs(geoTransform[5]);
+
+		// 四个角点的外包矩形（兼容带旋转的仿射变换）
+		double minX = 0, minY = 0, maxX = 0, maxY = 0;
+		const int cornersX[4] = { 0, metadata.width, 0, metadata.width };
+		const int cornersY[4] = { 0, 0, metadata.height, metadata.height };
+		for (int i = 0; i < 4; ++i) {
+			const double x = geoTransform[0] + cornersX[i] * geoTransform[1] + cornersY[i] * geoTransform[2];
+			const double y = geoTransform[3] + cornersX[i] * geoTransform[4] + cornersY[i] * geoTransform[5];
+			if (i == 0 || x < minX) minX = x;
+			if (i == 0 || x > maxX) maxX = x;
+			if (i == 0 || y < minY) minY = y;
+			if (i == 0 || y > maxY) maxY = y;
+		}
+		metadata.extent = QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+
+		const char* projection = dataset->GetProjectionRef();
+		if (projection && projection[0]) {
+			OGRSpatialReference srs;
+			if (srs.importFromWkt(projection) == OGRERR_NONE) {
+				metadata.crsName = crsNameOf(&srs);
+			}
+			metadata.crsWkt = QString::fromUtf8(projection);
+		}
+
+		for (int i = 1; i <= dataset->GetRasterCount(); ++i) {
+			GDALRasterBand* band = dataset->GetRasterBand(i);
+			T_BandInfo info;
+			info.dataType = QString::fromUtf8(GDALGetDataTypeName(band->GetRasterDataType()));
+			info.overviewCount = band->GetOverviewCount();
+			int hasNoData = FALSE;
+			info.noData = band->GetNoDataValue(&hasNoData);
+			info.hasNoData = hasNoData;
+			info.hasStatistics = LayerMetadata::sampleStatistics(band, info);
+			metadata.bands.append(info);
+		}
+	}
+
+	void readVector(GDALDataset* dataset, T_LayerMetadata& metadata) {
+		metadata.fileType = "Vector";
+		metadata.layerCount = dataset->GetLayerCount();
+		OGRLayer* layer = dataset->GetLayer(0);
+		if (!layer) return;
+
+		metadata.layerName = QString::fromUtf8(layer->GetName());
+		metadata.featureCount = layer->GetFeatureCount(TRUE);
+
+		OGRwkbGeometryType geomType = wkbFlatten(layer->GetGeomType());
+		if (geomType == wkbUnknown) {
+			// 图层未声明几何类型时取第一个要素的类型
+			layer->ResetReading();
+			if (OGRFeature* feature = layer->GetNextFeature()) {
+				if (const OGRGeometry* geometry = feature->GetGeometryRef()) {
+					geomType = wkbFlatten(geometry->getGeometryType());
+				}
+				OGRFeature::DestroyFeature(feature);
+			}
+		}
+		metadata.wkbType = static_cast<int>(geomType);
+		metadata.geometryType = QString::fromUtf8(OGRGeometryTypeToName(geomType));
+
+		OGREnvelope envelope;
+		if (layer->GetExtent(&envelope, TRUE) == OGRERR_NONE) {
+			metadata.extent = QRectF(QPointF(envelope.MinX, envelope.MinY), QPointF(envelope.MaxX, envelope.MaxY));
+		}
+
+		const OGRSpatialReference* srs = layer->GetSpatialRef();
+		metadata.crsName = crsNameOf(srs);
+		metadata.crsWkt = crsWktOf(srs);
+
+		OGRFeatureDefn* definition = layer->GetLayerDefn();
+		for (int i = 0; i < definition->GetFieldCount(); ++i) {
+			metadata.fieldNames.append(QString::fromUtf8(definition->GetFieldDefn(i)->GetNameRef()));
+		}
+	}
+
+	T_LayerMetadata compute(const QString& filePath, const QFileInfo& fileInfo) {
+		T_LayerMetadata metadata;
+		metadata.filePath = filePath;
+		if (fileInfo.exists()) {
+			metadata.fileSize = fileInfo.size();
+			metadata.modified = fileInfo.lastModified();
+		}
+
+		DatasetHandle dataset = DatasetPool::instance().acquire(filePath);
+		if (!dataset) {
+			metadata.errorMessage = QString::fromUtf8(CPLGetLastErrorMsg());
+			return metadata;
+		}
+
+		if (dataset->GetRasterCount() > 0) {
+			readRaster(dataset.get(), metadata);
+		}
+		else if (dataset->GetLayerCount() > 0) {
+			readVector(dataset.get(), metadata);
+		}
+		else {
+			metadata.errorMessage = "文件中没有栅格波段或矢量图层";
+			return metadata;
+		}
+		metadata.isValid = true;
+		return metadata;
+	}
+
+	bool loadSidecar(const QString& filePath, const QFileInfo& fileInfo, T_LayerMetadata& metadata) {
+		if (!fileInfo.exists()) return false;
+		QFile file(cacheFilePath(filePath));
+		if (!file.open(QIODevice::ReadOnly)) return false;
+
+		const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+		if (json.value("version").toInt() != kCacheVersion) return false;
+
+		T_LayerMetadata record = T_LayerMetadata::fromJson(json);
+		if (!record.isValid || !matchesFile(record, fileInfo) ||
+			QFileInfo(record.filePath).absoluteFilePath() != fileInfo.absoluteFilePath()) return false;
+		record.filePath = filePath;
+		metadata = record;
+		return true;
+	}
+
+	void saveSidecar(const T_LayerMetadata& metadata) {
+		if (!metadata.isValid || metadata.fileSize < 0) return;	//非本地文件不写缓存
+		if (!QDir().mkpath(LayerMetadata::cacheDirectory())) return;
+
+		QJsonObject json = metadata.toJson();
+		json.insert("version", kCacheVersion);
+		QSaveFile file(cacheFilePath(metadata.filePath));
+		if (!file.open(QIODevice::WriteOnly)) return;
+		file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+		file.commit();
+	}
+}
+
+QString T_LayerMetadata::summary() const {
+	if (!isValid) return QString("无法读取：%1").arg(errorMessage);
+
+	QStringList lines;
+	lines << QString("路径: %1").arg(filePath);
+	lines << QString("坐标系: %1").arg(crsName.isEmpty() ? QString("无") : crsName);
+	lines << QString("范围: (%1, %2) - (%3, %4)")
+		.arg(extent.left(), 0, 'f', 3).arg(extent.top(), 0, 'f', 3)
+		.arg(extent.right(), 0, 'f', 3).arg(extent.bottom(), 0, 'f', 3);
+	if (fileType == "Vector") {
+		lines << QString("图层: %1（共 %2 个）").arg(layerName).arg(layerCount);
+		lines << QString("几何类型: %1").arg(geometryType);
+		lines << QString("要素数: %1").arg(featureCount);
+		lines << QString("字段: %1").arg(fieldNames.join(", "));
+	}
+	else {
+		lines << QString("尺寸: %1 x %2").arg(width).arg(height);
+		lines << QString("分辨率: %1 x %2").arg(pixelSizeX).arg(pixelSizeY);
+		lines << QString("波段数: %1").arg(bands.size());
+		for (int i = 0; i < bands.size(); ++i) {
+			const T_BandInfo& band = bands[i];
+			QString line = QString("波段 %1: %2，金字塔 %3 级").arg(i + 1).arg(band.dataType).arg(band.overviewCount);
+			if (band.hasNoData) line += QString("，NoData %1").arg(band.noData);
+			if (band.hasStatistics) {
+				line += QString("，范围 [%1, %2]，均值 %3，标准差 %4")
+					.arg(band.minimum).arg(band.maximum).arg(band.mean, 0, 'f', 3).arg(band.stdDev, 0, 'f', 3);
+			}
+			lines << line;
+		}
+	}
+	return lines.join('\n');
+}
+
+QJsonObject T_LayerMetadata::toJson() const {
+	QJsonObject json;
+	json.insert("filePath", filePath);
+	json.insert("fileType", fileType);
+	json.insert("isValid", isValid);
+	json.insert("fileSize", QString::number(fileSize));
+	json.insert("modified", QString::number(modified.toMSecsSinceEpoch()));
+	json.insert("extent", QJsonArray{ extent.left(), extent.top(), extent.width(), extent.height() });
+	json.insert("crsName", crsName);
+	json.insert("crsWkt", crsWkt);
+
+	json.insert("layerName", layerName);
+	json.insert("layerCount", layerCount);
+	json.insert("wkbType", wkbType);
+	json.insert("geometryType", geometryType);
+	json.insert("featureCount", QString::number(featureCount));
+	json.insert("fieldNames", QJsonArray::fromStringList(fieldNames));
+
+	json.insert("width", width);
+	json.insert("height", height);
+	json.insert("pixelSizeX", pixelSizeX);
+	json.insert("pixelSizeY", pixelSizeY);
+	QJsonArray bandArray;
+	for (const T_BandInfo& band : bands) {
+		QJsonObject bandJson;
+		bandJson.insert("dataType", band.dataType);
+		bandJson.insert("overviewCount", band.overviewCount);
+		bandJson.insert("hasNoData", band.hasNoData);
+		bandJson.insert("noData", band.noData);
+		bandJson.insert("hasStatistics", band.hasStatistics);
+		bandJson.insert("minimum", band.minimum);
+		bandJson.insert("maximum", band.maximum);
+		bandJson.insert("mean", band.mean);
+		bandJson.insert("stdDev", band.stdDev);
+		bandArray.append(bandJson);
+	}
+	json.insert("bands", bandArray);
+	return json;
+}
+
+T_LayerMetadata T_LayerMetadata::fromJson(const QJsonObject& json) {
+	T_LayerMetadata metadata;
+	metadata.filePath = json.value("filePath").toString();
+	metadata.fileType = json.value("fileType").toString();
+	metadata.isValid = json.value("isValid").toBool();
+	metadata.fileSize = json.value("fileSize").toString("-1").toLongLong();	//64 位整数按字符串保存
+	metadata.modified = QDateTime::fromMSecsSinceEpoch(json.value("modified").toString().toLongLong());
+	const QJsonArray extent = json.value("extent").toArray();
+	if (extent.size() == 4) {
+		metadata.extent = QRectF(extent[0].toDouble(), extent[1].toDouble(), extent[2].toDouble(), extent[3].toDouble());
+	}
+	metadata.crsName = json.value("crsName").toString();
+	metadata.crsWkt = json.value("crsWkt").toString();
+
+	metadata.layerName = json.value("layerName").toString();
+	metadata.layerCount = json.value("layerCount").toInt();
+	metadata.wkbType = json.value("wkbType").toInt();
+	metadata.geometryType = json.value("geometryType").toString();
+	metadata.featureCount = json.value("featureCount").toString("-1").toLongLong();
+	for (const QJsonValue& name : json.value("fieldNames").toArray()) {
+		metadata.fieldNames.append(name.toString());
+	}
+
+	metadata.width = json.value("width").toInt();
+	metadata.height = json.value("height").toInt();
+	metadata.pixelSizeX = json.value("pixelSizeX").toDouble();
+	metadata.pixelSizeY = json.value("pixelSizeY").toDouble();
+	for (const QJsonValue& value : json.value("bands").toArray()) {
+		const QJsonObject bandJson = value.toObject();
+		T_BandInfo band;
+		band.dataType = bandJson.value("dataType").toString();
+		band.overviewCount = bandJson.value("overviewCount").toInt();
+		band.hasNoData = bandJson.value("hasNoData").toBool();
+		band.noData = bandJson.value("noData").toDouble();
+		band.hasStatistics = bandJson.value("hasStatistics").toBool();
+		band.minimum = bandJson.value("minimum").toDouble();
+		band.maximum = bandJson.value("maximum").toDouble();
+		band.mean = bandJson.value("mean").toDouble();
+		band.stdDev = bandJson.value("stdDev").toDouble();
+		metadata.bands.append(band);
+	}
+	return metadata;
+}
+
+T_LayerMetadata LayerMetadata::scan(const QString& filePath) {
+	T_LayerMetadata metadata;
+	if (cached(filePath, metadata)) return metadata;
+
+	metadata = compute(filePath, QFileInfo(filePath));
+	if (metadata.isValid) {
+		saveSidecar(metadata);
+		QMutexLocker locker(&registryMutex());
+		registry().insert(filePath, metadata);
+	}
+	return metadata;
+}
+
+bool LayerMetadata::cached(const QString& filePath, T_LayerMetadata& metadata) {
+	const QFileInfo fileInfo(filePath);
+	{
+		QMutexLocker locker(&registryMutex());
+		auto it = registry().constFind(filePath);
+		if (it != registry().constEnd() && (it->fileSize < 0 || matchesFile(*it, fileInfo))) {
+			metadata = *it;
+			return true;
+		}
+	}
+
+	if (!loadSidecar(filePath, fileInfo, metadata)) return false;
+	QMutexLocker locker(&registryMutex());
+	registry().insert(filePath, metadata);
+	return true;
+}
+
+bool LayerMetadata::restore(const T_LayerMetadata& metadata) {
+	if (!metadata.isValid || metadata.filePath.isEmpty()) return false;
+	if (metadata.fileSize >= 0) {
+		if (!matchesFile(metadata, QFileInfo(metadata.filePath))) return false;
+		saveSidecar(metadata);
+	}
+	QMutexLocker locker(&registryMutex());
+	registry().insert(metadata.filePath, metadata);
+	return true;
+}
+
+void LayerMetadata::invalidate(const QString& filePath) {
+	{
+		QMutexLocker locker(&registryMutex());
+		registry().remove(filePath);
+	}
+	QFile::remove(cacheFilePath(filePath));
+}
+
+bool LayerMetadata::sampleStatistics(GDALRasterBand* band, T_BandInfo& info) {
+	const int kMaxSampleSize = 512;
+	if (!band) return false;
+
+	// 只取已有的统计值（force 为 FALSE），没有时不触发计算
+	CPLPushErrorHandler(CPLQuietErrorHandler);
+	const CPLErr existing = band->GetStatistics(TRUE, FALSE, &info.minimum, &info.maximum, &info.mean, &info.stdDev);
+	CPLPopErrorHandler();
+	if (existing == CE_None) return true;
+
+	const int width = band->GetXSize();
+	const int height = band->GetYSize();
+	if (width <= 0 || height <= 0) return false;
+	const double ratio = std::min(1.0, static_cast<double>(kMaxSampleSize) / std::max(width, height));
+	const int sampleWidth = std::max(1, static_cast<int>(width * ratio));
+	const int sampleHeight = std::max(1, static_cast<int>(height * ratio));
+
+	// 缓冲区小于读取范围时 GDAL 自动选用合适的金字塔
+	std::vector<double> samples(static_cast<size_t>(sampleWidth) * sampleHeight);
+	if (band->RasterIO(GF_Read, 0, 0, width, height, samples.data(), sampleWidth, sampleHeight,
+		GDT_Float64, 0, 0, nullptr) != CE_None) return false;
+
+	int hasNoData = FALSE;
+	const double noData = band->GetNoDataValue(&hasNoData);
+	double minimum = std::numeric_limits<double>::max();
+	double maximum = std::numeric_limits<double>::lowest();
+	double sum = 0.0;
+	double sumSquares = 0.0;
+	qint64 count = 0;
+	for (double value : samples) {
+		if (std::isnan(value) || (hasNoData && value == noData)) continue;
+		minimum = std::min(minimum, value);
+		maximum = std::max(maximum, value);
+		sum += value;
+		sumSquares += value * value;
+		++count;
+	}
+	if (count == 0) return false;
+
+	info.minimum = minimum;
+	info.maximum = maximum;
+	info.mean = sum / count;
+	info.stdDev = std::sqrt(std::max(0.0, sumSquares / count - info.mean * info.mean));
+	return true;
+}
+
+QString LayerMetadata::cacheDirectory() {
+	return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("layer-metadata");
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QRectF>
+#include <QVector>
+#include <QDateTime>
+#include <QMetaType>
+#include <QJsonObject>
+
+class GDALRasterBand;
+
+// 单个波段的信息
+struct T_BandInfo {
+	QString dataType;
+	int overviewCount = 0;
+	bool hasNoData = false;
+	double noData = 0.0;
+	bool hasStatistics = false;	//统计值为近似值（基于金字塔或抽样）
+	double minimum = 0.0;
+	double maximum = 0.0;
+	double mean = 0.0;
+	double stdDev = 0.0;
+};
+
+// 图层元数据：添加文件时在后台计算一次，之后由文件列表、属性窗口与地图共用
+struct T_LayerMetadata {
+	QString filePath;
+	QString fileType;	//"Raster" / "Vector"
+	bool isValid = false;
+	QString errorMessage;
+
+	qint64 fileSize = -1;	//用于核对旁路缓存
+	QDateTime modified;
+
+	QRectF extent;	//地图坐标（x 向东、y 向北）
+	QString crsName;
+	QString crsWkt;
+
+	// 矢量
+	QString layerName;
+	int layerCount = 0;
+	int wkbType = 0;	//OGRwkbGeometryType（已展平）
+	QString geometryType;
+	qint64 featureCount = -1;
+	QStringList fieldNames;
+
+	// 栅格
+	int width = 0;
+	int height = 0;
+	double pixelSizeX = 0.0;
+	double pixelSizeY = 0.0;
+	QVector<T_BandInfo> bands;
+
+	QString summary() const;	//多行文本，用于提示与属性窗口
+
+	QJsonObject toJson() const;
+	static T_LayerMetadata fromJson(const QJsonObject& json);
+};
+Q_DECLARE_METATYPE(T_LayerMetadata)
+
+namespace LayerMetadata {
+	// 获取元数据：依次查找内存、旁路缓存，都未命中时读取文件并写回缓存。可在任意线程调用
+	T_LayerMetadata scan(const QString& filePath);
+
+	// 只查找内存与旁路缓存，不读取文件
+	bool cached(const QString& filePath, T_LayerMetadata& metadata);
+
+	// 采用外部保存的记录（如工程文件）：与磁盘上的文件一致时放入内存与旁路缓存，返回是否采用
+	bool restore(const T_LayerMetadata& metadata);
+
+	// 文件内容已改变（如删除要素、覆盖输出）：丢弃内存与旁路缓存中的记录
+	void invalidate(const QString& filePath);
+
+	// 近似统计：优先用文件中已有的统计值，否则按不超过 512×512 的抽样（有金字塔时读金字塔）计算。
+	// 不调用 GDAL 的统计计算，避免在数据目录旁写出 .aux.xml（只读目录与远程数据上会失败）
+	bool sampleStatistics(GDALRasterBand* band, T_BandInfo& info);
+
+	QString cacheDirectory();	//旁路缓存目录
+}
@@ -0,0 +1,233 @@
+#include "MapCanvas.h"
+#include <QPainter>
+#include "RenderProfiler.h"
+#include <cmath>
+
+namespace {
+    const double kScaleStep = 1.15; // 每个滚轮刻度的缩放倍数
+    const double kMinScale = 0.1;
+    const double kMaxScale = 10.0;
+    const double kZoomEase = 0.35; // 每帧完成剩余缩放量的比例
+    const int kFrameInterval = 16; // 约 60 帧/秒
+    const int kSettleDelay = 150; // 停止交互多久后恢复精确绘制（毫秒）
+}
+
+MapCanvas::MapCanvas(QWidget* parent)
+    : QGraphicsView(parent), d_initialScale(1.0), d_currentScale(1.0), b_isPanning(false),
+    m_tool(PanTool), m_rubberBand(nullptr), b_isSelecting(false), b_isProfiling(false),
+    d_targetScale(1.0), b_isInteracting(false) {
+    // 缩放锚点由 advanceFrame 自行处理
+    setTransformationAnchor(QGraphicsView::NoAnchor);
+
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    m_frameTimer->setInterval(kFrameInterval);
+    connect(m_frameTimer, &QTimer::timeout, this, &MapCanvas::advanceFrame);
+
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(kSettleDelay);
+    connect(m_settleTimer, &QTimer::timeout, this, &MapCanvas::endInteraction);
+}
+
+void MapCanvas::setMapTool(MapTool tool) {
+    m_tool = tool;
+    setCursor(tool == PanTool ? Qt::ArrowCursor : Qt::CrossCursor);
+    if (!m_profileLine.isNull()) {
+        m_profileLine = QLineF();
+        viewport()->update();
+    }
+    if (tool != IdentifyTool) emit pointerLeft();
+}
+
+void MapCanvas::resetScale() {
+    m_frameTimer->stop();
+    m_pendingPan = QPoint();
+    d_currentScale = d_targetScale = 1.0;
+}
+
+void MapCanvas::wheelEvent(QWheelEvent* event) {
+    // 只累计目标比例，实际缩放在下一帧统一执行
+    const double steps = event->angleDelta().y() / 120.0;
+    if (steps == 0) return;
+
+    d_targetScale = qBound(kMinScale, d_targetScale * std::pow(kScaleStep, steps), kMaxScale);
+    m_zoomAnchor = event->position();
+    beginInteraction();
+    event->accept();
+}
+
+void MapCanvas::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        if (m_tool == SelectTool || m_tool == ClipTool) {
+            b_isSelecting = true; // 开始框选
+            m_selectOrigin = event->pos();
+            if (!m_rubberBand) m_rubberBand = new QRubberBand(QRubberBand::Rectangle, viewport());
+            m_rubberBand->setGeometry(QRect(m_selectOrigin, QSize()));
+            m_rubberBand->show();
+        }
+        else if (m_tool == ProfileTool) {
+            b_isProfiling = true; // 开始画剖面线
+            const QPointF scenePos = mapToScene(event->pos());
+            m_profileLine = QLineF(scenePos, scenePos);
+            viewport()->update();
+        }
+        else {
+            b_isPanning = true; // 开始平移
+            lastMousePos = event->pos(); // 记录鼠标位置
+            setCursor(Qt::ClosedHandCursor); // 设置鼠标样式为抓手
+        }
+    }
+    QGraphicsView::mousePressEvent(event); // 保留默认行为
+}
+
+void MapCanvas::mouseMoveEvent(QMouseEvent* event) {
+    if (b_isPanning) {
+        // 只累计偏移量，滚动条在下一帧统一更新
+        m_pendingPan += event->pos() - lastMousePos;
+        lastMousePos = event->pos(); // 更新鼠标位置
+        beginInteraction();
+    }
+    else if (b_isSelecting) {
+        m_rubberBand->setGeometry(QRect(m_selectOrigin, event->pos()).normalized());
+    }
+    else if (b_isProfiling) {
+        m_profileLine.setP2(mapToScene(event->pos()));
+        viewport()->update();
+    }
+    else if (m_tool == IdentifyTool) {
+        emit pointerMoved(mapToScene(event->pos()));
+    }
+    QGraphicsView::mouseMoveEvent(event); // 保留默认行为
+}
+
+void MapCanvas::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        if (b_isSelecting) {
+            b_isSelecting = false;
+            m_rubberBand->hide();
+
+            QRect viewRect = QRect(m_selectOrigin, event->pos()).normalized();
+            if (m_tool == ClipTool) {
+                // 裁剪范围须拖出一个矩形，误点不触发
+                if (viewRect.width() >= 3 && viewRect.height() >= 3) {
+                    emit clipRequested(mapToScene(viewRect).boundingRect());
+                }
+                QGraphicsView::mouseReleaseEvent(event);
+                return;
+            }
+
+            // 拖动距离很小时视为点选，按 3 像素容差换算为场景范围
+            if (viewRect.width() < 3 && viewRect.height() < 3) {
+                viewRect = QRect(event->pos() - QPoint(3, 3), QSize(7, 7));
+            }
+            QRectF sceneRect = mapToScene(viewRect).boundingRect();
+            emit selectionRequested(sceneRect, event->modifiers() & Qt::ShiftModifier);
+        }
+        else if (b_isProfiling) {
+            b_isProfiling = false;
+            m_profileLine.setP2(mapToScene(event->pos()));
+            // 误点不触发
+            const QPoint viewDelta = event->pos() - mapFromScene(m_profileLine.p1());
+            if (viewDelta.manhattanLength() >= 3) {
+                emit profileRequested(m_profileLine.p1(), m_profileLine.p2());
+            }
+            else {
+                m_profileLine = QLineF();
+            }
+            viewport()->update();
+        }
+        else if (b_isPanning) {
+            b_isPanning = false; // 停止平移
+            advanceFrame(); // 立即应用剩余的偏移量
+            setCursor(m_tool == PanTool ? Qt::ArrowCursor : Qt::CrossCursor); // 恢复鼠标样式
+        }
+    }
+    QGraphicsView::mouseReleaseEvent(event); // 保留默认行为
+}
+
+void MapCanvas::leaveEvent(QEvent* event) {
+    if (m_tool == IdentifyTool) emit pointerLeft();
+    QGraphicsView::leaveEvent(event);
+}
+
+void MapCanvas::drawForeground(QPainter* painter, const QRectF& rect) {
+    Q_UNUSED(rect);
+    if (m_profileLine.isNull()) return;
+    painter->save();
+    QPen pen(QColor(220, 30, 30), 2, Qt::SolidLine, Qt::RoundCap);
+    pen.setCosmetic(true); // 线宽不随缩放变化
+    painter->setPen(pen);
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->drawLine(m_profileLine);
+    painter->restore();
+}
+
+void MapCanvas::beginInteraction() {
+    if (!b_isInteracting) {
+        // 快照须在置位之前获取，否则 grab 会绘制出空白快照
+        m_snapshot = viewport()->grab();
+        m_snapshotTransform = viewportTransform();
+        b_isInteracting = true;
+    }
+    m_settleTimer->stop();
+    if (!m_frameTimer->isActive()) m_frameTimer->start();
+}
+
+void MapCanvas::advanceFrame() {
+    // 平移：一帧只更新一次滚动条
+    if (!m_pendingPan.isNull()) {
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() - m_pendingPan.x()); // 平移水平滚动条
+        verticalScrollBar()->setValue(verticalScrollBar()->value() - m_pendingPan.y()); // 平移垂直滚动条
+        m_pendingPan = QPoint();
+    }
+
+    // 缩放：按缓动比例逼近目标，保持锚点下的场景位置不变
+    const double remaining = d_targetScale / d_currentScale;
+    if (std::abs(std::log(remaining)) > 1e-3) {
+        const double step = std::abs(std::log(remaining)) < 0.01 ? remaining : std::pow(remaining, kZoomEase);
+        const QPointF anchorScene = mapToScene(m_zoomAnchor.toPoint());
+        scale(step, step);
+        d_currentScale *= step;
+
+        const QPointF drift = mapFromScene(anchorScene) - m_zoomAnchor;
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() + qRound(drift.x()));
+        verticalScrollBar()->setValue(verticalScrollBar()->value() + qRound(drift.y()));
+        emit zoomChanged(d_currentScale); // 每帧最多发射一次
+        return;
+    }
+    if (d_currentScale != d_targetScale) {
+        d_currentScale = d_targetScale;
+        emit zoomChanged(d_currentScale);
+    }
+
+    // 没有待处理的事件：停止帧定时器，稍后恢复精确绘制
+    if (!b_isPanning) {
+        m_frameTimer->stop();
+        m_settleTimer->start();
+    }
+}
+
+void MapCanvas::endInteraction() {
+    b_isInteracting = false;
+    m_snapshot = QPixmap();
+    viewport()->update();
+}
+
+void MapCanvas::paintEvent(QPaintEvent* event) {
+    RenderProfiler& profiler = RenderProfiler::instance();
+    const qint64 frameStart = profiler.isEnabled() ? profiler.now() : 0;
+
+    if (!b_isInteracting || m_snapshot.isNull()) {
+        QGraphicsView::paintEvent(event);
+        if (profiler.isEnabled()) profiler.recordFrame(frameStart, profiler.now() - frameStart);
+        return;
+    }
+
+    // 交互中只把上一帧快照按视图变换的增量绘制出来，不重绘场景
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), backgroundBrush().style() == Qt::NoBrush ? palette().base() : backgroundBrush());
+    painter.setTransform(m_snapshotTransform.inverted() * viewportTransform());
+    painter.drawPixmap(0, 0, m_snapshot);
+    if (profiler.isEnabled()) profiler.recordFrame(frameStart, profiler.now() - frameStart);
+}
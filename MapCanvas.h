@@ -1,74 +1,85 @@
-#pragma once  
-#include <QGraphicsView>  
-#include <QWheelEvent>  
-#include <QMouseEvent>  
-#include <QScrollBar> 
+#pragma once
+#include <QGraphicsView>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QScrollBar>
+#include <QRubberBand>
+#include <QPaintEvent>
+#include <QPixmap>
+#include <QTimer>
 
-class MapCanvas : public QGraphicsView {  
-   Q_OBJECT  
+class MapCanvas : public QGraphicsView {
+   Q_OBJECT
 
-public:  
-   explicit MapCanvas(QWidget* parent = nullptr)  
-       : QGraphicsView(parent), d_initialScale(1.0), d_currentScale(1.0), b_isPanning(false) {  
-   }  
+public:
+   // 地图交互工具
+   enum MapTool {
+       PanTool,	//平移（默认）
+       SelectTool,	//点选/框选要素
+       ClipTool,	//框选范围裁剪栅格
+       IdentifyTool,	//悬停查询栅格像元值
+       ProfileTool	//拖出一条线生成栅格剖面
+   };
+
+   explicit MapCanvas(QWidget* parent = nullptr);
+
+   void setMapTool(MapTool tool);
+   MapTool mapTool() const { return m_tool; }
+
+   void resetScale(); // 视图重新适配后将当前比例复位为 100%
 
 signals:
     void zoomChanged(qreal scale); // 缩放比例变化信号
+    void selectionRequested(const QRectF& sceneRect, bool additive); // 点选/框选的场景范围
+    void clipRequested(const QRectF& sceneRect); // 裁剪工具框选的场景范围
+    void pointerMoved(const QPointF& scenePos); // 查询工具下鼠标所在的场景坐标
+    void pointerLeft(); // 鼠标离开视图
+    void profileRequested(const QPointF& sceneStart, const QPointF& sceneEnd); // 剖面工具画出的线段
+
+protected:
+   // 鼠标滚轮缩放
+   void wheelEvent(QWheelEvent* event) override;
+
+   // 鼠标按下事件
+   void mousePressEvent(QMouseEvent* event) override;
+
+   // 鼠标移动事件
+   void mouseMoveEvent(QMouseEvent* event) override;
+
+   // 鼠标释放事件
+   void mouseReleaseEvent(QMouseEvent* event) override;
+
+   void leaveEvent(QEvent* event) override;
+
+   // 交互过程中绘制上一帧快照
+   void paintEvent(QPaintEvent* event) override;
+
+   // 剖面线
+   void drawForeground(QPainter* painter, const QRectF& rect) override;
+
+private:
+   void beginInteraction(); // 记录快照并开始逐帧合并
+   void advanceFrame(); // 每帧最多执行一次平移/缩放
+   void endInteraction(); // 交互停止后恢复精确绘制
+
+   qreal d_initialScale; // 初始比例
+   qreal d_currentScale; // 当前比例
+   bool b_isPanning; // 是否正在平移
+   QPoint lastMousePos; // 上一次鼠标位置
+
+   MapTool m_tool; // 当前工具
+   QRubberBand* m_rubberBand; // 框选橡皮筋
+   QPoint m_selectOrigin; // 框选起点
+   bool b_isSelecting; // 是否正在框选
+   QLineF m_profileLine; // 剖面线（场景坐标），画出后保留到切换工具
+   bool b_isProfiling; // 是否正在画剖面线
 
-protected:  
-   // 鼠标滚轮缩放  
-    void wheelEvent(QWheelEvent* event) override {
-        const double scaleFactor = 1.15;
-        const double minScale = 0.1;
-        const double maxScale = 10.0;
-
-        if (event->angleDelta().y() > 0 && d_currentScale < maxScale) {
-            // 放大视图
-            scale(scaleFactor, scaleFactor);
-            d_currentScale *= scaleFactor;
-            emit zoomChanged(d_currentScale); // 发射信号
-        }
-        else if (event->angleDelta().y() < 0 && d_currentScale > minScale) {
-            // 缩小视图
-            scale(1.0 / scaleFactor, 1.0 / scaleFactor);
-            d_currentScale /= scaleFactor;
-            emit zoomChanged(d_currentScale); // 发射信号
-        }
-    }
-
-   // 鼠标按下事件  
-   void mousePressEvent(QMouseEvent* event) override {  
-       if (event->button() == Qt::LeftButton) {  
-           b_isPanning = true; // 开始平移  
-           lastMousePos = event->pos(); // 记录鼠标位置  
-           setCursor(Qt::ClosedHandCursor); // 设置鼠标样式为抓手  
-       }  
-       QGraphicsView::mousePressEvent(event); // 保留默认行为  
-   }  
-
-   // 鼠标移动事件  
-   void mouseMoveEvent(QMouseEvent* event) override {  
-       if (b_isPanning) {  
-           QPoint delta = event->pos() - lastMousePos; // 计算鼠标移动的偏移量  
-           lastMousePos = event->pos(); // 更新鼠标位置  
-           horizontalScrollBar()->setValue(horizontalScrollBar()->value() - delta.x()); // 平移水平滚动条  
-           verticalScrollBar()->setValue(verticalScrollBar()->value() - delta.y()); // 平移垂直滚动条  
-       }  
-       QGraphicsView::mouseMoveEvent(event); // 保留默认行为  
-   }  
-
-   // 鼠标释放事件  
-   void mouseReleaseEvent(QMouseEvent* event) override {  
-       if (event->button() == Qt::LeftButton) {  
-           b_isPanning = false; // 停止平移  
-           setCursor(Qt::ArrowCursor); // 恢复鼠标样式  
-       }  
-       QGraphicsView::mouseReleaseEvent(event); // 保留默认行为  
-   }  
-
-private:  
-   qreal d_initialScale; // 初始比例  
-   qreal d_currentScale; // 当前比例  
-   bool b_isPanning; // 是否正在平移  
-   QPoint lastMousePos; // 上一次鼠标位置  
+   QTimer* m_frameTimer; // 帧定时器，合并同一帧内的滚轮与拖动事件
+   QTimer* m_settleTimer; // 交互停止后延时恢复精确绘制
+   qreal d_targetScale; // 缩放动画的目标比例
+   QPointF m_zoomAnchor; // 缩放锚点（视口坐标）
+   QPoint m_pendingPan; // 尚未应用的平移量
+   bool b_isInteracting; // 是否处于交互中（绘制快照）
+   QPixmap m_snapshot; // 交互开始时的视口快照
+   QTransform m_snapshotTransform; // 快照对应的场景到视口变换
 };
@@ -6,15 +6,46 @@
 #include <QFileInfo>
 #include <QVBoxLayout>
 #include <QFileDialog>
+#include <QDir>
+#include <QPixmapCache>
+#include <algorithm>
+#include <cmath>
 #include "MapWidget.h"
+#include "RasterLayerItem.h"
+#include "VectorLayerItem.h"
+#include "RenderProfiler.h"
+#include "DatasetPool.h"
+#include "LayerMetadata.h"
+#include "VsiSupport.h"
+#include "ProjectSession.h"
+#include "FlatGeometry.h"
+#include "ProfileWidget.h"
 
 MapWidget::MapWidget()
+    : m_nextZValue(0), m_selectionItem(nullptr), m_profileWidget(nullptr)
 {
     // 初始化 QGraphicsView 和 QGraphicsScene
     m_mapCanvas = new MapCanvas(this);
     m_scene = new QGraphicsScene(this);
+    m_scene->setItemIndexMethod(QGraphicsScene::NoIndex); // 每个图层只有一个图形项，无需 BSP 索引
     m_mapCanvas->setScene(m_scene);
     m_mapCanvas->setRenderHint(QPainter::Antialiasing);
+    m_mapCanvas->setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
+    m_mapCanvas->setOptimizationFlag(QGraphicsView::DontAdjustForAntialiasing, true);
+
+    // 矢量图层的设备坐标缓存存放在 QPixmapCache 中，默认 10MB 放不下多个视口大小的图层
+    QPixmapCache::setCacheLimit(256 * 1024);
+
+    // 选中要素的高亮覆盖层，始终位于最上层
+    m_selectionItem = new QGraphicsPathItem;
+    QPen selectionPen(QColor(0, 255, 255), 3);
+    selectionPen.setCosmetic(true);
+    selectionPen.setCapStyle(Qt::RoundCap);
+    m_selectionItem->setPen(selectionPen);
+    m_selectionItem->setBrush(QColor(0, 255, 255, 60));
+    m_selectionItem->setZValue(1e6);
+    m_selectionItem->setVisible(false);
+    m_scene->addItem(m_selectionItem);
 
     // 初始化 QLabel
     m_zoomLabel = new QLabel("缩放比例: 100%", this);
@@ -23,6 +54,30 @@ MapWidget::MapWidget()
         "padding: 2px;");
     m_zoomLabel->setAlignment(Qt::AlignLeft | Qt::AlignTop);
 
+    // 性能统计叠加层，默认隐藏，位于缩放比例标签下方
+    m_profilerLabel = new QLabel(this);
+    m_profilerLabel->setStyleSheet("background-color: rgba(255, 255, 255, 200);"
+        "border: 1px solid black;"
+        "padding: 2px;"
+        "font-family: monospace;");
+    m_profilerLabel->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    m_profilerLabel->move(0, m_zoomLabel->sizeHint().height() + 2);
+    m_profilerLabel->hide();
+
+    // 查询工具的像元值读数，位于左下角
+    m_pixelLabel = new QLabel(this);
+    m_pixelLabel->setStyleSheet("background-color: rgba(255, 255, 255, 200);"
+        "border: 1px solid black;"
+        "padding: 2px;");
+    m_pixelLabel->hide();
+
+    m_profilerTimer = new QTimer(this);
+    m_profilerTimer->setInterval(500);
+    connect(m_profilerTimer, &QTimer::timeout, this, [=] {
+        m_profilerLabel->setText(RenderProfiler::instance().summary());
+        m_profilerLabel->adjustSize();
+        });
+
 
     // 创建布局并将 mapCanvas 添加到布局中
     QVBoxLayout* layout = new QVBoxLayout(this);
@@ -44,265 +99,248 @@ MapWidget::MapWidget()
     //---------------------------------------------以下为信号槽连接------------------------------------------------//
 
     connect(m_mapCanvas, &MapCanvas::zoomChanged, this, &MapWidget::updateZoomLabel);
+    connect(m_mapCanvas, &MapCanvas::selectionRequested, this, &MapWidget::selectFeaturesInRect);
+    connect(m_mapCanvas, &MapCanvas::clipRequested, this, [this](const QRectF& sceneRect) {
+        emit clipExtentRequested(QRectF(QPointF(sceneRect.left(), -sceneRect.bottom()), QPointF(sceneRect.right(), -sceneRect.top())));
+        });
+    connect(m_mapCanvas, &MapCanvas::pointerMoved, this, &MapWidget::identifyPixel);
+    connect(m_mapCanvas, &MapCanvas::pointerLeft, m_pixelLabel, &QLabel::hide);
+    connect(m_mapCanvas, &MapCanvas::profileRequested, this, &MapWidget::showProfile);
 
 }
 
-QImage MapWidget::loadRaster(const QString& filePath)
-{
-    GDALDataset* dataset = (GDALDataset*)GDALOpen(filePath.toUtf8().constData(), GA_ReadOnly);
-    if (!dataset) qDebug()<<"GDAL打开失败："<<filePath;
-
-    int width = dataset->GetRasterXSize();
-    int height = dataset->GetRasterYSize();
-    int bandCount = dataset->GetRasterCount();
-    if (bandCount < 1) {
-        GDALClose(dataset);
-        qDebug() << "GDAL打开失败：" << filePath;
+QGraphicsItem* MapWidget::createLayerItem(const QString& filePath, const T_Information& info) {
+    // 判断文件类型：以扫描得到的元数据为准，压缩包内或远程文件的扩展名不可靠
+    T_LayerMetadata metadata;
+    const bool hasMetadata = LayerMetadata::cached(filePath, metadata);
+    const QString fileExtension = VsiSupport::layerSuffix(filePath);
+    const bool isRaster = hasMetadata ? metadata.fileType == "Raster"
+        : (fileExtension == "tif" || fileExtension == "tiff" || fileExtension == "vrt");
+    const bool isVector = hasMetadata ? metadata.fileType == "Vector" : fileExtension == "shp";
+    if (isRaster) {
+        // 只读取头信息，像素按可见瓦片异步加载
+        RasterLayerItem* rasterItem = new RasterLayerItem(filePath);
+        if (!m_projectCacheDir.isEmpty()) {
+            const QString tileDir = ProjectSession::tileDirectory(m_projectCacheDir, filePath);
+            if (ProjectSession::isTileCacheValid(tileDir, filePath)) rasterItem->setDiskCacheDirectory(tileDir);
+        }
+        if (!rasterItem->open()) {
+            delete rasterItem;
+            return nullptr;
+        }
+        rasterItem->setRenderMode(static_cast<RasterLayerItem::RenderMode>(info.renderMode)); // 重新加载后恢复渲染与合成方式
+        rasterItem->setOpacity(1.0 - info.transparency / 100.0);
+        rasterItem->setBlendMode(static_cast<RasterLayerItem::BlendMode>(info.blendMode));
+        return rasterItem;
     }
-
-    if (width <= 0 || height <= 0) {
-        QMessageBox::critical(this, "错误", "无效的图像尺寸: " + QString::number(width) + "x" + QString::number(height));
-        GDALClose(dataset);
-        qDebug() << "GDAL打开失败：" << filePath;
+    if (isVector) {
+        VectorLayerItem* vectorItem = new VectorLayerItem(filePath);
+        vectorItem->setColor(info.color);
+        if (!vectorItem->load()) {
+            delete vectorItem;
+            return nullptr;
+        }
+        vectorItem->setStyle(info.style); // 重新加载后恢复符号化与标注
+        vectorItem->setLabel(info.label);
+        return vectorItem;
     }
+    return nullptr;
+}
 
-    QImage image;
-    bool processedAsRGB = false;
-
-
-    if (!m_scene) {
-        m_scene = new QGraphicsScene(this);
-        m_mapCanvas->setScene(m_scene);
+void MapWidget::updateFilePathList(const QMap<QString, T_Information>& fileList) {
+    m_filePathList = fileList; // 更新文件路径和状态的映射
+    bool layerAdded = false;
+
+    // 移除已从列表中删除的图层
+    for (auto it = m_layerItems.begin(); it != m_layerItems.end();) {
+        if (!m_filePathList.contains(it.key())) {
+            if (m_pixelSampler && m_pixelSampler->filePath() == it.key()) m_pixelSampler.reset();
+            m_scene->removeItem(it.value());
+            delete it.value();
+            it = m_layerItems.erase(it);
+        }
+        else {
+            ++it;
+        }
     }
-    //显示前清除旧内容
-    //scene->clear();
-
-
-    // 处理RGB三波段
-    if (bandCount >= 3) {
-        GDALRasterBand* band1 = dataset->GetRasterBand(1);
-        GDALRasterBand* band2 = dataset->GetRasterBand(2);
-        GDALRasterBand* band3 = dataset->GetRasterBand(3);
-
-        GDALDataType type1 = band1->GetRasterDataType();
-        GDALDataType type2 = band2->GetRasterDataType();
-        GDALDataType type3 = band3->GetRasterDataType();
-
-        if (type1 == type2 && type1 == type3) {
-            if (type1 == GDT_Byte) { // 8位RGB处理
-                image = QImage(width, height, QImage::Format_RGB888);
-                std::vector<uchar> bufferR(width * height);
-                std::vector<uchar> bufferG(width * height);
-                std::vector<uchar> bufferB(width * height);
 
-                if (band1->RasterIO(GF_Read, 0, 0, width, height, bufferR.data(), width, height, GDT_Byte, 0, 0) == CE_None &&
-                    band2->RasterIO(GF_Read, 0, 0, width, height, bufferG.data(), width, height, GDT_Byte, 0, 0) == CE_None &&
-                    band3->RasterIO(GF_Read, 0, 0, width, height, bufferB.data(), width, height, GDT_Byte, 0, 0) == CE_None) {
+    // 新图层按需加载；已有图层只更新可见性与样式，其他图层的缓存不受影响
+    for (auto it = m_filePathList.begin(); it != m_filePathList.end(); ++it) {
+        const QString& filePath = it.key();
+        const T_Information& info = it.value();
 
-                    uchar* imgBits = image.bits();
-                    for (int i = 0; i < width * height; ++i) {
-                        imgBits[i * 3] = bufferR[i]; // Red
-                        imgBits[i * 3 + 1] = bufferG[i]; // Green
-                        imgBits[i * 3 + 2] = bufferB[i]; // Blue
-                    }
-                    processedAsRGB = true;
-                }
+        QGraphicsItem* item = m_layerItems.value(filePath);
+        if (!item) {
+            if (!info.isVisible) {
+                qDebug() << "File is hidden: " << filePath; // 隐藏的图层等到显示时再加载
+                continue;
             }
-            else if (type1 == GDT_UInt16) { // 16位RGB处理
-                image = QImage(width, height, QImage::Format_RGB888);
-                std::vector<uint16_t> bufferR(width * height);
-                std::vector<uint16_t> bufferG(width * height);
-                std::vector<uint16_t> bufferB(width * height);
-
-                if (band1->RasterIO(GF_Read, 0, 0, width, height, bufferR.data(), width, height, GDT_UInt16, 0, 0) == CE_None &&
-                    band2->RasterIO(GF_Read, 0, 0, width, height, bufferG.data(), width, height, GDT_UInt16, 0, 0) == CE_None &&
-                    band3->RasterIO(GF_Read, 0, 0, width, height, bufferB.data(), width, height, GDT_UInt16, 0, 0) == CE_None) {
-
-                    uchar* imgBits = image.bits();
-                    for (int i = 0; i < width * height; ++i) {
-                        imgBits[i * 3] = static_cast<uchar>(bufferR[i] / 256); // 高位转8位
-                        imgBits[i * 3 + 1] = static_cast<uchar>(bufferG[i] / 256);
-                        imgBits[i * 3 + 2] = static_cast<uchar>(bufferB[i] / 256);
-                    }
-                    processedAsRGB = true;
-                }
+            item = createLayerItem(filePath, info);
+            if (!item) {
+                qDebug() << "图层加载失败：" << filePath;
+                continue;
             }
+            item->setZValue(m_nextZValue++);
+            m_scene->addItem(item);
+            m_layerItems.insert(filePath, item);
+            layerAdded = true;
+            qDebug() << "图层已成功添加到场景：" << filePath;
         }
-    }
 
-    // 处理单波段灰度
-    if (!processedAsRGB) {
-        GDALRasterBand* band = dataset->GetRasterBand(1);
-        GDALDataType dataType = band->GetRasterDataType();
-
-        if (dataType == GDT_Byte) { // 8位灰度
-            image = QImage(width, height, QImage::Format_Grayscale8);
-            if (band->RasterIO(GF_Read, 0, 0, width, height, image.bits(), width, height, GDT_Byte, 0, 0) != CE_None) {
-                GDALClose(dataset);
-                qDebug() << "GDAL打开失败：" << filePath;
-            }
+        item->setVisible(info.isVisible);
+        if (VectorLayerItem* vectorItem = qgraphicsitem_cast<VectorLayerItem*>(item)) {
+            vectorItem->setColor(info.color);
+            const QString styleError = vectorItem->setStyle(info.style); // 字段值只在第一次使用时读取
+            if (!styleError.isEmpty()) qDebug() << "符号化失败：" << styleError;
+            const QString labelError = vectorItem->setLabel(info.label);
+            if (!labelError.isEmpty()) qDebug() << "标注失败：" << labelError;
         }
-        else if (dataType == GDT_UInt16) { // 16位灰度归一化
-            std::vector<uint16_t> buffer(width * height);
-            if (band->RasterIO(GF_Read, 0, 0, width, height, buffer.data(), width, height, GDT_UInt16, 0, 0) != CE_None) {
-                GDALClose(dataset);
-                qDebug() << "GDAL打开失败：" << filePath;
-            }
-            image = QImage(width, height, QImage::Format_Grayscale8);
-            for (int y = 0; y < height; ++y) {
-                for (int x = 0; x < width; ++x) {
-                    uint16_t value = buffer[y * width + x];
-                    image.setPixel(x, y, qRgb(value / 256, value / 256, value / 256));
-                }
-            }
+        else if (RasterLayerItem* rasterItem = qgraphicsitem_cast<RasterLayerItem*>(item)) {
+            rasterItem->setRenderMode(static_cast<RasterLayerItem::RenderMode>(info.renderMode));
+            rasterItem->setOpacity(1.0 - info.transparency / 100.0); // 合成时逐瓦片混合，瓦片缓存不变
+            rasterItem->setBlendMode(static_cast<RasterLayerItem::BlendMode>(info.blendMode));
         }
-        else {
-            GDALClose(dataset);
-            qDebug() << "GDAL打开失败：" << filePath;
+    }
+
+    // 只有新增图层时才重新适配视图，切换显示状态不改变视图范围；打开工程时恢复保存的范围
+    if (layerAdded) {
+        QRectF extent = m_pendingExtent;
+        m_pendingExtent = QRectF();
+        if (extent.isEmpty()) {
+            for (QGraphicsItem* item : m_layerItems) {
+                if (item->isVisible()) extent = extent.united(item->sceneBoundingRect());
+            }
         }
+        m_mapCanvas->fitInView(extent, Qt::KeepAspectRatio);
+        m_mapCanvas->resetScale();
+        updateZoomLabel(1.0); // 更新缩放标签为 100%
     }
-    if (image.isNull()) {
-        qDebug() << "图像加载失败：" << filePath;
+
+    // 保留仍然存在的图层上的选择
+    if (!m_layerItems.contains(m_selectedLayer)) {
+        m_selectedLayer.clear();
+        m_selectedIds.clear();
+    }
+    updateSelectionOverlay();
+}
+
+void MapWidget::reloadLayer(const QString& filePath) {
+    RasterLayerItem::dropCachedTiles(filePath); // 内存中的瓦片对应旧内容
+    if (m_pixelSampler && m_pixelSampler->filePath() == filePath) m_pixelSampler.reset();
+    GeometryCache::invalidate(filePath);
+    QGraphicsItem* oldItem = m_layerItems.value(filePath);
+    if (!oldItem) return;
+
+    // 数据变化时只重建这一个图层，保持原有叠放次序与可见性
+    QGraphicsItem* newItem = createLayerItem(filePath, m_filePathList.value(filePath));
+    m_scene->removeItem(oldItem);
+    m_layerItems.remove(filePath);
+    if (newItem) {
+        newItem->setZValue(oldItem->zValue());
+        newItem->setVisible(oldItem->isVisible());
+        m_scene->addItem(newItem);
+        m_layerItems.insert(filePath, newItem);
+    }
+    delete oldItem;
+    updateSelectionOverlay();
+}
+
+void MapWidget::setProfilerVisible(bool visible) {
+    RenderProfiler::instance().setEnabled(visible);
+    m_profilerLabel->setVisible(visible);
+    if (visible) {
+        m_profilerLabel->raise();
+        m_profilerTimer->start();
     }
     else {
-        qDebug() << "图像加载成功：" << filePath;
+        m_profilerTimer->stop();
     }
+}
 
-    return image;
+void MapWidget::setMapTool(MapCanvas::MapTool tool) {
+    m_mapCanvas->setMapTool(tool);
 }
 
+QRectF MapWidget::viewExtent() const {
+    // 场景 y 轴向下，为地图坐标取反
+    const QRectF sceneRect = m_mapCanvas->mapToScene(m_mapCanvas->viewport()->rect()).boundingRect();
+    return QRectF(QPointF(sceneRect.left(), -sceneRect.bottom()), QPointF(sceneRect.right(), -sceneRect.top()));
+}
 
-QGraphicsItem* MapWidget::createGraphicsItem(OGRGeometry* geom, const OGREnvelope& env,QColor color) {
-    QPainterPath path;
-    switch (wkbFlatten(geom->getGeometryType())) {
-    case wkbPoint: {
-        OGRPoint* p = static_cast<OGRPoint*>(geom);
-        QPointF pt = mapToView(p->getX(), p->getY(), env);
-        auto* item = new QGraphicsEllipseItem(pt.x() - 2, pt.y() - 2, 4, 4);
-        item->setBrush(color);
-        return item;
-    }
-    case wkbLineString: {
-        OGRLineString* line = static_cast<OGRLineString*>(geom);
-        for (int i = 0; i < line->getNumPoints(); ++i) {
-            QPointF pt = mapToView(line->getX(i), line->getY(i), env);
-            (i == 0) ? path.moveTo(pt) : path.lineTo(pt);
+void MapWidget::setViewExtent(const QRectF& extent) {
+    m_pendingExtent = extent.isEmpty() ? QRectF()
+        : QRectF(QPointF(extent.left(), -extent.bottom()), QPointF(extent.right(), -extent.top()));
+}
+
+void MapWidget::setProjectCacheDirectory(const QString& cacheDir) {
+    m_projectCacheDir = cacheDir;
+}
+
+int MapWidget::saveTileCache(const QString& cacheDir) const {
+    int saved = 0;
+    for (auto it = m_layerItems.constBegin(); it != m_layerItems.constEnd(); ++it) {
+        RasterLayerItem* rasterItem = qgraphicsitem_cast<RasterLayerItem*>(it.value());
+        if (!rasterItem) continue;
+        const QString tileDir = ProjectSession::tileDirectory(cacheDir, it.key());
+        // 源文件未变化时保留已有瓦片，只补写内存中新增的；变化后整个子目录作废
+        const bool valid = ProjectSession::isTileCacheValid(tileDir, it.key());
+        if (!valid) QDir(tileDir).removeRecursively();
+        const int written = rasterItem->saveCachedTiles(tileDir);
+        if ((valid || written > 0) && ProjectSession::writeTileStamp(tileDir, it.key())) ++saved;
+    }
+    return saved;
+}
+
+void MapWidget::selectFeaturesInRect(const QRectF& sceneRect, bool additive) {
+    // 按叠放次序从上到下查找，选中最上层有命中的矢量图层
+    QString hitLayer;
+    QList<qint64> hitIds;
+    const QList<QGraphicsItem*> items = m_scene->items(sceneRect, Qt::IntersectsItemBoundingRect, Qt::DescendingOrder);
+    for (QGraphicsItem* item : items) {
+        VectorLayerItem* vectorItem = qgraphicsitem_cast<VectorLayerItem*>(item);
+        if (!vectorItem || !vectorItem->isVisible()) continue;
+
+        hitIds = vectorItem->featuresIn(sceneRect);
+        if (!hitIds.isEmpty()) {
+            hitLayer = vectorItem->filePath();
+            break;
         }
-        auto* item = new QGraphicsPathItem(path);
-        item->setPen(QPen(color, 1));
-        return item;
-    }
-    case wkbPolygon: {
-        OGRPolygon* poly = static_cast<OGRPolygon*>(geom);
-        OGRLinearRing* ring = poly->getExteriorRing();
-        QPolygonF qpoly;
-        for (int i = 0; i < ring->getNumPoints(); ++i) {
-            qpoly << mapToView(ring->getX(i), ring->getY(i), env);
+    }
+
+    if (additive && !hitLayer.isEmpty() && hitLayer == m_selectedLayer) {
+        for (qint64 id : m_selectedIds) {
+            if (!hitIds.contains(id)) hitIds.append(id);
         }
-        auto* item = new QGraphicsPolygonItem(qpoly);
-        item->setBrush(QColor(0, 255, 0, 50));
-        item->setPen(QPen(color, 1));
-        return item;
     }
-    default:
-        return nullptr;
+    else if (additive && hitLayer.isEmpty()) {
+        return; // 追加模式下点到空白处不改变已有选择
     }
-}
 
-QPointF MapWidget::mapToView(double x, double y, const OGREnvelope& env) {
-    double xRatio = (x - env.MinX) / (env.MaxX - env.MinX);
-    double yRatio = 1.0 - (y - env.MinY) / (env.MaxY - env.MinY); // Y轴翻转
-    return QPointF(
-        xRatio * m_mapCanvas->viewport()->width(),
-        yRatio * m_mapCanvas->viewport()->height()
-    );
+    m_selectedLayer = hitLayer;
+    m_selectedIds = hitIds;
+    updateSelectionOverlay();
+
+    qDebug() << "选中要素：" << hitLayer << hitIds.size();
+    emit featuresSelected(hitLayer, hitIds);
 }
 
+void MapWidget::highlightFeatures(const QString& filePath, const QList<qint64>& featureIds) {
+    m_selectedLayer = filePath;
+    m_selectedIds = featureIds;
+    updateSelectionOverlay();
+}
 
-void MapWidget::updateFilePathList(const QMap<QString, T_Information>& fileList) {
-    m_filePathList = fileList; // 更新文件路径和状态的映射
-    m_scene->clear();
-    // 遍历 QMap，检查所有路径的状态
-    for (auto it = m_filePathList.begin(); it != m_filePathList.end(); ++it) {
-        const QString& filePath = it.key();
-        bool status = it.value().isVisible;
-
-        // 判断文件类型
-        QFileInfo fileInfo(filePath);
-        QString fileExtension = fileInfo.suffix().toLower();
-        if (fileExtension == "tif" || fileExtension == "tiff") {
-            if (status) {
-                // 如果状态为 true，加载图像并显示
-                qDebug() << "File is visible: " << filePath;
-
-                QPixmap pixmap = QPixmap::fromImage(loadRaster(filePath));
-
-                //检查图像是否被添加到场景
-                if (pixmap.isNull()) {
-                    qDebug() << "从图像生成 Pixmap 失败：" << filePath;
-                }
-                else {
-                    QGraphicsPixmapItem* pixmapItem = m_scene->addPixmap(pixmap);
-                    if (!pixmapItem) {
-                        qDebug() << "图像未成功添加到场景：" << filePath;
-                    }
-                    else {
-                        pixmapItem->setData(0, filePath);
-                        qDebug() << "图像已成功添加到场景：" << filePath;
-                    }
-                }
-
-                QGraphicsPixmapItem* pixmapItem = m_scene->addPixmap(pixmap);
-                pixmapItem->setData(0, filePath); // 将文件路径存储为图像项的用户数据
-                m_mapCanvas->fitInView(m_scene->itemsBoundingRect(), Qt::KeepAspectRatio);
-            }
-            else {
-                // 如果状态为 false
-                qDebug() << "File is hidden: " << filePath;
-            }
-        }
-        else if (fileExtension == "shp") {
-            if (status) {
-                GDALDataset* poDS = (GDALDataset*)GDALOpenEx(
-                    filePath.toUtf8(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr);
-                if (!poDS) {
-                    qDebug() << "打开SHP文件失败";
-                    return;
-                }
-
-                OGRLayer* poLayer = poDS->GetLayer(0);
-                if (!poLayer) {
-                    GDALClose(poDS);
-                    return;
-                }
-
-                // 获取全局坐标范围
-                poLayer->GetExtent(&envTotal);
-
-                // 遍历要素
-                OGRFeature* poFeature;
-                while ((poFeature = poLayer->GetNextFeature()) != nullptr) {
-                    OGRGeometry* poGeometry = poFeature->GetGeometryRef();
-                    if (!poGeometry) continue;
-
-                    QGraphicsItem* item = createGraphicsItem(poGeometry, envTotal, it.value().color);
-                    if (item) m_scene->addItem(item);
-
-                    OGRFeature::DestroyFeature(poFeature);
-                }
-
-                GDALClose(poDS);
-                m_mapCanvas->fitInView(m_scene->itemsBoundingRect(), Qt::KeepAspectRatio);  // 自动缩放
-            }
-            else {
-                // 如果状态为 false
-                qDebug() << "File is hidden: " << filePath;
-            }
+void MapWidget::updateSelectionOverlay() {
+    // 所有选中要素合并为一个路径项，避免为每个要素再创建图形项
+    QPainterPath path;
+    VectorLayerItem* vectorItem = qgraphicsitem_cast<VectorLayerItem*>(m_layerItems.value(m_selectedLayer));
+    if (vectorItem) {
+        for (qint64 id : m_selectedIds) {
+            path.addPath(vectorItem->featurePath(id));
         }
     }
-    // 重置缩放因子为 100%
-    m_mapCanvas->fitInView(m_scene->itemsBoundingRect(), Qt::KeepAspectRatio);
-    updateZoomLabel(1.0); // 更新缩放标签为 100%
+    m_selectionItem->setPath(path);
+    m_selectionItem->setVisible(vectorItem && vectorItem->isVisible() && !path.isEmpty());
 }
 
 void MapWidget::updateZoomLabel(qreal scale) {
@@ -342,11 +380,8 @@ void MapWidget::bufferVector(const QString& inputPath, double radius) {
 
 // 生成缓冲区函数
 bool MapWidget::createBuffer(const QString& inputPath, const QString& outputPath, double bufferRadius) {
-    // 初始化GDAL
-    GDALAllRegister();
-
     // 打开输入矢量文件
-    GDALDataset* poInputDS = (GDALDataset*)GDALOpenEx(inputPath.toUtf8().constData(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr);
+    DatasetHandle poInputDS = DatasetPool::instance().acquire(inputPath);
     if (!poInputDS) {
         QMessageBox::critical(nullptr, "Error", "无法打开输入文件！");
         return false;
@@ -356,7 +391,6 @@ bool MapWidget::createBuffer(const QString& inputPath, const QString& outputPath
     OGRLayer* poInputLayer = poInputDS->GetLayer(0);
     if (!poInputLayer) {
         QMessageBox::critical(nullptr, "Error", "无法读取输入图层！");
-        GDALClose(poInputDS);
         return false;
     }
 
@@ -365,14 +399,13 @@ bool MapWidget::createBuffer(const QString& inputPath, const QString& outputPath
     GDALDriver* poDriver = GetGDALDriverManager()->GetDriverByName(pszDriverName);
     if (!poDriver) {
         QMessageBox::critical(nullptr, "Error", "驱动不可用！");
-        GDALClose(poInputDS);
         return false;
     }
 
+    DatasetPool::instance().prepareOutput(outputPath, poDriver);
     GDALDataset* poOutputDS = poDriver->Create(outputPath.toUtf8().constData(), 0, 0, 0, GDT_Unknown, nullptr);
     if (!poOutputDS) {
         QMessageBox::critical(nullptr, "Error", "无法创建输出文件！");
-        GDALClose(poInputDS);
         return false;
     }
 
@@ -381,7 +414,6 @@ bool MapWidget::createBuffer(const QString& inputPath, const QString& outputPath
     OGRLayer* poOutputLayer = poOutputDS->CreateLayer("buffer", poSRS, wkbPolygon, nullptr);
     if (!poOutputLayer) {
         QMessageBox::critical(nullptr, "Error", "无法创建输出图层！");
-        GDALClose(poInputDS);
         GDALClose(poOutputDS);
         return false;
     }
@@ -433,8 +465,79 @@ bool MapWidget::createBuffer(const QString& inputPath, const QString& outputPath
     }
 
     // 关闭数据集
-    GDALClose(poInputDS);
     GDALClose(poOutputDS);
 
     return true;
-}
\ No newline at end of file
+}
+RasterLayerItem* MapWidget::rasterItemAt(const QPointF& scenePos) const {
+    for (QGraphicsItem* item : m_scene->items(scenePos, Qt::IntersectsItemBoundingRect, Qt::DescendingOrder)) {
+        RasterLayerItem* rasterItem = qgraphicsitem_cast<RasterLayerItem*>(item);
+        if (rasterItem && rasterItem->isVisible()) return rasterItem;
+    }
+    return nullptr;
+}
+
+PixelSampler* MapWidget::samplerFor(const QString& filePath) {
+    if (!m_pixelSampler || m_pixelSampler->filePath() != filePath) {
+        m_pixelSampler = std::make_unique<PixelSampler>(filePath);
+        if (!m_pixelSampler->open()) {
+            m_pixelSampler.reset();
+            return nullptr;
+        }
+    }
+    return m_pixelSampler.get();
+}
+
+void MapWidget::identifyPixel(const QPointF& scenePos) {
+    // 悬停时只查块缓存，未命中才读一个块
+    RasterLayerItem* rasterItem = rasterItemAt(scenePos);
+    PixelSampler* sampler = rasterItem ? samplerFor(rasterItem->filePath()) : nullptr;
+    if (!sampler) {
+        m_pixelLabel->hide();
+        return;
+    }
+    const QPointF pixel = rasterItem->sceneToPixel(scenePos);
+    const int column = static_cast<int>(std::floor(pixel.x()));
+    const int row = static_cast<int>(std::floor(pixel.y()));
+    const QVector<double> values = sampler->sample(column, row);
+    if (values.isEmpty()) {
+        m_pixelLabel->hide();
+        return;
+    }
+
+    QStringList parts{ QString("%1  列 %2 行 %3").arg(QFileInfo(rasterItem->filePath()).fileName()).arg(column).arg(row) };
+    for (int band = 0; band < values.size(); ++band) {
+        parts.append(QString("B%1: %2").arg(band + 1)
+            .arg(std::isnan(values[band]) ? QString("NoData") : QString::number(values[band], 'g', 8)));
+    }
+    m_pixelLabel->setText(parts.join("  "));
+    m_pixelLabel->adjustSize();
+    m_pixelLabel->move(0, height() - m_pixelLabel->height());
+    m_pixelLabel->show();
+    m_pixelLabel->raise();
+}
+
+void MapWidget::showProfile(const QPointF& sceneStart, const QPointF& sceneEnd) {
+    RasterLayerItem* rasterItem = rasterItemAt(sceneStart);
+    if (!rasterItem) rasterItem = rasterItemAt(sceneEnd);
+    PixelSampler* sampler = rasterItem ? samplerFor(rasterItem->filePath()) : nullptr;
+    if (!sampler) {
+        QMessageBox::information(this, "剖面", "剖面线的端点不在可见的栅格图层上");
+        return;
+    }
+
+    // 每个波段一条剖面，只读取沿线经过的块
+    const QPointF startPixel = rasterItem->sceneToPixel(sceneStart);
+    const QPointF endPixel = rasterItem->sceneToPixel(sceneEnd);
+    QStringList bandNames;
+    QVector<QVector<QPointF>> series;
+    for (int band = 0; band < std::min(sampler->bandCount(), 4); ++band) {
+        bandNames.append(QString("B%1").arg(band + 1));
+        series.append(sampler->profile(startPixel, endPixel, band));
+    }
+
+    if (!m_profileWidget) m_profileWidget = new ProfileWidget(this);
+    m_profileWidget->setProfile(QString("剖面 - %1").arg(QFileInfo(rasterItem->filePath()).fileName()), bandNames, series);
+    m_profileWidget->show();
+    m_profileWidget->raise();
+}
@@ -1,5 +1,5 @@
 #pragma once
-#include <Qmainwindow>
+#include <QMainWindow>
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <QImage>
@@ -8,10 +8,15 @@
 #include <QMap>
 #include <QPixmap>
 #include <QGraphicsPixmapItem>
+#include <QTimer>
+#include <memory>
 #include "ogrsf_frmts.h"
 #include "MapCanvas.h"
+#include "PixelSampler.h"
 #include "Public.h"
 
+class RasterLayerItem;
+class ProfileWidget;
 
 class MapWidget:public QGraphicsView {
 	Q_OBJECT
@@ -23,25 +28,62 @@ public:
 
 	bool createBuffer(const QString& inputPath, const QString& outputPath, double bufferRadius);
 
+	void setMapTool(MapCanvas::MapTool tool);
+
+	QRectF viewExtent() const; // 当前视口对应的地图范围（y 向北）
+	void setViewExtent(const QRectF& extent); // 下次加入图层时按此范围显示，而不是适配全部图层
+
+	void setProjectCacheDirectory(const QString& cacheDir); // 工程渲染缓存目录，新建的栅格图层优先从中读取瓦片
+	int saveTileCache(const QString& cacheDir) const; // 把各栅格图层已解码的瓦片写入工程缓存
+
 public slots:
 
 	void updateFilePathList(const QMap<QString, T_Information>& fileList);
 
 	void updateZoomLabel(qreal scale); // 更新缩放比例标签
 
+	void selectFeaturesInRect(const QRectF& sceneRect, bool additive); // 点选/框选要素
+
+	void highlightFeatures(const QString& filePath, const QList<qint64>& featureIds); // 高亮指定要素（不回发信号）
+
+	void reloadLayer(const QString& filePath); // 图层数据变化后只重建该图层
+
+	void setProfilerVisible(bool visible); // 显示/隐藏性能统计叠加层
+
+	void identifyPixel(const QPointF& scenePos); // 显示鼠标下最上层栅格的像元值
+
+	void showProfile(const QPointF& sceneStart, const QPointF& sceneEnd); // 沿线段对最上层栅格取值并显示剖面图
+
 signals:
 	void bufferCompleted(const QString& filePath);
 
-private:
-	QImage loadRaster(const QString& filePath);
+	void featuresSelected(const QString& filePath, const QList<qint64>& featureIds); // 地图上选中的要素
 
-	QGraphicsItem* createGraphicsItem(OGRGeometry* geom, const OGREnvelope& env,QColor color);
-	QPointF mapToView(double x, double y, const OGREnvelope& env);
+	void clipExtentRequested(const QRectF& extent); // 裁剪工具框选的地图范围（y 向北）
+
+private:
+	QGraphicsItem* createLayerItem(const QString& filePath, const T_Information& info);
+	void updateSelectionOverlay();
+	RasterLayerItem* rasterItemAt(const QPointF& scenePos) const; // 该处最上层的可见栅格图层
+	PixelSampler* samplerFor(const QString& filePath); // 同一图层连续取值时复用块缓存
 
 	MapCanvas* m_mapCanvas;
 	QGraphicsScene* m_scene;       // 图形场景对象
 	QLabel* m_zoomLabel; // 用于显示缩放比例的标签
-	OGREnvelope envTotal;
+	QLabel* m_profilerLabel; // 性能统计叠加层
+	QTimer* m_profilerTimer; // 定时刷新性能统计
 	QMap<QString, T_Information> m_filePathList; // 文件路径对应状态
+	QMap<QString, QGraphicsItem*> m_layerItems; // 文件路径对应的图层图形项
+	int m_nextZValue; // 新图层的叠放次序
+	QRectF m_pendingExtent; // 打开工程后待恢复的视图范围（场景坐标）
+	QString m_projectCacheDir; // 工程渲染缓存目录
+
+	QGraphicsPathItem* m_selectionItem; // 选中要素的高亮覆盖层
+	QString m_selectedLayer; // 选中要素所在图层
+	QList<qint64> m_selectedIds; // 选中要素的 FID
+
+	QLabel* m_pixelLabel; // 查询工具的像元值读数
+	std::unique_ptr<PixelSampler> m_pixelSampler; // 最近查询的栅格图层的取值器
+	ProfileWidget* m_profileWidget; // 剖面图窗口
 
 };
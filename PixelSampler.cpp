@@ -0,0 +1,104 @@
+#include "PixelSampler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <gdal_priv.h>
+#include "DatasetPool.h"
+
+namespace {
+	const int kMaxBlockSide = 512;	//自然块（如整行条带）过大时的切分边长
+	const double kNaN = std::numeric_limits<double>::quiet_NaN();
+}
+
+PixelSampler::PixelSampler(const QString& filePath, int cacheKilobytes)
+	: m_filePath(filePath), m_width(0), m_height(0), m_blockWidth(kMaxBlockSide), m_blockHeight(kMaxBlockSide),
+	m_blocks(cacheKilobytes) {
+	for (double& v : m_geoTransform) v = 0.0;
+}
+
+bool PixelSampler::open() {
+	DatasetHandle dataset = DatasetPool::instance().acquire(m_filePath);
+	if (!dataset || dataset->GetRasterCount() < 1) return false;
+
+	m_width = dataset->GetRasterXSize();
+	m_height = dataset->GetRasterYSize();
+	if (dataset->GetGeoTransform(m_geoTransform) != CE_None) {
+		const double identity[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, -1.0 };
+		std::copy(identity, identity + 6, m_geoTransform);
+	}
+
+	int blockWidth = 0;
+	int blockHeight = 0;
+	dataset->GetRasterBand(1)->GetBlockSize(&blockWidth, &blockHeight);
+	m_blockWidth = std::max(1, std::min(blockWidth, kMaxBlockSide));
+	m_blockHeight = std::max(1, std::min(blockHeight, kMaxBlockSide));
+
+	m_noData.resize(dataset->GetRasterCount());
+	for (int band = 0; band < m_noData.size(); ++band) {
+		int hasNoData = FALSE;
+		const double noData = dataset->GetRasterBand(band + 1)->GetNoDataValue(&hasNoData);
+		m_noData[band] = hasNoData ? noData : kNaN;
+	}
+	m_blocks.clear();
+	return true;
+}
+
+const PixelSampler::T_Block* PixelSampler::block(int band, int blockX, int blockY) {
+	const quint64 key = (static_cast<quint64>(band) << 48) | (static_cast<quint64>(blockY) << 24) | static_cast<quint64>(blockX);
+	if (const T_Block* cached = m_blocks.object(key)) return cached;
+
+	// 未命中时才访问文件，整块读入并换算为 double
+	const int x = blockX * m_blockWidth;
+	const int y = blockY * m_blockHeight;
+	const int width = std::min(m_blockWidth, m_width - x);
+	const int height = std::min(m_blockHeight, m_height - y);
+	T_Block* entry = new T_Block;
+	entry->width = width;
+	entry->values.resize(static_cast<qsizetype>(width) * height);
+	if (DatasetHandle dataset = DatasetPool::instance().acquire(m_filePath)) {
+		entry->valid = dataset->GetRasterBand(band + 1)->RasterIO(GF_Read, x, y, width, height,
+			entry->values.data(), width, height, GDT_Float64, 0, 0, nullptr) == CE_None;
+	}
+	const qsizetype cost = std::max<qsizetype>(1, entry->values.size() * static_cast<qsizetype>(sizeof(double)) / 1024);
+	const T_Block* inserted = entry;
+	return m_blocks.insert(key, entry, cost) ? inserted : nullptr;
+}
+
+double PixelSampler::sample(int column, int row, int band) {
+	if (column < 0 || row < 0 || column >= m_width || row >= m_height || band < 0 || band >= m_noData.size()) return kNaN;
+	const T_Block* data = block(band, column / m_blockWidth, row / m_blockHeight);
+	if (!data || !data->valid) return kNaN;
+	const double value = data->values[static_cast<qsizetype>(row % m_blockHeight) * data->width + column % m_blockWidth];
+	return value == m_noData[band] ? kNaN : value;
+}
+
+QVector<double> PixelSampler::sample(int column, int row) {
+	QVector<double> values;
+	if (column < 0 || row < 0 || column >= m_width || row >= m_height) return values;
+	values.reserve(m_noData.size());
+	for (int band = 0; band < m_noData.size(); ++band) {
+		values.append(sample(column, row, band));
+	}
+	return values;
+}
+
+QVector<QPointF> PixelSampler::profile(const QPointF& startPixel, const QPointF& endPixel, int band, int maxSamples) {
+	QVector<QPointF> points;
+	const QPointF delta = endPixel - startPixel;
+	const double pixelLength = std::max(std::abs(delta.x()), std::abs(delta.y()));
+	const int count = std::max(2, std::min(maxSamples, static_cast<int>(std::ceil(pixelLength)) + 1));
+
+	// 像元坐标的增量换算为地面距离
+	const double dx = delta.x() * m_geoTransform[1] + delta.y() * m_geoTransform[2];
+	const double dy = delta.x() * m_geoTransform[4] + delta.y() * m_geoTransform[5];
+	const double length = std::sqrt(dx * dx + dy * dy);
+
+	points.reserve(count);
+	for (int i = 0; i < count; ++i) {
+		const double t = static_cast<double>(i) / (count - 1);
+		const QPointF pixel = startPixel + delta * t;
+		const double value = sample(static_cast<int>(std::floor(pixel.x())), static_cast<int>(std::floor(pixel.y())), band);
+		points.append(QPointF(length * t, value));
+	}
+	return points;
+}
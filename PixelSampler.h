@@ -0,0 +1,49 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QPointF>
+#include <QCache>
+
+// 栅格像元取值：以 GDAL 自然块（过大时按 512 像元切分）为单位读取，最近使用的块保留在 LRU 缓存中。
+// 鼠标悬停时连续取值基本都落在已缓存的块内，不访问文件；剖面线只读取沿线经过的块。
+// 只在界面线程使用；文件内容变化后须重新创建
+class PixelSampler {
+public:
+	explicit PixelSampler(const QString& filePath, int cacheKilobytes = 16 * 1024);
+
+	bool open();	//读取尺寸、波段、块大小与 NoData，不读像素
+
+	QString filePath() const { return m_filePath; }
+	int bandCount() const { return m_noData.size(); }
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+
+	// 像元 (column, row) 各波段的值，NoData 为 NaN；像元在栅格外时返回空
+	QVector<double> sample(int column, int row);
+	double sample(int column, int row, int band);	//单个波段，栅格外或 NoData 为 NaN
+
+	// 两点（像元坐标）连线上按约一个像元的间隔取值；x 为到起点的地面距离（地图单位），y 为值，
+	// 栅格外与 NoData 处为 NaN。采样点过多时放大间隔，最多 maxSamples 个
+	QVector<QPointF> profile(const QPointF& startPixel, const QPointF& endPixel, int band, int maxSamples = 8192);
+
+	int cachedBlocks() const { return m_blocks.count(); }
+
+private:
+	// 缓存中的一块
+	struct T_Block {
+		QVector<double> values;
+		int width = 0;
+		bool valid = false;	//读取失败时为 false，同样缓存以免反复重试
+	};
+
+	const T_Block* block(int band, int blockX, int blockY);
+
+	QString m_filePath;
+	int m_width;
+	int m_height;
+	int m_blockWidth;
+	int m_blockHeight;
+	double m_geoTransform[6];
+	QVector<double> m_noData;	//各波段 NoData，没有时为 NaN
+	QCache<quint64, T_Block> m_blocks;	//成本单位为 KB
+};
@@ -0,0 +1,150 @@
+#include "ProfileWidget.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QMouseEvent>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+	const QColor kSeriesColors[] = { QColor(200, 40, 40), QColor(40, 150, 40), QColor(40, 70, 200), QColor(120, 120, 120) };
+	const int kMarginLeft = 64;
+	const int kMarginRight = 16;
+	const int kMarginTop = 16;
+	const int kMarginBottom = 36;
+}
+
+ProfileWidget::ProfileWidget(QWidget* parent)
+	: QWidget(parent, Qt::Tool), d_maxDistance(0.0), d_minValue(0.0), d_maxValue(0.0), m_hoverIndex(-1) {
+	setMouseTracking(true);
+	setMinimumSize(420, 240);
+	resize(640, 300);
+}
+
+void ProfileWidget::setProfile(const QString& title, const QStringList& bandNames, const QVector<QVector<QPointF>>& series) {
+	setWindowTitle(title);
+	m_bandNames = bandNames;
+	m_series = series;
+	m_hoverIndex = -1;
+
+	// 坐标范围只统计有效值
+	d_maxDistance = 0.0;
+	d_minValue = std::numeric_limits<double>::max();
+	d_maxValue = std::numeric_limits<double>::lowest();
+	for (const QVector<QPointF>& points : m_series) {
+		if (!points.isEmpty()) d_maxDistance = std::max(d_maxDistance, points.last().x());
+		for (const QPointF& point : points) {
+			if (std::isnan(point.y())) continue;
+			d_minValue = std::min(d_minValue, point.y());
+			d_maxValue = std::max(d_maxValue, point.y());
+		}
+	}
+	if (d_minValue > d_maxValue) {
+		d_minValue = 0.0;
+		d_maxValue = 1.0;
+	}
+	else if (d_maxValue - d_minValue < 1e-12) {
+		d_minValue -= 0.5;
+		d_maxValue += 0.5;
+	}
+	update();
+}
+
+QRectF ProfileWidget::plotRect() const {
+	return QRectF(kMarginLeft, kMarginTop, width() - kMarginLeft - kMarginRight, height() - kMarginTop - kMarginBottom);
+}
+
+void ProfileWidget::paintEvent(QPaintEvent* event) {
+	Q_UNUSED(event);
+	QPainter painter(this);
+	painter.fillRect(rect(), palette().base());
+	const QRectF plot = plotRect();
+	if (plot.width() <= 0 || plot.height() <= 0) return;
+
+	// 坐标轴与刻度
+	painter.setPen(palette().text().color());
+	painter.drawRect(plot);
+	const QFontMetrics metrics = painter.fontMetrics();
+	for (int i = 0; i <= 4; ++i) {
+		const double value = d_minValue + (d_maxValue - d_minValue) * i / 4.0;
+		const double y = plot.bottom() - plot.height() * i / 4.0;
+		painter.drawLine(QPointF(plot.left() - 4, y), QPointF(plot.left(), y));
+		const QString label = QString::number(value, 'g', 6);
+		painter.drawText(QPointF(plot.left() - 8 - metrics.horizontalAdvance(label), y + metrics.ascent() / 2.0), label);
+
+		const double distance = d_maxDistance * i / 4.0;
+		const double x = plot.left() + plot.width() * i / 4.0;
+		painter.drawLine(QPointF(x, plot.bottom()), QPointF(x, plot.bottom() + 4));
+		const QString distanceLabel = QString::number(distance, 'f', distance < 10 ? 2 : 0);
+		painter.drawText(QPointF(x - metrics.horizontalAdvance(distanceLabel) / 2.0, plot.bottom() + 6 + metrics.ascent()), distanceLabel);
+	}
+	if (m_series.isEmpty() || d_maxDistance <= 0.0) return;
+
+	auto toWidget = [&](const QPointF& point) {
+		return QPointF(plot.left() + point.x() / d_maxDistance * plot.width(),
+			plot.bottom() - (point.y() - d_minValue) / (d_maxValue - d_minValue) * plot.height());
+	};
+
+	// 每个波段一条折线，无效值处断开
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.setClipRect(plot);
+	for (int s = 0; s < m_series.size(); ++s) {
+		QPainterPath path;
+		bool drawing = false;
+		for (const QPointF& point : m_series[s]) {
+			if (std::isnan(point.y())) {
+				drawing = false;
+				continue;
+			}
+			const QPointF position = toWidget(point);
+			if (drawing) path.lineTo(position);
+			else path.moveTo(position);
+			drawing = true;
+		}
+		painter.setPen(QPen(kSeriesColors[s % 4], 1.5));
+		painter.drawPath(path);
+	}
+
+	// 鼠标位置的读数
+	if (m_hoverIndex < 0) return;
+	const double x = toWidget(QPointF(m_series[0][m_hoverIndex].x(), 0.0)).x();
+	painter.setPen(QPen(palette().text().color(), 1, Qt::DashLine));
+	painter.drawLine(QPointF(x, plot.top()), QPointF(x, plot.bottom()));
+	QStringList lines{ QString("距离 %1").arg(m_series[0][m_hoverIndex].x(), 0, 'f', 2) };
+	for (int s = 0; s < m_series.size(); ++s) {
+		if (m_hoverIndex >= m_series[s].size()) continue;
+		const double value = m_series[s][m_hoverIndex].y();
+		lines.append(QString("%1: %2").arg(m_bandNames.value(s), std::isnan(value) ? QString("NoData") : QString::number(value, 'g', 8)));
+	}
+	painter.setPen(palette().text().color());
+	double textY = plot.top() + metrics.ascent() + 4;
+	const double textX = x + 6 + 160 < plot.right() ? x + 6 : x - 6 - 160;
+	for (const QString& line : lines) {
+		painter.drawText(QPointF(textX, textY), line);
+		textY += metrics.height();
+	}
+}
+
+void ProfileWidget::mouseMoveEvent(QMouseEvent* event) {
+	const QRectF plot = plotRect();
+	if (m_series.isEmpty() || m_series[0].size() < 2 || !plot.contains(event->position())) {
+		if (m_hoverIndex >= 0) {
+			m_hoverIndex = -1;
+			update();
+		}
+		return;
+	}
+	// 采样点按距离等间隔排列
+	const double t = (event->position().x() - plot.left()) / plot.width();
+	const int index = qBound(0, static_cast<int>(std::lround(t * (m_series[0].size() - 1))), static_cast<int>(m_series[0].size()) - 1);
+	if (index != m_hoverIndex) {
+		m_hoverIndex = index;
+		update();
+	}
+}
+
+void ProfileWidget::leaveEvent(QEvent* event) {
+	Q_UNUSED(event);
+	m_hoverIndex = -1;
+	update();
+}
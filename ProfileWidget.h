@@ -0,0 +1,30 @@
+#pragma once
+#include <QWidget>
+#include <QVector>
+#include <QPointF>
+#include <QStringList>
+
+// 剖面图窗口：横轴为到起点的距离，纵轴为像元值，每个波段一条折线，NaN 处断开。
+// 鼠标移动时显示最近采样点的距离与各波段的值
+class ProfileWidget : public QWidget {
+	Q_OBJECT
+public:
+	explicit ProfileWidget(QWidget* parent = nullptr);
+
+	void setProfile(const QString& title, const QStringList& bandNames, const QVector<QVector<QPointF>>& series);
+
+protected:
+	void paintEvent(QPaintEvent* event) override;
+	void mouseMoveEvent(QMouseEvent* event) override;
+	void leaveEvent(QEvent* event) override;
+
+private:
+	QRectF plotRect() const;	//绘图区（去掉坐标轴标注的边距）
+
+	QStringList m_bandNames;
+	QVector<QVector<QPointF>> m_series;
+	double d_maxDistance;
+	double d_minValue;
+	double d_maxValue;
+	int m_hoverIndex;	//鼠标所在的采样点序号，-1 表示不显示
+};
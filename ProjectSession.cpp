@@ -0,0 +1,191 @@
+#include "ProjectSession.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include "VsiSupport.h"
+
+namespace {
+	const int kProjectVersion = 1;
+	const int kTileVersion = 2;	//瓦片格式版本：2 起 NoData 处透明
+
+	// 本地文件按相对工程目录保存，工程与数据一起移动后仍能打开
+	QString toProjectPath(const QDir& projectDir, const QString& filePath) {
+		if (VsiSupport::isVirtualPath(filePath)) return filePath;
+		return projectDir.relativeFilePath(filePath);
+	}
+
+	QString fromProjectPath(const QDir& projectDir, const QString& storedPath) {
+		if (VsiSupport::isVirtualPath(storedPath)) return storedPath;
+		return QDir::cleanPath(projectDir.absoluteFilePath(storedPath));
+	}
+
+	QJsonArray rectToJson(const QRectF& rect) {
+		return QJsonArray{ rect.left(), rect.top(), rect.width(), rect.height() };
+	}
+
+	QRectF rectFromJson(const QJsonValue& value) {
+		const QJsonArray array = value.toArray();
+		if (array.size() != 4) return QRectF();
+		return QRectF(array[0].toDouble(), array[1].toDouble(), array[2].toDouble(), array[3].toDouble());
+	}
+}
+
+QString ProjectSession::save(const QString& projectPath, const T_Project& project) {
+	const QDir projectDir = QFileInfo(projectPath).absoluteDir();
+
+	QJsonArray layers;
+	for (const T_ProjectLayer& layer : project.layers) {
+		QJsonObject json;
+		json.insert("path", toProjectPath(projectDir, layer.filePath));
+		json.insert("visible", layer.isVisible);
+		if (layer.color.isValid()) json.insert("color", layer.color.name(QColor::HexArgb));
+		if (layer.renderMode != 0) json.insert("renderMode", layer.renderMode);
+		if (layer.transparency != 0) json.insert("transparency", layer.transparency);
+		if (layer.blendMode != 0) json.insert("blendMode", layer.blendMode);
+		if (layer.style.mode != 0) {
+			QJsonObject style;
+			style.insert("mode", layer.style.mode);
+			style.insert("field", layer.style.field);
+			style.insert("classCount", layer.style.classCount);
+			style.insert("method", layer.style.method);
+			json.insert("style", style);
+		}
+		if (!layer.label.field.isEmpty()) {
+			QJsonObject label;
+			label.insert("field", layer.label.field);
+			label.insert("fontSize", layer.label.fontSize);
+			label.insert("maxResolution", layer.label.maxResolution);
+			json.insert("label", label);
+		}
+		if (layer.metadata.isValid) json.insert("metadata", layer.metadata.toJson());
+		layers.append(json);
+	}
+
+	QJsonObject json;
+	json.insert("version", kProjectVersion);
+	json.insert("crsName", project.crsName);
+	json.insert("crsWkt", project.crsWkt);
+	if (!project.viewExtent.isEmpty()) json.insert("viewExtent", rectToJson(project.viewExtent));
+	json.insert("layers", layers);
+
+	QSaveFile file(projectPath);
+	if (!file.open(QIODevice::WriteOnly)) {
+		return QString("无法写入工程文件：\n%1").arg(projectPath);
+	}
+	file.write(QJsonDocument(json).toJson(QJsonDocument::Indented));
+	if (!file.commit()) {
+		return QString("无法写入工程文件：\n%1").arg(projectPath);
+	}
+	return QString();
+}
+
+QString ProjectSession::load(const QString& projectPath, T_Project& project) {
+	QFile file(projectPath);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return QString("无法打开工程文件：\n%1").arg(projectPath);
+	}
+	QJsonParseError parseError;
+	const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+	if (!document.isObject()) {
+		return QString("工程文件格式错误：%1").arg(parseError.errorString());
+	}
+	const QJsonObject json = document.object();
+	if (json.value("version").toInt() > kProjectVersion) {
+		return "工程文件由更新版本的 YGIS 保存，无法打开";
+	}
+
+	const QDir projectDir = QFileInfo(projectPath).absoluteDir();
+	project = T_Project();
+	project.crsName = json.value("crsName").toString();
+	project.crsWkt = json.value("crsWkt").toString();
+	project.viewExtent = rectFromJson(json.value("viewExtent"));
+	for (const QJsonValue& value : json.value("layers").toArray()) {
+		const QJsonObject layerJson = value.toObject();
+		T_ProjectLayer layer;
+		layer.filePath = fromProjectPath(projectDir, layerJson.value("path").toString());
+		if (layer.filePath.isEmpty()) continue;
+		layer.isVisible = layerJson.value("visible").toBool(true);
+		layer.color = QColor(layerJson.value("color").toString());
+		layer.renderMode = layerJson.value("renderMode").toInt();
+		layer.transparency = layerJson.value("transparency").toInt();
+		layer.blendMode = layerJson.value("blendMode").toInt();
+		if (layerJson.contains("style")) {
+			const QJsonObject style = layerJson.value("style").toObject();
+			layer.style.mode = style.value("mode").toInt();
+			layer.style.field = style.value("field").toString();
+			layer.style.classCount = style.value("classCount").toInt(5);
+			layer.style.method = style.value("method").toInt();
+		}
+		if (layerJson.contains("label")) {
+			const QJsonObject label = layerJson.value("label").toObject();
+			layer.label.field = label.value("field").toString();
+			layer.label.fontSize = label.value("fontSize").toInt(9);
+			layer.label.maxResolution = label.value("maxResolution").toDouble();
+		}
+		if (layerJson.contains("metadata")) {
+			layer.metadata = T_LayerMetadata::fromJson(layerJson.value("metadata").toObject());
+			layer.metadata.filePath = layer.filePath;	//工程移动后以解析出的路径为准
+		}
+		project.layers.append(layer);
+	}
+	return QString();
+}
+
+QString ProjectSession::cacheDirectory(const QString& projectPath) {
+	const QFileInfo fileInfo(projectPath);
+	return fileInfo.absoluteDir().filePath(fileInfo.completeBaseName() + ".cache");
+}
+
+QString ProjectSession::tileDirectory(const QString& cacheDir, const QString& filePath) {
+	const QByteArray hash = QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+	return QDir(cacheDir).filePath("tiles/" + QString::fromLatin1(hash));
+}
+
+bool ProjectSession::isTileCacheValid(const QString& tileDir, const QString& filePath) {
+	QFile file(QDir(tileDir).filePath("source.json"));
+	if (!file.open(QIODevice::ReadOnly)) return false;
+	const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+	if (json.value("version").toInt() != kTileVersion || json.value("filePath").toString() != filePath) return false;
+
+	// 远程与压缩包内的文件无法廉价核对，按保存时的状态使用
+	if (VsiSupport::isVirtualPath(filePath)) return true;
+	const QFileInfo fileInfo(filePath);
+	return fileInfo.exists() &&
+		json.value("fileSize").toString().toLongLong() == fileInfo.size() &&
+		json.value("modified").toString().toLongLong() == fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+bool ProjectSession::writeTileStamp(const QString& tileDir, const QString& filePath) {
+	QJsonObject json;
+	json.insert("version", kTileVersion);
+	json.insert("filePath", filePath);
+	if (!VsiSupport::isVirtualPath(filePath)) {
+		const QFileInfo fileInfo(filePath);
+		json.insert("fileSize", QString::number(fileInfo.size()));
+		json.insert("modified", QString::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+	}
+
+	QSaveFile file(QDir(tileDir).filePath("source.json"));
+	if (!file.open(QIODevice::WriteOnly)) return false;
+	file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+	return file.commit();
+}
+
+void ProjectSession::pruneTileCache(const QString& cacheDir, const QStringList& filePaths) {
+	QSet<QString> keep;
+	for (const QString& filePath : filePaths) {
+		const QString tileDir = tileDirectory(cacheDir, filePath);
+		if (isTileCacheValid(tileDir, filePath)) keep.insert(QFileInfo(tileDir).fileName());
+	}
+
+	const QDir tilesDir(QDir(cacheDir).filePath("tiles"));
+	for (const QString& name : tilesDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+		if (!keep.contains(name)) QDir(tilesDir.filePath(name)).removeRecursively();
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <QString>
+#include <QList>
+#include <QStringList>
+#include <QColor>
+#include <QRectF>
+#include "LayerMetadata.h"
+#include "Public.h"
+
+// 工程中的一个图层
+struct T_ProjectLayer {
+	QString filePath;
+	bool isVisible = true;
+	QColor color;
+	int renderMode = 0;	//栅格显示方式（RasterLayerItem::RenderMode）
+	T_VectorStyle style;	//矢量符号化
+	T_LabelStyle label;	//矢量标注
+	int transparency = 0;	//栅格透明度（0-100）
+	int blendMode = 0;	//栅格混合方式（RasterLayerItem::BlendMode）
+	T_LayerMetadata metadata;	//保存时的元数据与统计值，打开时按文件大小与修改时间核对
+};
+
+// 工程：图层列表与样式、视图范围、坐标系
+struct T_Project {
+	QList<T_ProjectLayer> layers;
+	QRectF viewExtent;	//地图坐标（x 向东、y 向北）
+	QString crsName;
+	QString crsWkt;
+};
+
+// 工程文件（.ygis，JSON）读写。工程旁的 "<工程名>.cache" 目录可选地保存渲染好的瓦片，
+// 每个图层一个子目录，附带源文件的大小与修改时间，文件变化后整个子目录作废
+namespace ProjectSession {
+	// 成功返回空字符串，否则返回错误信息
+	QString save(const QString& projectPath, const T_Project& project);
+	QString load(const QString& projectPath, T_Project& project);
+
+	QString cacheDirectory(const QString& projectPath);
+	QString tileDirectory(const QString& cacheDir, const QString& filePath);	//图层瓦片子目录
+
+	bool isTileCacheValid(const QString& tileDir, const QString& filePath);	//子目录与源文件是否一致
+	bool writeTileStamp(const QString& tileDir, const QString& filePath);	//记录源文件的大小与修改时间
+	void pruneTileCache(const QString& cacheDir, const QStringList& filePaths);	//删除已作废或不在图层列表中的子目录
+}
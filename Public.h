@@ -1,8 +1,40 @@
 #pragma once
 #include <QGraphicsView>
 
+//矢量符号化设置
+struct T_VectorStyle {
+	int mode = 0;	//ThematicStyle::Mode，0 为单一颜色
+	QString field;	//分类 / 分级依据的字段
+	int classCount = 5;	//分级数
+	int method = 0;	//分级方法（ThematicStyle::Method）
+
+	bool operator==(const T_VectorStyle& other) const {
+		return mode == other.mode && field == other.field && classCount == other.classCount && method == other.method;
+	}
+	bool operator!=(const T_VectorStyle& other) const { return !(*this == other); }
+};
+Q_DECLARE_METATYPE(T_VectorStyle)
+
+//标注设置
+struct T_LabelStyle {
+	QString field;	//标注文字取自的字段，为空时不显示标注
+	int fontSize = 9;
+	double maxResolution = 0.0;	//每像素对应的地图单位大于此值（缩得太小）时不显示，0 为不限
+
+	bool operator==(const T_LabelStyle& other) const {
+		return field == other.field && fontSize == other.fontSize && maxResolution == other.maxResolution;
+	}
+	bool operator!=(const T_LabelStyle& other) const { return !(*this == other); }
+};
+Q_DECLARE_METATYPE(T_LabelStyle)
+
 //文件信息类型
 struct T_Information {
 	bool isVisible;
 	QColor color;
-};
\ No newline at end of file
+	int renderMode = 0;	//栅格显示方式（RasterLayerItem::RenderMode）
+	T_VectorStyle style;	//矢量符号化
+	T_LabelStyle label;	//矢量标注
+	int transparency = 0;	//栅格透明度（0-100）
+	int blendMode = 0;	//栅格混合方式（RasterLayerItem::BlendMode）
+};
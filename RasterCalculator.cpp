@@ -0,0 +1,340 @@
+#include "RasterCalculator.h"
+#include <QPromise>
+#include <QRect>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <gdal_priv.h>
+#include "BlockWriter.h"
+#include "DatasetPool.h"
+
+namespace {
+	const int kTileSize = 256;	//输出分块边长
+	const int kWindowPixels = 1 << 20;	//每个窗口的像素上限，决定每个工作线程占用的内存
+
+	// 运算符优先级；'~' 为一元负号
+	int precedence(QChar op) {
+		if (op == '~') return 3;
+		if (op == '*' || op == '/') return 2;
+		return 1;
+	}
+
+	// 栈上的操作数：指向波段或临时数组，常量不展开为数组
+	struct T_Operand {
+		const float* data;
+		float value;
+	};
+
+	template<typename Op>
+	void applyBinary(const T_Operand& a, const T_Operand& b, float* out, int count, Op op) {
+		if (a.data && b.data) {
+			for (int i = 0; i < count; ++i) out[i] = op(a.data[i], b.data[i]);
+		}
+		else if (a.data) {
+			const float v = b.value;
+			for (int i = 0; i < count; ++i) out[i] = op(a.data[i], v);
+		}
+		else if (b.data) {
+			const float v = a.value;
+			for (int i = 0; i < count; ++i) out[i] = op(v, b.data[i]);
+		}
+		else {
+			std::fill(out, out + count, op(a.value, b.value));
+		}
+	}
+}
+
+BandExpression::BandExpression() : m_stackDepth(0) {
+}
+
+void BandExpression::appendOperation(OpCode op) {
+	const int size = m_program.size();
+	if (op == Negate && size >= 1 && m_program[size - 1].op == PushConstant) {
+		m_program[size - 1].value = -m_program[size - 1].value;
+		return;
+	}
+	if (op != Negate && size >= 2 && m_program[size - 1].op == PushConstant && m_program[size - 2].op == PushConstant) {
+		const float a = m_program[size - 2].value;
+		const float b = m_program[size - 1].value;
+		m_program.removeLast();
+		float& result = m_program.last().value;
+		switch (op) {
+		case Add: result = a + b; break;
+		case Subtract: result = a - b; break;
+		case Multiply: result = a * b; break;
+		default: result = a / b; break;
+		}
+		return;
+	}
+	m_program.append(T_Instruction{ op, 0, 0.0f });
+}
+
+QString BandExpression::compile(const QString& text) {
+	m_text = text.trimmed();
+	m_program.clear();
+	m_bands.clear();
+	m_stackDepth = 0;
+
+	// 调度场算法：中缀 -> 逆波兰
+	QVector<QChar> operators;
+	auto popOperator = [this, &operators]() {
+		const QChar op = operators.takeLast();
+		switch (op.unicode()) {
+		case '~': appendOperation(Negate); break;
+		case '+': appendOperation(Add); break;
+		case '-': appendOperation(Subtract); break;
+		case '*': appendOperation(Multiply); break;
+		default: appendOperation(Divide); break;
+		}
+	};
+
+	bool expectOperand = true;	//下一个记号应为操作数（或一元负号、左括号）
+	int pos = 0;
+	while (pos < m_text.size()) {
+		const QChar c = m_text[pos];
+		if (c.isSpace()) {
+			++pos;
+			continue;
+		}
+
+		if (expectOperand) {
+			if (c == 'B' || c == 'b') {
+				int end = pos + 1;
+				while (end < m_text.size() && m_text[end].isDigit()) ++end;
+				const int band = m_text.mid(pos + 1, end - pos - 1).toInt();
+				if (band < 1) return QString("第 %1 个字符处的波段号无效").arg(pos + 1);
+				m_program.append(T_Instruction{ PushBand, band, 0.0f });
+				pos = end;
+				expectOperand = false;
+			}
+			else if (c.isDigit() || c == '.') {
+				int end = pos;
+				while (end < m_text.size() && (m_text[end].isDigit() || m_text[end] == '.')) ++end;
+				if (end < m_text.size() && (m_text[end] == 'e' || m_text[end] == 'E')) {
+					int exponent = end + 1;
+					if (exponent < m_text.size() && (m_text[exponent] == '+' || m_text[exponent] == '-')) ++exponent;
+					if (exponent < m_text.size() && m_text[exponent].isDigit()) {
+						end = exponent;
+						while (end < m_text.size() && m_text[end].isDigit()) ++end;
+					}
+				}
+				bool ok = false;
+				const double value = m_text.mid(pos, end - pos).toDouble(&ok);
+				if (!ok) return QString("第 %1 个字符处的数值无效").arg(pos + 1);
+				m_program.append(T_Instruction{ PushConstant, 0, static_cast<float>(value) });
+				pos = end;
+				expectOperand = false;
+			}
+			else if (c == '-' || c == '+') {
+				if (c == '-') operators.append('~');	//一元正号无需指令
+				++pos;
+			}
+			else if (c == '(') {
+				operators.append(c);
+				++pos;
+			}
+			else {
+				return QString("第 %1 个字符处缺少操作数").arg(pos + 1);
+			}
+			continue;
+		}
+
+		if (c == '+' || c == '-' || c == '*' || c == '/') {
+			while (!operators.isEmpty() && operators.last() != '(' && precedence(operators.last()) >= precedence(c)) {
+				popOperator();
+			}
+			operators.append(c);
+			expectOperand = true;
+		}
+		else if (c == ')') {
+			while (!operators.isEmpty() && operators.last() != '(') popOperator();
+			if (operators.isEmpty()) return QString("第 %1 个字符处的右括号没有匹配").arg(pos + 1);
+			operators.removeLast();
+		}
+		else {
+			return QString("第 %1 个字符“%2”无法识别").arg(pos + 1).arg(c);
+		}
+		++pos;
+	}
+
+	if (expectOperand) {
+		m_program.clear();
+		return m_text.isEmpty() ? QString("表达式为空") : QString("表达式不完整");
+	}
+	while (!operators.isEmpty()) {
+		if (operators.last() == '(') {
+			m_program.clear();
+			return QString("左括号没有匹配");
+		}
+		popOperator();
+	}
+
+	// 波段号 -> 输入数组下标，同时计算栈深度
+	for (const T_Instruction& instruction : m_program) {
+		if (instruction.op == PushBand && !m_bands.contains(instruction.operand)) m_bands.append(instruction.operand);
+	}
+	std::sort(m_bands.begin(), m_bands.end());
+	int depth = 0;
+	for (T_Instruction& instruction : m_program) {
+		if (instruction.op == PushBand) instruction.operand = m_bands.indexOf(instruction.operand);
+		if (instruction.op == PushBand || instruction.op == PushConstant) m_stackDepth = std::max(m_stackDepth, ++depth);
+		else if (instruction.op != Negate) --depth;
+	}
+	return QString();
+}
+
+void BandExpression::evaluate(const float* const* bandData, float* scratch, float* output, int count) const {
+	// 栈的第 i 层写入 scratch 的第 i 段；最后一条指令直接写入 output
+	QVarLengthArray<T_Operand, 16> stack;
+	for (int pc = 0; pc < m_program.size(); ++pc) {
+		const T_Instruction& instruction = m_program[pc];
+		if (instruction.op == PushBand) {
+			stack.append(T_Operand{ bandData[instruction.operand], 0.0f });
+			continue;
+		}
+		if (instruction.op == PushConstant) {
+			stack.append(T_Operand{ nullptr, instruction.value });
+			continue;
+		}
+
+		const int level = instruction.op == Negate ? stack.size() - 1 : stack.size() - 2;
+		float* out = pc == m_program.size() - 1 ? output : scratch + static_cast<qint64>(level) * count;
+		if (instruction.op == Negate) {
+			const T_Operand a = stack.last();
+			if (a.data) {
+				for (int i = 0; i < count; ++i) out[i] = -a.data[i];
+				stack.last().data = out;
+			}
+			else {
+				stack.last().value = -a.value;
+			}
+			continue;
+		}
+
+		const T_Operand b = stack.takeLast();
+		const T_Operand a = stack.last();
+		switch (instruction.op) {
+		case Add: applyBinary(a, b, out, count, [](float x, float y) { return x + y; }); break;
+		case Subtract: applyBinary(a, b, out, count, [](float x, float y) { return x - y; }); break;
+		case Multiply: applyBinary(a, b, out, count, [](float x, float y) { return x * y; }); break;
+		default: applyBinary(a, b, out, count, [](float x, float y) { return x / y; }); break;
+		}
+		stack.last().data = out;
+	}
+
+	// 表达式只有一个操作数时结果尚未写入 output
+	const T_Operand& result = stack.last();
+	if (!result.data) std::fill(output, output + count, result.value);
+	else if (result.data != output) std::copy(result.data, result.data + count, output);
+}
+
+QString RasterCalculator::calculate(const QString& inputPath, const QString& expression, const QString& outputPath,
+	QPromise<QString>* promise) {
+	BandExpression program;
+	const QString compileError = program.compile(expression);
+	if (!compileError.isEmpty()) return compileError;
+
+	DatasetHandle source = DatasetPool::instance().acquire(inputPath);
+	if (!source) return QString("无法打开输入文件：%1").arg(inputPath);
+
+	const int width = source->GetRasterXSize();
+	const int height = source->GetRasterYSize();
+	const QVector<int> bands = program.bands();
+	if (source->GetRasterCount() == 0) return QString("输入文件没有栅格波段");
+	if (!bands.isEmpty() && bands.last() > source->GetRasterCount()) {
+		return QString("表达式引用了 B%1，输入只有 %2 个波段").arg(bands.last()).arg(source->GetRasterCount());
+	}
+
+	// 各输入波段的 NoData
+	std::vector<int> bandMap(bands.begin(), bands.end());
+	std::vector<double> noData(bands.size());
+	std::vector<char> hasNoData(bands.size());
+	for (int i = 0; i < bands.size(); ++i) {
+		int success = FALSE;
+		noData[i] = source->GetRasterBand(bands[i])->GetNoDataValue(&success);
+		hasNoData[i] = success ? 1 : 0;
+	}
+
+	// 窗口为一行输出分块、宽度按分块取整并受 kWindowPixels 限制，写出时不必拆分分块；
+	// 输入的块（条带或整幅单块）由 GDAL 块缓存复用，窗口大小与之无关
+	const int rows = std::min(height, kTileSize);
+	const int columns = std::min(width, std::max(kTileSize, kWindowPixels / rows / kTileSize * kTileSize));
+	QVector<QRect> windows;
+	for (int y = 0; y < height; y += rows) {
+		for (int x = 0; x < width; x += columns) {
+			windows.append(QRect(x, y, std::min(columns, width - x), std::min(rows, height - y)));
+		}
+	}
+
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+	if (!driver) return QString("无法获取 GTiff 驱动");
+
+	// 分块 + 浮点预测的 LZW 压缩，压缩由 GDAL 的线程完成，写入本身串行
+	char** options = nullptr;
+	options = CSLSetNameValue(options, "TILED", "YES");
+	options = CSLSetNameValue(options, "BLOCKXSIZE", QByteArray::number(kTileSize).constData());
+	options = CSLSetNameValue(options, "BLOCKYSIZE", QByteArray::number(kTileSize).constData());
+	options = CSLSetNameValue(options, "COMPRESS", "LZW");
+	options = CSLSetNameValue(options, "PREDICTOR", "3");
+	options = CSLSetNameValue(options, "BIGTIFF", "IF_NEEDED");
+	options = CSLSetNameValue(options, "NUM_THREADS", "ALL_CPUS");
+
+	DatasetPool::instance().prepareOutput(outputPath, driver);
+	GDALDataset* target = driver->Create(outputPath.toUtf8().constData(), width, height, 1, GDT_Float32, options);
+	CSLDestroy(options);
+	if (!target) return QString("无法创建输出文件：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+
+	double geoTransform[6];
+	if (source->GetGeoTransform(geoTransform) == CE_None) target->SetGeoTransform(geoTransform);
+	const char* projection = source->GetProjectionRef();
+	if (projection && projection[0]) target->SetProjection(projection);
+	GDALRasterBand* targetBand = target->GetRasterBand(1);
+	targetBand->SetNoDataValue(NoDataValue);
+	targetBand->SetDescription(program.text().toUtf8().constData());
+	source.reset();
+
+	const int bandCount = bands.size();
+	const int stackDepth = program.stackDepth();
+
+	// 每个工作线程一次处理一个窗口，输入与临时数组按线程复用；数据集句柄按线程取自 DatasetPool
+	return BlockWriter::run(target, windows, GDT_Float32, [&](const QRect& window, void* pixels) {
+		const int count = window.width() * window.height();
+		thread_local std::vector<float> buffer;
+		buffer.resize(static_cast<size_t>(count) * (bandCount + stackDepth));
+		float* input = buffer.data();
+		float* scratch = input + static_cast<size_t>(count) * bandCount;
+		float* output = static_cast<float*>(pixels);
+
+		if (bandCount > 0) {
+			DatasetHandle dataset = DatasetPool::instance().acquire(inputPath);
+			const CPLErr err = dataset
+				? dataset->RasterIO(GF_Read, window.x(), window.y(), window.width(), window.height(),
+					input, window.width(), window.height(), GDT_Float32, bandCount, bandMap.data(),
+					0, 0, static_cast<GSpacing>(count) * sizeof(float), nullptr)
+				: CE_Failure;
+			if (err != CE_None) return QString("读取输入失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+		}
+
+		std::vector<const float*> bandData(bandCount);
+		for (int i = 0; i < bandCount; ++i) bandData[i] = input + static_cast<size_t>(count) * i;
+		program.evaluate(bandData.data(), scratch, output, count);
+
+		// 输入为 NoData 或结果不是有限值的像素输出 NoData
+		for (int i = 0; i < count; ++i) {
+			if (!std::isfinite(output[i])) output[i] = NoDataValue;
+		}
+		for (int b = 0; b < bandCount; ++b) {
+			if (!hasNoData[b]) continue;
+			const float value = static_cast<float>(noData[b]);
+			const float* data = bandData[b];
+			if (std::isnan(value)) {
+				for (int i = 0; i < count; ++i) if (std::isnan(data[i])) output[i] = NoDataValue;
+			}
+			else {
+				for (int i = 0; i < count; ++i) if (data[i] == value) output[i] = NoDataValue;
+			}
+		}
+		return QString();
+		}, promise);
+}
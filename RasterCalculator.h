@@ -0,0 +1,60 @@
+#pragma once
+#include <QString>
+#include <QVector>
+
+template<typename T> class QPromise;
+
+// 波段表达式：把 (B4-B3)/(B4+B3) 这类表达式编译为逆波兰指令序列，
+// 求值时每条指令处理一整块像素（连续的 float 数组），循环可由编译器向量化
+class BandExpression {
+public:
+	BandExpression();
+
+	// 支持 B1..Bn、数值常量、+ - * /、括号与一元负号；成功返回空字符串，否则返回错误信息
+	QString compile(const QString& text);
+
+	bool isValid() const { return !m_program.isEmpty(); }
+	QString text() const { return m_text; }
+	QVector<int> bands() const { return m_bands; }	//用到的波段号（升序、去重）
+	int stackDepth() const { return m_stackDepth; }	//求值所需的临时数组个数
+
+	// bandData[i] 为 bands()[i] 的像素；scratch 至少 stackDepth() * count 个 float。结果写入 output
+	void evaluate(const float* const* bandData, float* scratch, float* output, int count) const;
+
+private:
+	// 指令
+	enum OpCode {
+		PushBand,	//operand 为 bands() 中的下标
+		PushConstant,
+		Negate,
+		Add,
+		Subtract,
+		Multiply,
+		Divide
+	};
+
+	struct T_Instruction {
+		OpCode op;
+		int operand;
+		float value;
+	};
+
+	void appendOperation(OpCode op);	//追加运算指令，两个常量之间的运算直接折叠
+
+	QString m_text;
+	QVector<T_Instruction> m_program;
+	QVector<int> m_bands;
+	int m_stackDepth;
+};
+
+// 栅格计算器：按块流式读取输入、多线程求值、写出分块压缩的 Float32 GeoTIFF。
+// 同时在内存中的只有每个工作线程的一个窗口，与影像大小无关
+namespace RasterCalculator {
+	// 输入像素为 NoData 或结果非有限值（如除以 0）时输出该值
+	const float NoDataValue = -3.4028234663852886e+38f;
+
+	// 成功返回空字符串，否则返回错误信息。promise 非空时汇报进度（窗口数）并响应取消。
+	// 耗时较长，应在后台线程调用
+	QString calculate(const QString& inputPath, const QString& expression, const QString& outputPath,
+		QPromise<QString>* promise = nullptr);
+}
@@ -0,0 +1,190 @@
+#include "RasterClip.h"
+#include <QRect>
+#include <QByteArray>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <gdal_priv.h>
+#include <gdal_utils.h>
+#include <ogrsf_frmts.h>
+#include <ogr_spatialref.h>
+#include "DatasetPool.h"
+
+namespace {
+	// 地图范围 -> 源栅格的像元窗口（外扩到整像元并裁剪到栅格范围）
+	QRect pixelWindow(const double* geoTransform, const QRectF& extent, int width, int height) {
+		const double x0 = (extent.left() - geoTransform[0]) / geoTransform[1];
+		const double x1 = (extent.right() - geoTransform[0]) / geoTransform[1];
+		const double y0 = (extent.bottom() - geoTransform[3]) / geoTransform[5];	//y 向北，行号向下
+		const double y1 = (extent.top() - geoTransform[3]) / geoTransform[5];
+		const int column0 = static_cast<int>(std::floor(std::min(x0, x1)));
+		const int column1 = static_cast<int>(std::ceil(std::max(x0, x1)));
+		const int row0 = static_cast<int>(std::floor(std::min(y0, y1)));
+		const int row1 = static_cast<int>(std::ceil(std::max(y0, y1)));
+		return QRect(QPoint(column0, row0), QPoint(column1 - 1, row1 - 1)).intersected(QRect(0, 0, width, height));
+	}
+
+	// 分块 + 带预测的 LZW 压缩，压缩由 GDAL 的线程完成
+	char** appendCreationOptions(char** args, GDALDataType dataType) {
+		args = CSLAddString(args, "-of");
+		args = CSLAddString(args, "GTiff");
+		const char* options[] = { "TILED=YES", "COMPRESS=LZW", "BIGTIFF=IF_NEEDED", "NUM_THREADS=ALL_CPUS",
+			GDALDataTypeIsFloating(dataType) ? "PREDICTOR=3" : "PREDICTOR=2" };
+		for (const char* option : options) {
+			args = CSLAddString(args, "-co");
+			args = CSLAddString(args, option);
+		}
+		return args;
+	}
+
+	// 面要素的全部环转为源栅格的像元坐标，用作 GDALWarp 的 CUTLINE
+	void appendPixelPolygons(const OGRGeometry* geometry, const double* geoTransform, OGRMultiPolygon& cutline) {
+		const OGRwkbGeometryType type = wkbFlatten(geometry->getGeometryType());
+		if (type == wkbPolygon) {
+			const OGRPolygon* polygon = geometry->toPolygon();
+			OGRPolygon pixelPolygon;
+			for (int r = -1; r < polygon->getNumInteriorRings(); ++r) {
+				const OGRLinearRing* ring = r < 0 ? polygon->getExteriorRing() : polygon->getInteriorRing(r);
+				if (!ring || ring->getNumPoints() < 4) continue;
+				OGRLinearRing pixelRing;
+				pixelRing.setNumPoints(ring->getNumPoints(), FALSE);
+				for (int i = 0; i < ring->getNumPoints(); ++i) {
+					pixelRing.setPoint(i, (ring->getX(i) - geoTransform[0]) / geoTransform[1],
+						(ring->getY(i) - geoTransform[3]) / geoTransform[5]);
+				}
+				pixelPolygon.addRing(&pixelRing);
+			}
+			if (!pixelPolygon.IsEmpty()) cutline.addGeometry(&pixelPolygon);
+		}
+		else if (OGR_GT_IsSubClassOf(type, wkbGeometryCollection)) {
+			const OGRGeometryCollection* collection = geometry->toGeometryCollection();
+			for (int i = 0; i < collection->getNumGeometries(); ++i) {
+				appendPixelPolygons(collection->getGeometryRef(i), geoTransform, cutline);
+			}
+		}
+	}
+}
+
+QString RasterClip::clipToExtent(const QString& inputPath, const QRectF& extent, const QString& outputPath) {
+	DatasetHandle source = DatasetPool::instance().acquire(inputPath);
+	if (!source || source->GetRasterCount() == 0) return QString("无法打开栅格：%1").arg(inputPath);
+	double geoTransform[6];
+	if (source->GetGeoTransform(geoTransform) != CE_None) return QString("栅格没有地理参考");
+	if (geoTransform[2] != 0.0 || geoTransform[4] != 0.0) return QString("不支持带旋转的栅格");
+
+	const QRect window = pixelWindow(geoTransform, extent, source->GetRasterXSize(), source->GetRasterYSize());
+	if (window.isEmpty()) return QString("裁剪范围与栅格不相交");
+
+	char** args = nullptr;
+	args = CSLAddString(args, "-srcwin");
+	for (int value : { window.x(), window.y(), window.width(), window.height() }) {
+		args = CSLAddString(args, QByteArray::number(value).constData());
+	}
+	args = appendCreationOptions(args, source->GetRasterBand(1)->GetRasterDataType());
+	GDALTranslateOptions* options = GDALTranslateOptionsNew(args, nullptr);
+	CSLDestroy(args);
+	if (!options) return QString("裁剪参数无效");
+
+	DatasetPool::instance().prepareOutput(outputPath);
+	int usageError = FALSE;
+	GDALDatasetH output = GDALTranslate(outputPath.toUtf8().constData(), static_cast<GDALDatasetH>(source.get()), options, &usageError);
+	GDALTranslateOptionsFree(options);
+	if (!output) return QString("裁剪失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+	GDALClose(output);
+	return QString();
+}
+
+QString RasterClip::clipToFeatures(const QString& inputPath, const QString& vectorPath, const QList<qint64>& featureIds,
+	const QString& outputPath) {
+	if (featureIds.isEmpty()) return QString("没有选中的要素");
+
+	DatasetHandle source = DatasetPool::instance().acquire(inputPath);
+	if (!source || source->GetRasterCount() == 0) return QString("无法打开栅格：%1").arg(inputPath);
+	double geoTransform[6];
+	if (source->GetGeoTransform(geoTransform) != CE_None) return QString("栅格没有地理参考");
+	if (geoTransform[2] != 0.0 || geoTransform[4] != 0.0) return QString("不支持带旋转的栅格");
+	OGRSpatialReference rasterSrs;
+	const char* rasterWkt = source->GetProjectionRef();
+	const bool hasRasterSrs = rasterWkt && rasterWkt[0] && rasterSrs.importFromWkt(rasterWkt) == OGRERR_NONE;
+
+	DatasetHandle vector = DatasetPool::instance().acquire(vectorPath);
+	if (!vector || !vector->GetLayer(0)) return QString("无法打开面图层：%1").arg(vectorPath);
+	OGRLayer* layer = vector->GetLayer(0);
+
+	std::unique_ptr<OGRCoordinateTransformation> transform;
+	const OGRSpatialReference* vectorSrs = layer->GetSpatialRef();
+	if (hasRasterSrs && vectorSrs && !vectorSrs->IsSame(&rasterSrs)) {
+		OGRSpatialReference sourceSrs(*vectorSrs);
+		sourceSrs.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+		rasterSrs.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+		transform.reset(OGRCreateCoordinateTransformation(&sourceSrs, &rasterSrs));
+		if (!transform) return QString("无法把面图层变换到栅格坐标系");
+	}
+
+	// 选中要素 -> 栅格坐标系下的外包范围与像元坐标裁剪线
+	OGRMultiPolygon cutline;
+	OGREnvelope envelope;
+	for (qint64 featureId : featureIds) {
+		OGRFeature* feature = layer->GetFeature(featureId);
+		if (!feature) continue;
+		std::unique_ptr<OGRGeometry> geometry(feature->GetGeometryRef() ? feature->GetGeometryRef()->clone() : nullptr);
+		OGRFeature::DestroyFeature(feature);
+		if (!geometry) continue;
+		if (geometry->hasCurveGeometry()) geometry.reset(geometry->getLinearGeometry());
+		if (transform && geometry->transform(transform.get()) != OGRERR_NONE) continue;
+
+		OGREnvelope featureEnvelope;
+		geometry->getEnvelope(&featureEnvelope);
+		envelope.Merge(featureEnvelope);
+		appendPixelPolygons(geometry.get(), geoTransform, cutline);
+	}
+	if (cutline.IsEmpty()) return QString("选中的要素中没有面");
+
+	const QRect window = pixelWindow(geoTransform, QRectF(QPointF(envelope.MinX, envelope.MinY), QPointF(envelope.MaxX, envelope.MaxY)),
+		source->GetRasterXSize(), source->GetRasterYSize());
+	if (window.isEmpty()) return QString("选中的要素与栅格不相交");
+
+	// 输出范围取整到源像元，分辨率与源相同，最近邻重采样即逐像元复制
+	char* cutlineWkt = nullptr;
+	cutline.exportToWkt(&cutlineWkt);
+	const QByteArray cutlineOption = QByteArray("CUTLINE=") + cutlineWkt;
+	CPLFree(cutlineWkt);
+
+	GDALRasterBand* firstBand = source->GetRasterBand(1);
+	int hasNoData = FALSE;
+	const double noData = firstBand->GetNoDataValue(&hasNoData);
+
+	char** args = nullptr;
+	args = CSLAddString(args, "-te");
+	for (double value : { geoTransform[0] + window.left() * geoTransform[1], geoTransform[3] + (window.bottom() + 1) * geoTransform[5],
+		geoTransform[0] + (window.right() + 1) * geoTransform[1], geoTransform[3] + window.top() * geoTransform[5] }) {
+		args = CSLAddString(args, QByteArray::number(value, 'g', 17).constData());
+	}
+	args = CSLAddString(args, "-tr");
+	args = CSLAddString(args, QByteArray::number(geoTransform[1], 'g', 17).constData());
+	args = CSLAddString(args, QByteArray::number(std::abs(geoTransform[5]), 'g', 17).constData());
+	args = CSLAddString(args, "-r");
+	args = CSLAddString(args, "near");
+	args = CSLAddString(args, "-dstnodata");
+	args = CSLAddString(args, hasNoData ? QByteArray::number(noData, 'g', 17).constData() : "0");
+	args = CSLAddString(args, "-wo");
+	args = CSLAddString(args, cutlineOption.constData());
+	args = CSLAddString(args, "-wo");
+	args = CSLAddString(args, "NUM_THREADS=ALL_CPUS");
+	args = CSLAddString(args, "-multi");
+	args = CSLAddString(args, "-wm");
+	args = CSLAddString(args, "256");	//每个分块的工作内存（MB）
+	args = appendCreationOptions(args, firstBand->GetRasterDataType());
+	GDALWarpAppOptions* options = GDALWarpAppOptionsNew(args, nullptr);
+	CSLDestroy(args);
+	if (!options) return QString("裁剪参数无效");
+
+	DatasetPool::instance().prepareOutput(outputPath); // GDALWarp 不覆盖已有文件
+	GDALDatasetH sourceHandle = static_cast<GDALDatasetH>(source.get());
+	int usageError = FALSE;
+	GDALDatasetH output = GDALWarp(outputPath.toUtf8().constData(), nullptr, 1, &sourceHandle, options, &usageError);
+	GDALWarpAppOptionsFree(options);
+	if (!output) return QString("裁剪失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+	GDALClose(output);
+	return QString();
+}
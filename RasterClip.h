@@ -0,0 +1,16 @@
+#pragma once
+#include <QString>
+#include <QRectF>
+#include <QList>
+
+// 栅格裁剪：按地图范围或面要素截取一块，写出分块压缩的 GeoTIFF。
+// 输出像元与源栅格对齐，只读取与裁剪范围相交的源数据块，耗时与裁剪范围成正比
+namespace RasterClip {
+	// 按地图范围（x 向东、y 向北）裁剪，范围外扩到整像元；以 GDALTranslate 的 srcwin 直接复制窗口
+	QString clipToExtent(const QString& inputPath, const QRectF& extent, const QString& outputPath);
+
+	// 按面图层中的若干要素裁剪：输出范围为要素外包矩形，面外的像元写为 NoData（源栅格没有 NoData 时为 0）。
+	// 面与栅格坐标系不同时先变换到栅格坐标系
+	QString clipToFeatures(const QString& inputPath, const QString& vectorPath, const QList<qint64>& featureIds,
+		const QString& outputPath);
+}
@@ -12,11 +12,13 @@
 #include <gdal_priv.h>
 #include <gdal_utils.h>
 #include <ogrsf_frmts.h>
-#include <qDebug>
+#include <QDebug>
 #include <QDir>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QMessageBox>
+#include "DatasetPool.h"
+#include "LayerMetadata.h"
 
 RasterInfoWidget::RasterInfoWidget(QWidget* parent)  
  : QMainWindow(parent), m_tableView(nullptr) {  // 初始化 m_tableView 为 nullptr
@@ -41,29 +43,22 @@ RasterInfoWidget::RasterInfoWidget(QWidget* parent)
 }
 
 void RasterInfoWidget::showRasterInfo(QString filePath) {  
-  std::string s_rasterData = filePath.toStdString();  
-  const char* c_rasterData = s_rasterData.c_str();  
-
-  // 打开栅格文件  
-  GDALDataset* poDataset = (GDALDataset*)GDALOpen(c_rasterData, GA_ReadOnly);  
-  if (!poDataset) {  
-      qDebug() << "无法打开文件！";  
-      return;  
-  }  
+  // 分辨率、投影与统计值取自图层元数据，不再重新打开文件计算
+  const T_LayerMetadata metadata = LayerMetadata::scan(filePath);
+  if (!metadata.isValid || metadata.fileType != "Raster") {
+      qDebug() << "无法打开文件！";
+      return;
+  }
 
   // 获取分辨率
-  double adfGeoTransform[6];
-  double xResolution = 0, yResolution = 0;
-  if (poDataset->GetGeoTransform(adfGeoTransform) == CE_None) {
-      xResolution = adfGeoTransform[1];
-      yResolution = abs(adfGeoTransform[5]);
-  }
+  const double xResolution = metadata.pixelSizeX;
+  const double yResolution = metadata.pixelSizeY;
 
   // 获取投影
-  const char* pszProj = poDataset->GetProjectionRef();
+  const QString projection = metadata.crsWkt;
 
   // 获取波段总数
-  int bandCount = poDataset->GetRasterCount();
+  const int bandCount = metadata.bands.size();
 
   // 计算均值和方差
   QString meanValues = "(N/A)";
@@ -71,25 +66,20 @@ void RasterInfoWidget::showRasterInfo(QString filePath) {
   if (bandCount >= 3) { // 确保至少有 3 个波段
       double mean[3] = { 0 }, stddev[3] = { 0 };
       for (int i = 0; i < 3; ++i) {
-          GDALRasterBand* band = poDataset->GetRasterBand(i + 1);
-          if (band) {
-              band->GetStatistics(false, true, nullptr, nullptr, &mean[i], &stddev[i]);
-          }
+          mean[i] = metadata.bands[i].mean;
+          stddev[i] = metadata.bands[i].stdDev;
       }
       meanValues = QString("(%1, %2, %3)").arg(mean[0]).arg(mean[1]).arg(mean[2]);
       stddevValues = QString("(%1, %2, %3)").arg(stddev[0]).arg(stddev[1]).arg(stddev[2]);
   }
 
-  // 关闭数据集以释放资源  
-  GDALClose(poDataset);  
-
   // 更新表格模型
   QStandardItemModel* model = qobject_cast<QStandardItemModel*>(m_tableView->model());
   if (model) {
       model->setItem(0, 1, new QStandardItem(QFileInfo(filePath).fileName())); // 文件名
       model->setItem(1, 1, new QStandardItem(filePath)); // 路径
       model->setItem(2, 1, new QStandardItem(QString("%1 x %2").arg(xResolution).arg(yResolution))); // 分辨率
-      model->setItem(3, 1, new QStandardItem(pszProj)); // 投影
+      model->setItem(3, 1, new QStandardItem(projection)); // 投影
       model->setItem(4, 1, new QStandardItem(QString::number(bandCount))); // 波段数
       model->setItem(5, 1, new QStandardItem(meanValues)); // 均值 (R, G, B)
       model->setItem(6, 1, new QStandardItem(stddevValues)); // 方差 (R, G, B)
@@ -111,11 +101,10 @@ bool RasterInfoWidget::ResampleRaster(const QString& inputPath,
     QElapsedTimer timer;
     timer.start(); // 开始计时
 
-    GDALAllRegister();
-
     // 打开输入数据集
     qDebug() << "\n[1/7] 打开输入文件...";
-    GDALDataset* srcDS = (GDALDataset*)GDALOpen(inputPath.toUtf8().constData(), GA_ReadOnly);
+    DatasetHandle srcHandle = DatasetPool::instance().acquire(inputPath);
+    GDALDataset* srcDS = srcHandle.get();
     if (!srcDS) {
         qCritical() << "错误：无法打开输入文件";
         QMessageBox::critical(this, "错误", "无法打开输入文件");
@@ -139,7 +128,6 @@ bool RasterInfoWidget::ResampleRaster(const QString& inputPath,
     GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("GTiff");
     if (!driver) {
         qCritical() << "错误：无法获取GTiff驱动";
-        GDALClose(srcDS);
         return false;
     }
 
@@ -149,6 +137,7 @@ bool RasterInfoWidget::ResampleRaster(const QString& inputPath,
     options = CSLSetNameValue(options, "COMPRESS", "LZW");
     options = CSLSetNameValue(options, "BIGTIFF", "IF_NEEDED");
 
+    DatasetPool::instance().prepareOutput(outputPath, driver);
     GDALDataset* dstDS = driver->Create(
         outputPath.toUtf8().constData(),
         dstWidth,
@@ -162,7 +151,6 @@ bool RasterInfoWidget::ResampleRaster(const QString& inputPath,
 
     if (!dstDS) {
         qCritical() << "错误：无法创建输出文件";
-        GDALClose(srcDS);
         return false;
     }
 
@@ -214,7 +202,6 @@ bool RasterInfoWidget::ResampleRaster(const QString& inputPath,
     if (!warpOptions->pTransformerArg) {
         qCritical() << "坐标转换器创建失败：" << CPLGetLastErrorMsg();
         GDALDestroyWarpOptions(warpOptions);
-        GDALClose(srcDS);
         GDALClose(dstDS);
         return false;
     }
@@ -254,7 +241,6 @@ bool RasterInfoWidget::ResampleRaster(const QString& inputPath,
         GDALDestroyGenImgProjTransformer(warpOptions->pTransformerArg);
     }
     GDALDestroyWarpOptions(warpOptions);
-    GDALClose(srcDS);
     GDALClose(dstDS);
 
     if (err != CE_None) {
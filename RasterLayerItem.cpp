@@ -0,0 +1,650 @@
+#include "RasterLayerItem.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QCache>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QColor>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <gdal.h>
+#include <gdal_priv.h>
+#include <ogr_spatialref.h>
+#include "RenderProfiler.h"
+#include "DatasetPool.h"
+#include "LayerMetadata.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YGIS_HAS_SSE2
+#endif
+
+static const double kDegreeToRadian = 3.14159265358979323846 / 180.0;
+
+// ARGB32 像素按 quint32 0xAARRGGBB 存放，各通道在内存中的字节位置与字节序有关
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+static const int kBlueByte = 0;
+static const int kAlphaByte = 3;
+static const int kFirstColorByte = 0;	//依次为 B、G、R
+static const int kColorBandOrder[3] = { 3, 2, 1 };	//按字节顺序对应的 RGB 波段
+#else
+static const int kBlueByte = 3;
+static const int kAlphaByte = 0;
+static const int kFirstColorByte = 1;	//依次为 R、G、B
+static const int kColorBandOrder[3] = { 1, 2, 3 };
+#endif
+
+// 全部栅格图层共享的瓦片缓存，成本单位为 KB
+static QCache<QString, QImage>& tileCache() {
+	static QCache<QString, QImage> cache(256 * 1024);
+	return cache;
+}
+
+// 瓦片解码专用线程池，避免占用全局线程池
+static QThreadPool* tilePool() {
+	static QThreadPool pool;
+	return &pool;
+}
+
+// 坡向着色表：每度一个颜色，色相 0°（北）为红色，顺时针经黄、绿、青、蓝
+static const QRgb* aspectColors() {
+	static const std::vector<QRgb> colors = [] {
+		std::vector<QRgb> table(360);
+		for (int degree = 0; degree < 360; ++degree) {
+			table[degree] = QColor::fromHsv(degree, 200, 230).rgb();
+		}
+		return table;
+	}();
+	return colors.data();
+}
+
+// 瓦片像素的收尾：expandGray 时把蓝色通道的灰度复制到红、绿通道；premultiply 时颜色乘以 alpha / 255。
+// SSE2 每次处理 4 个像素，其余像素与不支持 SSE2 的平台逐个处理
+static void finishPixels(QRgb* pixels, int count, bool expandGray, bool premultiply) {
+	int x = 0;
+#ifdef YGIS_HAS_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lowByte = _mm_set1_epi32(0xFF);
+	const __m128i alphaBits = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+	const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);	//展开为 16 位后 alpha 所在的通道
+	const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);	//alpha 自身乘以 255 / 255，保持不变
+	const __m128i rounding = _mm_set1_epi16(128);
+	// x * a / 255 取整：t = x * a + 128，结果为 (t + (t >> 8)) >> 8
+	auto multiply = [&](__m128i channels) {
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), alphaOne);
+		const __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), rounding);
+		return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+	};
+	for (; x + 4 <= count; x += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+		if (expandGray) {
+			const __m128i gray = _mm_and_si128(v, lowByte);
+			v = _mm_or_si128(_mm_and_si128(v, alphaBits),
+				_mm_or_si128(gray, _mm_or_si128(_mm_slli_epi32(gray, 8), _mm_slli_epi32(gray, 16))));
+		}
+		if (premultiply) {
+			v = _mm_packus_epi16(multiply(_mm_unpacklo_epi8(v, zero)), multiply(_mm_unpackhi_epi8(v, zero)));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x), v);
+	}
+#endif
+	for (; x < count; ++x) {
+		QRgb pixel = pixels[x];
+		if (expandGray) {
+			const uint gray = pixel & 0xFF;
+			pixel = (pixel & 0xFF000000u) | (gray << 16) | (gray << 8) | gray;
+		}
+		if (premultiply) {
+			const uint alpha = qAlpha(pixel);
+			auto channel = [alpha](uint value) {
+				const uint t = value * alpha + 128;
+				return (t + (t >> 8)) >> 8;
+			};
+			pixel = qRgba(channel(qRed(pixel)), channel(qGreen(pixel)), channel(qBlue(pixel)), alpha);
+		}
+		pixels[x] = pixel;
+	}
+}
+
+// Horn 3x3 核：由相邻三行高程计算一行的东向、北向坡度（dz/dx、dz/dy）。
+// 循环体没有分支，编译器可以向量化；任一邻域像元为 NaN（NoData）时结果为 NaN
+static void hornGradient(const float* above, const float* row, const float* below, int width,
+	float inverseWidth8, float inverseHeight8, float* dzdx, float* dzdy) {
+	for (int x = 0; x < width; ++x) {
+		const float a = above[x], b = above[x + 1], c = above[x + 2];
+		const float d = row[x], f = row[x + 2];
+		const float g = below[x], h = below[x + 1], i = below[x + 2];
+		dzdx[x] = ((c + 2.0f * f + i) - (a + 2.0f * d + g)) * inverseWidth8;
+		dzdy[x] = ((a + 2.0f * b + c) - (g + 2.0f * h + i)) * inverseHeight8;
+	}
+}
+
+RasterLayerItem::RasterLayerItem(const QString& filePath, QGraphicsItem* parent)
+	: QGraphicsObject(parent), m_filePath(filePath), m_width(0), m_height(0),
+	m_renderMode(Normal), m_blendMode(BlendNormal), m_minValue(0.0), m_maxValue(255.0) {
+	setData(0, filePath);
+	setFlag(QGraphicsItem::ItemUsesExtendedStyleOption); // paint 中需要 exposedRect 计算可见瓦片
+	for (double& v : m_geoTransform) v = 0.0;
+}
+
+RasterLayerItem::~RasterLayerItem() {
+	// 未开始的解码任务直接取消，watcher 随对象一起释放
+	for (const T_PendingTile& tile : m_pending) {
+		tile.watcher->cancel();
+	}
+}
+
+void RasterLayerItem::setTileCacheSize(int megabytes) {
+	tileCache().setMaxCost(megabytes * 1024);
+}
+
+void RasterLayerItem::dropCachedTiles(const QString& filePath) {
+	const QString prefix = filePath + '|';
+	for (const QString& key : tileCache().keys()) {
+		if (key.startsWith(prefix)) tileCache().remove(key);
+	}
+}
+
+int RasterLayerItem::saveCachedTiles(const QString& dir) const {
+	if (!QDir().mkpath(dir)) return 0;
+
+	// 在主线程取出该图层的缓存瓦片（QImage 隐式共享，不复制像素），再在线程池中并行编码
+	const QString prefix = m_filePath + '|';
+	QList<QPair<QString, QImage>> tiles;
+	for (const QString& key : tileCache().keys()) {
+		if (!key.startsWith(prefix)) continue;
+		const QStringList parts = key.mid(prefix.size()).split('|');
+		if (parts.size() != 3) continue;
+		const QString path = QDir(dir).filePath(tileFileName(parts[0].toInt(), parts[1].toInt(), parts[2].toInt()));
+		if (QFileInfo::exists(path)) continue;	//目录有效时已有的瓦片与内存中的一致
+		tiles.append({ path, *tileCache().object(key) });
+	}
+
+	// 经临时文件写入，正在从该目录读瓦片的图层不会读到半个文件
+	std::atomic<int> saved(0);
+	QtConcurrent::blockingMap(tilePool(), tiles, [&saved](const QPair<QString, QImage>& tile) {
+		QSaveFile file(tile.first);
+		if (file.open(QIODevice::WriteOnly) && tile.second.save(&file, "PNG") && file.commit()) ++saved;
+		});
+	return saved.load();
+}
+
+bool RasterLayerItem::open() {
+	ProfileScope scope(m_filePath, RenderProfiler::LoadStage);
+	DatasetHandle dataset = DatasetPool::instance().acquire(m_filePath);
+	if (!dataset) {
+		qDebug() << "GDAL打开失败：" << m_filePath;
+		return false;
+	}
+
+	const int width = dataset->GetRasterXSize();
+	const int height = dataset->GetRasterYSize();
+	if (dataset->GetRasterCount() < 1 || width <= 0 || height <= 0) {
+		qDebug() << "无效的图像：" << m_filePath << width << "x" << height;
+		return false;
+	}
+
+	GDALRasterBand* band = dataset->GetRasterBand(1);
+	const GDALDataType dataType = band->GetRasterDataType();
+	if (GDALDataTypeIsComplex(dataType)) {
+		qDebug() << "不支持的数据类型：" << GDALGetDataTypeName(dataType) << m_filePath;
+		return false;
+	}
+
+	// 8、16 位以外（浮点 DEM 等）按近似统计范围拉伸，优先用扫描时已算好的统计值
+	if (dataType != GDT_Byte && dataType != GDT_UInt16) {
+		T_LayerMetadata metadata;
+		double minValue = 0.0;
+		double maxValue = 0.0;
+		if (LayerMetadata::cached(m_filePath, metadata) && !metadata.bands.isEmpty() && metadata.bands[0].hasStatistics) {
+			minValue = metadata.bands[0].minimum;
+			maxValue = metadata.bands[0].maximum;
+		}
+		else {
+			T_BandInfo info;
+			if (LayerMetadata::sampleStatistics(band, info)) {
+				minValue = info.minimum;
+				maxValue = info.maximum;
+			}
+		}
+		m_minValue = minValue;
+		m_maxValue = maxValue > minValue ? maxValue : minValue + 1.0;
+	}
+
+	// 无地理参考时按像素坐标显示（行号向下增大）
+	if (dataset->GetGeoTransform(m_geoTransform) != CE_None) {
+		const double identity[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, -1.0 };
+		std::copy(identity, identity + 6, m_geoTransform);
+	}
+
+	// 地形计算用的像元地面尺寸：地理坐标系按图幅中心纬度把度换算为米
+	double unitX = 1.0;
+	double unitY = 1.0;
+	OGRSpatialReference srs;
+	const char* wkt = dataset->GetProjectionRef();
+	if (wkt && wkt[0] && srs.importFromWkt(wkt) == OGRERR_NONE) {
+		if (srs.IsGeographic()) {
+			const double centerLatitude = m_geoTransform[3] + m_geoTransform[5] * height / 2.0;
+			unitY = 110574.0;
+			unitX = 111320.0 * std::cos(centerLatitude * kDegreeToRadian);
+		}
+		else {
+			unitX = unitY = srs.GetLinearUnits();
+		}
+	}
+	m_terrain.cellWidth = std::abs(m_geoTransform[1]) * unitX;
+	m_terrain.cellHeight = std::abs(m_geoTransform[5]) * unitY;
+	dataset.reset();
+
+	prepareGeometryChange();
+	m_width = width;
+	m_height = height;
+	m_bounds = windowToScene(QRect(0, 0, m_width, m_height));
+	return true;
+}
+
+void RasterLayerItem::setRenderMode(RenderMode mode) {
+	if (mode == m_renderMode) return;
+	// 原显示方式尚未完成的瓦片不再需要
+	for (const T_PendingTile& tile : m_pending) {
+		tile.watcher->cancel();
+	}
+	m_renderMode = mode;
+	m_terrain.mode = mode;
+	update();
+}
+
+void RasterLayerItem::setBlendMode(BlendMode mode) {
+	if (mode == m_blendMode) return;
+	m_blendMode = mode; // 只影响合成，缓存的瓦片照常使用
+	update();
+}
+
+QRectF RasterLayerItem::boundingRect() const {
+	return m_bounds;
+}
+
+QPointF RasterLayerItem::pixelToScene(double col, double row) const {
+	const double x = m_geoTransform[0] + col * m_geoTransform[1] + row * m_geoTransform[2];
+	const double y = m_geoTransform[3] + col * m_geoTransform[4] + row * m_geoTransform[5];
+	return QPointF(x, -y);
+}
+
+QPointF RasterLayerItem::sceneToPixel(const QPointF& scenePos) const {
+	// 忽略旋转项，按北向上图像求逆
+	const double col = (scenePos.x() - m_geoTransform[0]) / m_geoTransform[1];
+	const double row = (-scenePos.y() - m_geoTransform[3]) / m_geoTransform[5];
+	return QPointF(col, row);
+}
+
+QString RasterLayerItem::tileKey(int level, int tx, int ty) const {
+	// 地形瓦片的键带显示方式后缀，不会被当作普通瓦片写入工程缓存
+	const QString key = QString("%1|%2|%3|%4").arg(m_filePath).arg(level).arg(tx).arg(ty);
+	return m_renderMode == Normal ? key : key + QString("|m%1").arg(m_renderMode);
+}
+
+QString RasterLayerItem::tileFileName(int level, int tx, int ty) {
+	return QString("%1_%2_%3.png").arg(level).arg(tx).arg(ty);
+}
+
+QRect RasterLayerItem::tileWindow(int level, int tx, int ty) const {
+	const int span = TileSize << level;
+	const QRect window(tx * span, ty * span, span, span);
+	return window.intersected(QRect(0, 0, m_width, m_height));
+}
+
+QRectF RasterLayerItem::windowToScene(const QRect& window) const {
+	const QPointF topLeft = pixelToScene(window.x(), window.y());
+	const QPointF bottomRight = pixelToScene(window.x() + window.width(), window.y() + window.height());
+	return QRectF(topLeft, bottomRight).normalized();
+}
+
+int RasterLayerItem::maxLevel() const {
+	// 最粗一级整幅影像只需一块瓦片
+	int level = 0;
+	while ((std::max(m_width, m_height) >> level) > TileSize) ++level;
+	return level;
+}
+
+int RasterLayerItem::levelForScale(double lod) const {
+	// 每个设备像素覆盖的原始像素数，取不超过它的 2 的幂
+	const double pixelSize = std::abs(m_geoTransform[1]);
+	if (lod <= 0 || pixelSize <= 0) return 0;
+	const double sourcePerDevice = 1.0 / (lod * pixelSize);
+	int level = sourcePerDevice > 1.0 ? static_cast<int>(std::floor(std::log2(sourcePerDevice))) : 0;
+	return std::min(level, maxLevel());
+}
+
+void RasterLayerItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+	Q_UNUSED(widget);
+	ProfileScope scope(m_filePath, RenderProfiler::PaintStage);
+
+	const double lod = option->levelOfDetailFromTransform(painter->worldTransform());
+	const int level = levelForScale(lod);
+	cancelStaleRequests(level);
+
+	const QRectF exposed = option->exposedRect.intersected(m_bounds);
+	if (exposed.isEmpty()) return;
+
+	// 与下层的混合在合成瓦片时由绘制引擎逐瓦片完成（透明度由 QGraphicsItem::setOpacity 给出），不生成整幅中间图像
+	static const QPainter::CompositionMode compositionModes[] = {
+		QPainter::CompositionMode_SourceOver, QPainter::CompositionMode_Multiply, QPainter::CompositionMode_Screen,
+		QPainter::CompositionMode_Overlay, QPainter::CompositionMode_Darken, QPainter::CompositionMode_Lighten
+	};
+	painter->save();
+	painter->setCompositionMode(compositionModes[m_blendMode]);
+
+	// 暴露区域换算为瓦片行列范围
+	const QRectF pixelRect = QRectF(sceneToPixel(exposed.topLeft()), sceneToPixel(exposed.bottomRight())).normalized();
+	const int span = TileSize << level;
+	const int tx0 = std::max(0, static_cast<int>(std::floor(pixelRect.left() / span)));
+	const int ty0 = std::max(0, static_cast<int>(std::floor(pixelRect.top() / span)));
+	const int tx1 = std::min((m_width - 1) / span, static_cast<int>(std::floor(pixelRect.right() / span)));
+	const int ty1 = std::min((m_height - 1) / span, static_cast<int>(std::floor(pixelRect.bottom() / span)));
+
+	for (int ty = ty0; ty <= ty1; ++ty) {
+		for (int tx = tx0; tx <= tx1; ++tx) {
+			const QImage* image = tileCache().object(tileKey(level, tx, ty));
+			RenderProfiler::instance().recordCacheLookup(image != nullptr);
+			if (image) {
+				painter->drawImage(windowToScene(tileWindow(level, tx, ty)), *image);
+			}
+			else {
+				drawFallback(painter, level, tx, ty);
+				requestTile(level, tx, ty);
+			}
+		}
+	}
+	painter->restore();
+}
+
+bool RasterLayerItem::drawFallback(QPainter* painter, int level, int tx, int ty) const {
+	// 依次查找更粗级别中覆盖该瓦片的缓存，截取对应部分放大绘制
+	const QRect window = tileWindow(level, tx, ty);
+	const int topLevel = maxLevel();
+	for (int parentLevel = level + 1; parentLevel <= std::min(level + 4, topLevel); ++parentLevel) {
+		const int shift = parentLevel - level;
+		const QImage* image = tileCache().object(tileKey(parentLevel, tx >> shift, ty >> shift));
+		if (!image) continue;
+
+		const QRect parentWindow = tileWindow(parentLevel, tx >> shift, ty >> shift);
+		const double factor = 1 << parentLevel;
+		const QRectF source((window.x() - parentWindow.x()) / factor, (window.y() - parentWindow.y()) / factor,
+			window.width() / factor, window.height() / factor);
+		painter->drawImage(windowToScene(window), *image, source);
+		return true;
+	}
+	return false;
+}
+
+void RasterLayerItem::requestTile(int level, int tx, int ty) {
+	const QString key = tileKey(level, tx, ty);
+	if (m_pending.contains(key)) return;
+
+	const QString filePath = m_filePath;
+	const QRect window = tileWindow(level, tx, ty);
+	const int factor = 1 << level;
+	const QSize bufSize((window.width() + factor - 1) / factor, (window.height() + factor - 1) / factor);
+	const QString diskTile = m_diskCacheDir.isEmpty() || m_renderMode != Normal ? QString()
+		: QDir(m_diskCacheDir).filePath(tileFileName(level, tx, ty));
+	const bool isTerrain = m_renderMode != Normal;
+	const T_TerrainParams terrain = m_terrain;
+	const double minValue = m_minValue;
+	const double maxValue = m_maxValue;
+
+	auto* watcher = new QFutureWatcher<QImage>(this);
+	connect(watcher, &QFutureWatcher<QImage>::finished, this, [=] {
+		m_pending.remove(key);
+		if (!watcher->isCanceled() && watcher->future().resultCount() > 0) {
+			const QImage image = watcher->result();
+			if (!image.isNull()) {
+				tileCache().insert(key, new QImage(image), std::max<qsizetype>(1, image.sizeInBytes() / 1024));
+			}
+		}
+		update(windowToScene(window)); // 取消的瓦片也刷新一次，回到该级别时会重新请求
+		watcher->deleteLater();
+		});
+
+	// GDAL 数据集句柄不能跨线程共享：数据集池为每个工作线程保留一份，线程复用时不必重新打开
+	watcher->setFuture(QtConcurrent::run(tilePool(), [filePath, window, bufSize, diskTile, isTerrain, terrain, minValue, maxValue](QPromise<QImage>& promise) {
+		if (promise.isCanceled()) return;
+		// 工程缓存中已有这块瓦片时不必读取源文件
+		if (!diskTile.isEmpty()) {
+			const QImage image = QImage(diskTile).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+			if (!image.isNull()) {
+				promise.addResult(image);
+				return;
+			}
+		}
+		RenderProfiler::instance().beginIo();
+		if (DatasetHandle dataset = DatasetPool::instance().acquire(filePath)) {
+			promise.addResult(isTerrain ? decodeTerrain(dataset.get(), window, bufSize, terrain)
+				: decodeTile(dataset.get(), window, bufSize, minValue, maxValue));
+		}
+		RenderProfiler::instance().endIo();
+		}));
+	m_pending.insert(key, T_PendingTile{ level, watcher });
+}
+
+void RasterLayerItem::cancelStaleRequests(int level) {
+	// 视图级别变化后，尚未开始的旧级别瓦片不再需要
+	for (const T_PendingTile& tile : m_pending) {
+		if (tile.level != level) tile.watcher->cancel();
+	}
+}
+
+QImage RasterLayerItem::decodeTile(GDALDataset* dataset, const QRect& srcWindow, const QSize& bufSize,
+	double minValue, double maxValue) {
+	const int bandCount = dataset->GetRasterCount();
+	if (bandCount < 1 || bufSize.isEmpty()) return QImage();
+
+	const int width = bufSize.width();
+	const int height = bufSize.height();
+	GDALRasterBand* band1 = dataset->GetRasterBand(1);
+	const GDALDataType dataType = band1->GetRasterDataType();
+
+	// 三个波段类型一致时按 RGB 处理，否则按第一波段灰度处理
+	bool isRGB = bandCount >= 3 &&
+		dataset->GetRasterBand(2)->GetRasterDataType() == dataType &&
+		dataset->GetRasterBand(3)->GetRasterDataType() == dataType;
+
+	// 瓦片统一为预乘 ARGB32：颜色与 alpha 直接写入像素的对应字节，合成时不再转换格式
+	QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+	uchar* bits = image.bits();
+	const GSpacing lineSpace = image.bytesPerLine();
+	const int channels = isRGB ? 3 : 1;
+	int bandMap[3] = { 1, 2, 3 };
+	const QString layer = QString::fromUtf8(dataset->GetDescription());
+
+	// NoData、掩膜波段、alpha 波段统一由 GDAL 的掩膜给出，先写入 alpha 字节，颜色写入时保留
+	const bool masked = !(band1->GetMaskFlags() & GMF_ALL_VALID);
+	bool hasAlpha = false;
+	if (masked) {
+		ProfileScope scope(layer, RenderProfiler::DecodeStage);
+		hasAlpha = band1->GetMaskBand()->RasterIO(GF_Read, srcWindow.x(), srcWindow.y(), srcWindow.width(), srcWindow.height(),
+			bits + kAlphaByte, width, height, GDT_Byte, 4, lineSpace, nullptr) == CE_None;
+	}
+	if (!hasAlpha) image.fill(0xFF000000u);
+
+	// 缓冲区小于窗口时 GDAL 会自动选用合适的概视图
+	if (dataType == GDT_UInt16) { // 16位取高 8 位
+		std::vector<uint16_t> buffer(static_cast<size_t>(width) * height * channels);
+		{
+			ProfileScope scope(layer, RenderProfiler::DecodeStage);
+			if (dataset->RasterIO(GF_Read, srcWindow.x(), srcWindow.y(), srcWindow.width(), srcWindow.height(),
+				buffer.data(), width, height, GDT_UInt16, channels, bandMap,
+				channels * sizeof(uint16_t), static_cast<GSpacing>(width) * channels * sizeof(uint16_t), sizeof(uint16_t), nullptr) != CE_None) {
+				return QImage();
+			}
+		}
+		ProfileScope scope(layer, RenderProfiler::ConvertStage);
+		for (int y = 0; y < height; ++y) {
+			QRgb* pixels = reinterpret_cast<QRgb*>(image.scanLine(y));
+			const uint16_t* src = buffer.data() + static_cast<size_t>(y) * width * channels;
+			for (int x = 0; x < width; ++x, src += channels) {
+				const uint rgb = isRGB ? (uint(src[0] >> 8) << 16) | (uint(src[1] >> 8) << 8) | uint(src[2] >> 8) : uint(src[0] >> 8) * 0x010101u;
+				pixels[x] = (pixels[x] & 0xFF000000u) | rgb;
+			}
+		}
+	}
+	else if (dataType != GDT_Byte) { // 其他类型按浮点读取后线性拉伸，NaN 透明
+		std::vector<float> buffer(static_cast<size_t>(width) * height * channels);
+		{
+			ProfileScope scope(layer, RenderProfiler::DecodeStage);
+			if (dataset->RasterIO(GF_Read, srcWindow.x(), srcWindow.y(), srcWindow.width(), srcWindow.height(),
+				buffer.data(), width, height, GDT_Float32, channels, bandMap,
+				channels * sizeof(float), static_cast<GSpacing>(width) * channels * sizeof(float), sizeof(float), nullptr) != CE_None) {
+				return QImage();
+			}
+		}
+		ProfileScope scope(layer, RenderProfiler::ConvertStage);
+		const float offset = static_cast<float>(minValue);
+		const float scale = static_cast<float>(255.0 / (maxValue - minValue));
+		auto stretch = [offset, scale](float value) {
+			return static_cast<uint>(std::min(255.0f, std::max(0.0f, (value - offset) * scale)));
+		};
+		for (int y = 0; y < height; ++y) {
+			QRgb* pixels = reinterpret_cast<QRgb*>(image.scanLine(y));
+			const float* src = buffer.data() + static_cast<size_t>(y) * width * channels;
+			for (int x = 0; x < width; ++x, src += channels) {
+				if (src[0] != src[0]) {	//NaN 与自身不等
+					pixels[x] = 0;
+					continue;
+				}
+				const uint rgb = isRGB ? (stretch(src[0]) << 16) | (stretch(src[1]) << 8) | stretch(src[2]) : stretch(src[0]) * 0x010101u;
+				pixels[x] = (pixels[x] & 0xFF000000u) | rgb;
+			}
+		}
+	}
+	else { // 8位按 B、G、R 字节位置直接交错读入图像内存；灰度只写蓝色字节，之后复制
+		ProfileScope scope(layer, RenderProfiler::DecodeStage);
+		int bgrMap[3] = { kColorBandOrder[0], kColorBandOrder[1], kColorBandOrder[2] };
+		if (dataset->RasterIO(GF_Read, srcWindow.x(), srcWindow.y(), srcWindow.width(), srcWindow.height(),
+			bits + (isRGB ? kFirstColorByte : kBlueByte), width, height, GDT_Byte, channels, isRGB ? bgrMap : bandMap,
+			4, lineSpace, 1, nullptr) != CE_None) {
+			return QImage();
+		}
+	}
+
+	// 8 位灰度复制到红、绿通道（16 位、浮点在转换循环中已写入三个通道），有掩膜时预乘 alpha
+	const bool expandGray = !isRGB && dataType == GDT_Byte;
+	if (expandGray || hasAlpha) {
+		ProfileScope scope(layer, RenderProfiler::ConvertStage);
+		for (int y = 0; y < height; ++y) {
+			finishPixels(reinterpret_cast<QRgb*>(image.scanLine(y)), width, expandGray, hasAlpha);
+		}
+	}
+	return image;
+}
+
+QImage RasterLayerItem::decodeTerrain(GDALDataset* dataset, const QRect& srcWindow, const QSize& bufSize, const T_TerrainParams& params) {
+	if (dataset->GetRasterCount() < 1 || bufSize.isEmpty()) return QImage();
+	GDALRasterBand* band = dataset->GetRasterBand(1);
+	const int width = bufSize.width();
+	const int height = bufSize.height();
+	const QString layer = QString::fromUtf8(dataset->GetDescription());
+
+	// 四周各多读一个输出像素，相邻瓦片的边缘像元用到的邻域一致，拼接处没有接缝；
+	// 栅格边界外没有数据，复制边缘像元
+	const double scaleX = static_cast<double>(srcWindow.width()) / width;
+	const double scaleY = static_cast<double>(srcWindow.height()) / height;
+	const int haloX = std::max(1, static_cast<int>(std::lround(scaleX)));
+	const int haloY = std::max(1, static_cast<int>(std::lround(scaleY)));
+	const int left = srcWindow.x() >= haloX ? 1 : 0;
+	const int top = srcWindow.y() >= haloY ? 1 : 0;
+	const int right = srcWindow.x() + srcWindow.width() + haloX <= dataset->GetRasterXSize() ? 1 : 0;
+	const int bottom = srcWindow.y() + srcWindow.height() + haloY <= dataset->GetRasterYSize() ? 1 : 0;
+	const int readWidth = width + left + right;
+	const int readHeight = height + top + bottom;
+
+	const int paddedWidth = width + 2;
+	std::vector<float> elevation(static_cast<size_t>(paddedWidth) * (height + 2));
+	{
+		ProfileScope scope(layer, RenderProfiler::DecodeStage);
+		float* origin = elevation.data() + static_cast<size_t>(1 - top) * paddedWidth + (1 - left);
+		if (band->RasterIO(GF_Read, srcWindow.x() - left * haloX, srcWindow.y() - top * haloY,
+			srcWindow.width() + (left + right) * haloX, srcWindow.height() + (top + bottom) * haloY,
+			origin, readWidth, readHeight, GDT_Float32, sizeof(float), static_cast<GSpacing>(paddedWidth) * sizeof(float), nullptr) != CE_None) {
+			return QImage();
+		}
+	}
+
+	ProfileScope scope(layer, RenderProfiler::ConvertStage);
+	auto line = [&](int y) { return elevation.data() + static_cast<size_t>(y) * paddedWidth; };
+	if (!left) for (int y = 0; y < height + 2; ++y) line(y)[0] = line(y)[1];
+	if (!right) for (int y = 0; y < height + 2; ++y) line(y)[width + 1] = line(y)[width];
+	if (!top) std::copy(line(1), line(1) + paddedWidth, line(0));
+	if (!bottom) std::copy(line(height), line(height) + paddedWidth, line(height + 1));
+
+	// NoData 换成 NaN，核函数中自然传播，不必逐像元判断
+	int hasNoData = FALSE;
+	const float noData = static_cast<float>(band->GetNoDataValue(&hasNoData));
+	if (hasNoData) {
+		for (float& value : elevation) {
+			if (value == noData) value = std::numeric_limits<float>::quiet_NaN();
+		}
+	}
+
+	// 降采样显示时一个输出像素覆盖 scale 个源像元
+	const float inverseWidth8 = static_cast<float>(params.zFactor / (8.0 * params.cellWidth * scaleX));
+	const float inverseHeight8 = static_cast<float>(params.zFactor / (8.0 * params.cellHeight * scaleY));
+	const float azimuth = static_cast<float>(params.azimuth * kDegreeToRadian);
+	const float altitude = static_cast<float>(params.altitude * kDegreeToRadian);
+	const float lightUp = std::sin(altitude);
+	const float lightEast = std::cos(altitude) * std::sin(azimuth);
+	const float lightNorth = std::cos(altitude) * std::cos(azimuth);
+	const float radianToDegree = static_cast<float>(1.0 / kDegreeToRadian);
+	const QRgb* aspectTable = aspectColors();
+
+	QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+	std::vector<float> dzdx(width);
+	std::vector<float> dzdy(width);
+	std::vector<float> shade(width);
+	for (int y = 0; y < height; ++y) {
+		hornGradient(line(y), line(y + 1), line(y + 2), width, inverseWidth8, inverseHeight8, dzdx.data(), dzdy.data());
+		QRgb* pixels = reinterpret_cast<QRgb*>(image.scanLine(y));
+
+		if (params.mode == Aspect) {
+			for (int x = 0; x < width; ++x) {
+				const float p = dzdx[x];
+				const float q = dzdy[x];
+				if (!(p == p && q == q)) pixels[x] = 0;
+				else if (p == 0.0f && q == 0.0f) pixels[x] = qRgb(160, 160, 160);
+				else {
+					// 下坡方向 (-p, -q) 自北顺时针的角度
+					float degree = std::atan2(-p, -q) * radianToDegree;
+					if (degree < 0.0f) degree += 360.0f;
+					pixels[x] = aspectTable[static_cast<int>(degree) % 360];
+				}
+			}
+			continue;
+		}
+
+		if (params.mode == Slope) {
+			for (int x = 0; x < width; ++x) {
+				shade[x] = 1.0f - std::atan(std::sqrt(dzdx[x] * dzdx[x] + dzdy[x] * dzdy[x])) * (2.0f / 3.14159265f);
+			}
+		}
+		else {
+			// 法向量 (-p, -q, 1) 与光源方向的夹角余弦
+			for (int x = 0; x < width; ++x) {
+				const float p = dzdx[x];
+				const float q = dzdy[x];
+				shade[x] = (lightUp - p * lightEast - q * lightNorth) / std::sqrt(1.0f + p * p + q * q);
+			}
+		}
+		for (int x = 0; x < width; ++x) {
+			const float value = shade[x];
+			const int gray = static_cast<int>(std::min(1.0f, std::max(0.0f, value)) * 255.0f + 0.5f);
+			pixels[x] = value == value ? qRgb(gray, gray, gray) : 0;	//NaN 与自身不等
+		}
+	}
+	return image;
+}
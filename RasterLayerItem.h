@@ -0,0 +1,103 @@
+#pragma once
+#include <QGraphicsObject>
+#include <QHash>
+#include <QImage>
+#include <QFutureWatcher>
+
+class GDALDataset;
+
+// 栅格图层图形项：按视图比例选择金字塔级别，只读取可见范围内的瓦片，
+// 瓦片在线程池中异步解码并放入全局缓存，加载完成前用上一级缓存瓦片放大代替。
+// 单波段 DEM 可以切换为地形显示，山体阴影、坡度、坡向在解码瓦片时实时计算
+class RasterLayerItem : public QGraphicsObject {
+	Q_OBJECT
+public:
+	enum { Type = UserType + 2 };
+	static const int TileSize = 256;	//瓦片边长（输出像素）
+
+	enum RenderMode {
+		Normal,	//灰度 / RGB；8、16 位以外的数据按统计范围拉伸
+		Hillshade,	//山体阴影
+		Slope,	//坡度，平地白、陡坡黑
+		Aspect	//坡向，按色相环着色，平地灰色
+	};
+
+	// 与下层图层的混合方式
+	enum BlendMode {
+		BlendNormal,	//覆盖
+		BlendMultiply,	//正片叠底，常用于山体阴影叠加在影像上
+		BlendScreen,	//滤色
+		BlendOverlay,	//叠加
+		BlendDarken,	//变暗
+		BlendLighten	//变亮
+	};
+
+	// 地形计算参数
+	struct T_TerrainParams {
+		RenderMode mode = Hillshade;
+		double cellWidth = 1.0;	//源像元的地面宽度（米）
+		double cellHeight = 1.0;	//源像元的地面高度（米）
+		double zFactor = 1.0;	//高程单位换算为米的系数
+		double azimuth = 315.0;	//光源方位角（度，自北顺时针）
+		double altitude = 45.0;	//光源高度角（度）
+	};
+
+	explicit RasterLayerItem(const QString& filePath, QGraphicsItem* parent = nullptr);
+	~RasterLayerItem() override;
+
+	bool open();	//只读取头信息（尺寸、地理变换），不读像素
+
+	int type() const override { return Type; }
+	QRectF boundingRect() const override;
+	void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+	QString filePath() const { return m_filePath; }
+	RenderMode renderMode() const { return m_renderMode; }
+	void setRenderMode(RenderMode mode);	//各显示方式的瓦片分别缓存，切换回来时不必重新计算
+	BlendMode blendMode() const { return m_blendMode; }
+	void setBlendMode(BlendMode mode);	//透明度使用 QGraphicsItem::setOpacity
+	QPointF pixelToScene(double col, double row) const;
+	QPointF sceneToPixel(const QPointF& scenePos) const;
+
+	void setDiskCacheDirectory(const QString& dir) { m_diskCacheDir = dir; }	//工程缓存中的瓦片目录，优先于读取源文件
+	int saveCachedTiles(const QString& dir) const;	//把内存中该图层、目录里还没有的瓦片写入目录，返回写入数
+
+	// 读取窗口并转换为预乘 ARGB32；8、16 位以外的数据按 [minValue, maxValue] 线性拉伸为灰度。
+	// NoData、掩膜波段与 alpha 波段处透明
+	static QImage decodeTile(GDALDataset* dataset, const QRect& srcWindow, const QSize& bufSize,
+		double minValue = 0.0, double maxValue = 255.0);
+	// 读取窗口及外围一个输出像素的边缘，对第一波段做 3x3 地形计算；NoData 处透明
+	static QImage decodeTerrain(GDALDataset* dataset, const QRect& srcWindow, const QSize& bufSize, const T_TerrainParams& params);
+	static void setTileCacheSize(int megabytes);
+	static void dropCachedTiles(const QString& filePath);	//文件内容变化后丢弃其缓存瓦片
+
+private:
+	// 正在加载的瓦片
+	struct T_PendingTile {
+		int level;
+		QFutureWatcher<QImage>* watcher;
+	};
+
+	QString tileKey(int level, int tx, int ty) const;
+	static QString tileFileName(int level, int tx, int ty);
+	QRect tileWindow(int level, int tx, int ty) const;	//瓦片对应的原始像素窗口
+	QRectF windowToScene(const QRect& window) const;
+	int maxLevel() const;
+	int levelForScale(double lod) const;
+	bool drawFallback(QPainter* painter, int level, int tx, int ty) const;
+	void requestTile(int level, int tx, int ty);
+	void cancelStaleRequests(int level);
+
+	QString m_filePath;
+	int m_width;
+	int m_height;
+	double m_geoTransform[6];
+	QRectF m_bounds;	//场景坐标下的图层范围
+	QString m_diskCacheDir;
+	QHash<QString, T_PendingTile> m_pending;
+	RenderMode m_renderMode;
+	BlendMode m_blendMode;
+	double m_minValue;	//拉伸显示的统计范围
+	double m_maxValue;
+	T_TerrainParams m_terrain;
+};
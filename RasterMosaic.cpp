@@ -0,0 +1,52 @@
+#include "RasterMosaic.h"
+#include <QByteArray>
+#include <QFile>
+#include <algorithm>
+#include <vector>
+#include <gdal_priv.h>
+#include <gdal_utils.h>
+#include "DatasetPool.h"
+
+QString RasterMosaic::buildVrt(const QStringList& sourcePaths, const QString& vrtPath, bool buildOverviews) {
+	if (sourcePaths.isEmpty()) return "没有输入文件";
+
+	// 按文件名传入，GDALBuildVRT 只读取各源文件的头信息，不会让它们保持打开
+	std::vector<QByteArray> names;
+	std::vector<const char*> nameList;
+	names.reserve(sourcePaths.size());
+	for (const QString& path : sourcePaths) {
+		names.push_back(path.toUtf8());
+		nameList.push_back(names.back().constData());
+	}
+
+	// 覆盖旧镶嵌时，连同旧的外部金字塔和池中的句柄一起丢弃
+	DatasetPool::instance().invalidate(vrtPath);
+	QFile::remove(vrtPath + ".ovr");
+
+	int usageError = FALSE;
+	GDALDatasetH vrt = GDALBuildVRT(vrtPath.toUtf8().constData(), static_cast<int>(nameList.size()),
+		nullptr, nameList.data(), nullptr, &usageError);
+	if (!vrt) {
+		return QString("生成 VRT 失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+	}
+
+	if (buildOverviews) {
+		// 逐级减半，直到整幅影像缩小到一块瓦片
+		const int size = std::max(GDALGetRasterXSize(vrt), GDALGetRasterYSize(vrt));
+		std::vector<int> levels;
+		for (int factor = 2; size / factor >= 256; factor *= 2) levels.push_back(factor);
+		if (!levels.empty()) {
+			CPLSetThreadLocalConfigOption("COMPRESS_OVERVIEW", "DEFLATE");
+			const CPLErr err = GDALBuildOverviews(vrt, "AVERAGE", static_cast<int>(levels.size()), levels.data(),
+				0, nullptr, GDALDummyProgress, nullptr);
+			CPLSetThreadLocalConfigOption("COMPRESS_OVERVIEW", nullptr);
+			if (err != CE_None) {
+				GDALClose(vrt);
+				return QString("生成金字塔失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+			}
+		}
+	}
+
+	GDALClose(vrt);
+	return QString();
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+
+// 虚拟镶嵌：把一组相邻栅格拼成一个 GDAL VRT。VRT 只记录各源文件的位置，
+// 读取时只打开与请求窗口相交的源文件，同时打开的源文件数受 GDAL_MAX_DATASET_POOL_SIZE 限制
+namespace RasterMosaic {
+	// 生成 VRT；buildOverviews 为真时同时生成外部金字塔（.vrt.ovr），缩小显示时不必读取每个源文件。
+	// 成功返回空字符串，否则返回错误信息。耗时较长，应在后台线程调用
+	QString buildVrt(const QStringList& sourcePaths, const QString& vrtPath, bool buildOverviews);
+}
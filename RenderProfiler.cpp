@@ -0,0 +1,214 @@
+#include "RenderProfiler.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <gdal.h>
+
+namespace {
+	const int kFrameHistory = 120;	//统计最近 120 帧
+	const int kMaxTraceEvents = 200000;	//跟踪事件上限，超出后覆盖最旧的
+	const char* kStageNames[RenderProfiler::StageCount] = { "load", "decode", "convert", "paint" };
+	const char* kStageLabels[RenderProfiler::StageCount] = { "加载", "解码", "转换", "绘制" };
+
+	double toMs(qint64 ns) {
+		return ns / 1.0e6;
+	}
+}
+
+RenderProfiler& RenderProfiler::instance() {
+	static RenderProfiler profiler;
+	return profiler;
+}
+
+RenderProfiler::RenderProfiler()
+	: m_enabled(false), m_inFlightIo(0), m_cacheHits(0), m_cacheMisses(0),
+	m_frameCursor(0), m_eventCursor(0) {
+	m_clock.start();
+}
+
+void RenderProfiler::setEnabled(bool enabled) {
+	m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 RenderProfiler::now() const {
+	return m_clock.nsecsElapsed();
+}
+
+void RenderProfiler::appendEvent(const T_TraceEvent& event) {
+	if (m_events.size() < kMaxTraceEvents) {
+		m_events.append(event);
+	}
+	else {
+		m_events[m_eventCursor] = event;
+		m_eventCursor = (m_eventCursor + 1) % kMaxTraceEvents;
+	}
+}
+
+void RenderProfiler::record(const QString& layer, Stage stage, qint64 startNs, qint64 durationNs) {
+	if (!isEnabled()) return;
+
+	const quint64 threadId = static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+	QMutexLocker locker(&m_mutex);
+	T_StageStats& stats = m_layers[layer].stages[stage];
+	stats.count++;
+	stats.totalNs += durationNs;
+	stats.maxNs = std::max(stats.maxNs, durationNs);
+	appendEvent(T_TraceEvent{ layer, stage, startNs, durationNs, threadId });
+}
+
+void RenderProfiler::recordFrame(qint64 startNs, qint64 durationNs) {
+	if (!isEnabled()) return;
+
+	const quint64 threadId = static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+	QMutexLocker locker(&m_mutex);
+	if (m_frameTimes.size() < kFrameHistory) {
+		m_frameTimes.append(durationNs);
+	}
+	else {
+		m_frameTimes[m_frameCursor] = durationNs;
+		m_frameCursor = (m_frameCursor + 1) % kFrameHistory;
+	}
+	appendEvent(T_TraceEvent{ QString(), -1, startNs, durationNs, threadId });
+}
+
+void RenderProfiler::recordCacheLookup(bool hit) {
+	if (!isEnabled()) return;
+	(hit ? m_cacheHits : m_cacheMisses).fetch_add(1, std::memory_order_relaxed);
+}
+
+void RenderProfiler::beginIo() {
+	m_inFlightIo.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RenderProfiler::endIo() {
+	m_inFlightIo.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void RenderProfiler::reset() {
+	QMutexLocker locker(&m_mutex);
+	m_layers.clear();
+	m_frameTimes.clear();
+	m_frameCursor = 0;
+	m_events.clear();
+	m_eventCursor = 0;
+	m_cacheHits = 0;
+	m_cacheMisses = 0;
+}
+
+QString RenderProfiler::summary() const {
+	QMutexLocker locker(&m_mutex);
+	QStringList lines;
+
+	// 帧时间
+	if (!m_frameTimes.isEmpty()) {
+		qint64 total = 0;
+		qint64 worst = 0;
+		for (qint64 t : m_frameTimes) {
+			total += t;
+			worst = std::max(worst, t);
+		}
+		const double average = toMs(total) / m_frameTimes.size();
+		lines << QString("帧: 平均 %1 ms / 最大 %2 ms").arg(average, 0, 'f', 1).arg(toMs(worst), 0, 'f', 1);
+	}
+
+	// 瓦片缓存、GDAL 块缓存与 I/O
+	const qint64 hits = m_cacheHits.load();
+	const qint64 lookups = hits + m_cacheMisses.load();
+	if (lookups > 0) {
+		lines << QString("瓦片缓存命中率: %1% (%2/%3)").arg(100.0 * hits / lookups, 0, 'f', 1).arg(hits).arg(lookups);
+	}
+	lines << QString("GDAL 块缓存: %1 / %2 MB")
+		.arg(GDALGetCacheUsed64() / 1048576.0, 0, 'f', 1)
+		.arg(GDALGetCacheMax64() / 1048576.0, 0, 'f', 1);
+	lines << QString("进行中的 I/O: %1").arg(m_inFlightIo.load());
+
+	// 各图层按总耗时从高到低排列，最占帧预算的图层排在最前
+	QVector<QPair<qint64, QString>> order;
+	for (auto it = m_layers.constBegin(); it != m_layers.constEnd(); ++it) {
+		qint64 total = 0;
+		for (const T_StageStats& stats : it.value().stages) total += stats.totalNs;
+		order.append(qMakePair(total, it.key()));
+	}
+	std::sort(order.begin(), order.end(), [](const QPair<qint64, QString>& a, const QPair<qint64, QString>& b) {
+		return a.first > b.first;
+		});
+	for (const auto& entry : order) {
+		const T_LayerStats& layer = m_layers[entry.second];
+		QStringList parts;
+		for (int stage = 0; stage < StageCount; ++stage) {
+			const T_StageStats& stats = layer.stages[stage];
+			if (stats.count == 0) continue;
+			parts << QString("%1 %2").arg(kStageLabels[stage]).arg(toMs(stats.totalNs) / stats.count, 0, 'f', 2);
+		}
+		lines << QString("%1: %2 ms").arg(QFileInfo(entry.second).fileName(), parts.join(" | "));
+	}
+	return lines.join("\n");
+}
+
+bool RenderProfiler::writeTrace(const QString& filePath) const {
+	QJsonArray traceEvents;
+	QJsonObject layers;
+	{
+		QMutexLocker locker(&m_mutex);
+		for (const T_TraceEvent& event : m_events) {
+			QJsonObject object;
+			object["name"] = event.stage < 0 ? QString("frame") : QString(kStageNames[event.stage]);
+			object["cat"] = event.stage < 0 ? QString("frame") : QFileInfo(event.layer).fileName();
+			object["ph"] = "X";
+			object["ts"] = event.startNs / 1000.0;
+			object["dur"] = event.durationNs / 1000.0;
+			object["pid"] = 1;
+			object["tid"] = static_cast<double>(event.threadId);
+			if (event.stage >= 0) object["args"] = QJsonObject{ { "layer", event.layer } };
+			traceEvents.append(object);
+		}
+
+		for (auto it = m_layers.constBegin(); it != m_layers.constEnd(); ++it) {
+			QJsonObject stages;
+			for (int stage = 0; stage < StageCount; ++stage) {
+				const T_StageStats& stats = it.value().stages[stage];
+				if (stats.count == 0) continue;
+				stages[kStageNames[stage]] = QJsonObject{
+					{ "count", static_cast<double>(stats.count) },
+					{ "totalMs", toMs(stats.totalNs) },
+					{ "maxMs", toMs(stats.maxNs) }
+				};
+			}
+			layers[it.key()] = stages;
+		}
+	}
+
+	QJsonObject otherData;
+	otherData["layers"] = layers;
+	otherData["tileCacheHits"] = static_cast<double>(m_cacheHits.load());
+	otherData["tileCacheMisses"] = static_cast<double>(m_cacheMisses.load());
+	otherData["gdalCacheUsedBytes"] = static_cast<double>(GDALGetCacheUsed64());
+	otherData["gdalCacheMaxBytes"] = static_cast<double>(GDALGetCacheMax64());
+	otherData["inFlightIo"] = m_inFlightIo.load();
+
+	QJsonObject root;
+	root["traceEvents"] = traceEvents;
+	root["displayTimeUnit"] = "ms";
+	root["otherData"] = otherData;
+
+	QFile file(filePath);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+	file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+	return true;
+}
+
+ProfileScope::ProfileScope(const QString& layer, RenderProfiler::Stage stage)
+	: m_layer(layer), m_stage(stage), m_startNs(0), m_active(RenderProfiler::instance().isEnabled()) {
+	if (m_active) m_startNs = RenderProfiler::instance().now();
+}
+
+ProfileScope::~ProfileScope() {
+	if (!m_active) return;
+	RenderProfiler& profiler = RenderProfiler::instance();
+	profiler.record(m_layer, m_stage, m_startNs, profiler.now() - m_startNs);
+}
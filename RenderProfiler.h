@@ -0,0 +1,89 @@
+#pragma once
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <atomic>
+
+// 地图渲染性能统计：各图层加载/解码/转换/绘制耗时、帧时间、瓦片缓存命中率、
+// GDAL 块缓存占用与进行中的 I/O 数。可在任意线程中记录，默认关闭以免产生开销
+class RenderProfiler {
+public:
+	// 计时阶段
+	enum Stage {
+		LoadStage,	//打开文件、读取要素
+		DecodeStage,	//RasterIO / GetNextFeature
+		ConvertStage,	//转换为 QImage / QPainterPath
+		PaintStage,	//图形项绘制
+		StageCount
+	};
+
+	static RenderProfiler& instance();
+
+	void setEnabled(bool enabled);
+	bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	qint64 now() const;	//自启动以来的纳秒数，用作跟踪时间戳
+	void record(const QString& layer, Stage stage, qint64 startNs, qint64 durationNs);
+	void recordFrame(qint64 startNs, qint64 durationNs);
+	void recordCacheLookup(bool hit);
+	void beginIo();
+	void endIo();
+
+	QString summary() const;	//叠加层显示的文本
+	bool writeTrace(const QString& filePath) const;	//导出 Chrome Trace 格式的 JSON
+	void reset();
+
+private:
+	RenderProfiler();
+
+	// 单个阶段的累计统计
+	struct T_StageStats {
+		qint64 count = 0;
+		qint64 totalNs = 0;
+		qint64 maxNs = 0;
+	};
+
+	// 单个图层的各阶段统计
+	struct T_LayerStats {
+		T_StageStats stages[StageCount];
+	};
+
+	// 跟踪文件中的一条事件
+	struct T_TraceEvent {
+		QString layer;
+		int stage;	//-1 表示整帧
+		qint64 startNs;
+		qint64 durationNs;
+		quint64 threadId;
+	};
+
+	void appendEvent(const T_TraceEvent& event);
+
+	mutable QMutex m_mutex;
+	std::atomic<bool> m_enabled;
+	std::atomic<int> m_inFlightIo;
+	std::atomic<qint64> m_cacheHits;
+	std::atomic<qint64> m_cacheMisses;
+	QElapsedTimer m_clock;
+
+	QHash<QString, T_LayerStats> m_layers;
+	QVector<qint64> m_frameTimes;	//最近若干帧的耗时（环形缓冲）
+	int m_frameCursor;
+	QVector<T_TraceEvent> m_events;	//最近若干条跟踪事件（环形缓冲）
+	int m_eventCursor;
+};
+
+// 作用域计时：构造时开始，析构时记入 RenderProfiler
+class ProfileScope {
+public:
+	ProfileScope(const QString& layer, RenderProfiler::Stage stage);
+	~ProfileScope();
+
+private:
+	QString m_layer;
+	RenderProfiler::Stage m_stage;
+	qint64 m_startNs;
+	bool m_active;
+};
@@ -0,0 +1,237 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <cmath>
+
+// 将 16 位网格坐标映射为 Hilbert 曲线上的序号
+static quint32 hilbert(quint32 x, quint32 y) {
+	quint32 a = x ^ y;
+	quint32 b = 0xFFFF ^ a;
+	quint32 c = 0xFFFF ^ (x | y);
+	quint32 d = x & (y ^ 0xFFFF);
+
+	quint32 A = a | (b >> 1);
+	quint32 B = (a >> 1) ^ a;
+	quint32 C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+	quint32 D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+	a = A; b = B; c = C; d = D;
+	A = ((a & (a >> 2)) ^ (b & (b >> 2)));
+	B = ((a & (b >> 2)) ^ (b & ((a ^ b) >> 2)));
+	C ^= ((a & (c >> 2)) ^ (b & (d >> 2)));
+	D ^= ((b & (c >> 2)) ^ ((a ^ b) & (d >> 2)));
+
+	a = A; b = B; c = C; d = D;
+	A = ((a & (a >> 4)) ^ (b & (b >> 4)));
+	B = ((a & (b >> 4)) ^ (b & ((a ^ b) >> 4)));
+	C ^= ((a & (c >> 4)) ^ (b & (d >> 4)));
+	D ^= ((b & (c >> 4)) ^ ((a ^ b) & (d >> 4)));
+
+	a = A; b = B; c = C; d = D;
+	C ^= ((a & (c >> 8)) ^ (b & (d >> 8)));
+	D ^= ((b & (c >> 8)) ^ ((a ^ b) & (d >> 8)));
+
+	a = C ^ (C >> 1);
+	b = D ^ (D >> 1);
+
+	quint32 i0 = x ^ y;
+	quint32 i1 = b | (0xFFFF ^ (i0 | a));
+
+	i0 = (i0 | (i0 << 8)) & 0x00FF00FF;
+	i0 = (i0 | (i0 << 4)) & 0x0F0F0F0F;
+	i0 = (i0 | (i0 << 2)) & 0x33333333;
+	i0 = (i0 | (i0 << 1)) & 0x55555555;
+
+	i1 = (i1 | (i1 << 8)) & 0x00FF00FF;
+	i1 = (i1 | (i1 << 4)) & 0x0F0F0F0F;
+	i1 = (i1 | (i1 << 2)) & 0x33333333;
+	i1 = (i1 | (i1 << 1)) & 0x55555555;
+
+	return (i1 << 1) | i0;
+}
+
+SpatialIndex::SpatialIndex(int nodeSize)
+	: m_nodeSize(std::max(2, std::min(nodeSize, 65535))) {
+	clear();
+}
+
+void SpatialIndex::clear() {
+	m_numItems = 0;
+	m_finished = false;
+	m_minX = m_minY = std::numeric_limits<double>::infinity();
+	m_maxX = m_maxY = -std::numeric_limits<double>::infinity();
+	m_boxes.clear();
+	m_indices.clear();
+	m_levelBounds.clear();
+	m_external = false;
+	m_externalBoxes = nullptr;
+	m_externalIndices = nullptr;
+	m_externalLevelBounds = nullptr;
+	m_externalNodeCount = 0;
+	m_externalLevelCount = 0;
+}
+
+void SpatialIndex::wrap(int nodeSize, int numItems, const double* boxes, const int* indices, int numNodes,
+	const int* levelBounds, int numLevels) {
+	clear();
+	if (numItems <= 0 || numNodes <= 0 || numLevels <= 0) {
+		m_finished = true;
+		return;
+	}
+	m_nodeSize = nodeSize;
+	m_numItems = numItems;
+	m_external = true;
+	m_externalBoxes = boxes;
+	m_externalIndices = indices;
+	m_externalLevelBounds = levelBounds;
+	m_externalNodeCount = numNodes;
+	m_externalLevelCount = numLevels;
+
+	// 根节点即整体范围
+	const double* root = boxes + (numNodes - 1) * 4;
+	m_minX = root[0];
+	m_minY = root[1];
+	m_maxX = root[2];
+	m_maxY = root[3];
+	m_finished = true;
+}
+
+void SpatialIndex::reserve(int numItems) {
+	m_boxes.reserve(numItems * 4);
+	m_indices.reserve(numItems);
+}
+
+int SpatialIndex::add(const QRectF& box) {
+	if (m_external) clear();	//外部树只读，重新开始构建
+	const QRectF r = box.normalized();
+	const int index = m_numItems++;
+	m_indices.append(index);
+	m_boxes.append(r.left());
+	m_boxes.append(r.top());
+	m_boxes.append(r.right());
+	m_boxes.append(r.bottom());
+
+	m_minX = std::min(m_minX, r.left());
+	m_minY = std::min(m_minY, r.top());
+	m_maxX = std::max(m_maxX, r.right());
+	m_maxY = std::max(m_maxY, r.bottom());
+	m_finished = false;
+	return index;
+}
+
+void SpatialIndex::finish() {
+	m_levelBounds.clear();
+	if (m_numItems == 0) {
+		m_finished = true;
+		return;
+	}
+
+	// 计算每一层的节点数与结束偏移
+	int n = m_numItems;
+	int numNodes = n;
+	m_levelBounds.append(n * 4);
+	do {
+		n = (n + m_nodeSize - 1) / m_nodeSize;
+		numNodes += n;
+		m_levelBounds.append(numNodes * 4);
+	} while (n != 1);
+
+	// 按条目中心点的 Hilbert 值排序叶节点，使空间上相邻的条目落在同一节点
+	if (m_numItems > m_nodeSize) {
+		const double width = (m_maxX - m_minX) > 0 ? (m_maxX - m_minX) : 1.0;
+		const double height = (m_maxY - m_minY) > 0 ? (m_maxY - m_minY) : 1.0;
+		const double hilbertMax = 0xFFFF;
+
+		QVector<quint32> hilbertValues(m_numItems);
+		for (int i = 0; i < m_numItems; ++i) {
+			const double* b = m_boxes.constData() + i * 4;
+			const quint32 x = static_cast<quint32>(std::floor(hilbertMax * ((b[0] + b[2]) / 2 - m_minX) / width));
+			const quint32 y = static_cast<quint32>(std::floor(hilbertMax * ((b[1] + b[3]) / 2 - m_minY) / height));
+			hilbertValues[i] = hilbert(x, y);
+		}
+
+		QVector<int> order(m_numItems);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](int a, int b) {
+			return hilbertValues[a] < hilbertValues[b];
+			});
+
+		QVector<double> sortedBoxes(m_numItems * 4);
+		QVector<int> sortedIndices(m_numItems);
+		for (int i = 0; i < m_numItems; ++i) {
+			const int src = order[i];
+			std::copy_n(m_boxes.constData() + src * 4, 4, sortedBoxes.data() + i * 4);
+			sortedIndices[i] = m_indices[src];
+		}
+		m_boxes = sortedBoxes;
+		m_indices = sortedIndices;
+	}
+
+	// 自底向上逐层生成父节点
+	m_boxes.resize(numNodes * 4);
+	m_indices.resize(numNodes);
+	int pos = 0;
+	int out = m_numItems * 4;
+	for (int level = 0; level < m_levelBounds.size() - 1; ++level) {
+		const int end = m_levelBounds[level];
+		while (pos < end) {
+			const int nodeIndex = pos;
+			double nodeMinX = std::numeric_limits<double>::infinity();
+			double nodeMinY = std::numeric_limits<double>::infinity();
+			double nodeMaxX = -std::numeric_limits<double>::infinity();
+			double nodeMaxY = -std::numeric_limits<double>::infinity();
+			for (int j = 0; j < m_nodeSize && pos < end; ++j, pos += 4) {
+				nodeMinX = std::min(nodeMinX, m_boxes[pos]);
+				nodeMinY = std::min(nodeMinY, m_boxes[pos + 1]);
+				nodeMaxX = std::max(nodeMaxX, m_boxes[pos + 2]);
+				nodeMaxY = std::max(nodeMaxY, m_boxes[pos + 3]);
+			}
+			m_indices[out >> 2] = nodeIndex;
+			m_boxes[out++] = nodeMinX;
+			m_boxes[out++] = nodeMinY;
+			m_boxes[out++] = nodeMaxX;
+			m_boxes[out++] = nodeMaxY;
+		}
+	}
+	m_finished = true;
+}
+
+int SpatialIndex::upperBound(int nodeIndex) const {
+	const int* levels = levelBounds();
+	return *std::upper_bound(levels, levels + levelCount(), nodeIndex);
+}
+
+QVector<int> SpatialIndex::search(const QRectF& rect) const {
+	QVector<int> results;
+	if (!m_finished || m_numItems == 0) return results;
+
+	const QRectF r = rect.normalized();
+	const double minX = r.left(), minY = r.top(), maxX = r.right(), maxY = r.bottom();
+
+	const double* boxes = nodeBoxes();
+	const int* indices = nodeIndices();
+	const int leafEnd = m_numItems * 4;
+
+	QVector<int> queue;
+	int nodeIndex = nodeCount() * 4 - 4;
+	for (;;) {
+		const int end = std::min(nodeIndex + m_nodeSize * 4, upperBound(nodeIndex));
+		for (int pos = nodeIndex; pos < end; pos += 4) {
+			if (maxX < boxes[pos] || maxY < boxes[pos + 1] ||
+				minX > boxes[pos + 2] || minY > boxes[pos + 3]) continue;
+
+			const int index = indices[pos >> 2];
+			if (nodeIndex >= leafEnd) queue.append(index);	//内部节点：继续向下
+			else results.append(index);	//叶节点：命中条目
+		}
+		if (queue.isEmpty()) break;
+		nodeIndex = queue.takeLast();
+	}
+	return results;
+}
+
+QRectF SpatialIndex::bounds() const {
+	if (m_numItems == 0) return QRectF();
+	return QRectF(QPointF(m_minX, m_minY), QPointF(m_maxX, m_maxY));
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <QVector>
+#include <QRectF>
+
+// 静态打包 R 树（Hilbert 排序 + 自底向上批量构建）
+// 先 add() 全部外包矩形，再 finish() 一次性建树，之后只读查询；
+// 也可以用 wrap() 直接查询外部内存（如内存映射的缓存文件）中已建好的树
+class SpatialIndex {
+public:
+	explicit SpatialIndex(int nodeSize = 16);
+
+	void reserve(int numItems);
+	int add(const QRectF& box);	//返回条目编号（即添加顺序）
+	void finish();
+
+	// 使用外部内存中的节点数组，不复制；内存须在索引使用期间保持有效
+	void wrap(int nodeSize, int numItems, const double* boxes, const int* indices, int numNodes,
+		const int* levelBounds, int numLevels);
+
+	QVector<int> search(const QRectF& rect) const;	//返回与 rect 相交的条目编号
+
+	int size() const { return m_numItems; }
+	bool isEmpty() const { return m_numItems == 0; }
+	bool isFinished() const { return m_finished; }
+	QRectF bounds() const;
+	void clear();
+
+	// 建好的树的节点数组，用于写入缓存文件
+	int nodeSize() const { return m_nodeSize; }
+	int nodeCount() const { return m_external ? m_externalNodeCount : m_boxes.size() / 4; }
+	int levelCount() const { return m_external ? m_externalLevelCount : m_levelBounds.size(); }
+	const double* nodeBoxes() const { return m_external ? m_externalBoxes : m_boxes.constData(); }
+	const int* nodeIndices() const { return m_external ? m_externalIndices : m_indices.constData(); }
+	const int* levelBounds() const { return m_external ? m_externalLevelBounds : m_levelBounds.constData(); }
+
+private:
+	int upperBound(int nodeIndex) const;
+
+	int m_nodeSize;
+	int m_numItems;
+	bool m_finished;
+	double m_minX, m_minY, m_maxX, m_maxY;
+	QVector<double> m_boxes;	//每个节点 4 个值：minX, minY, maxX, maxY
+	QVector<int> m_indices;	//叶节点为条目编号，内部节点为子节点在 m_boxes 中的偏移
+	QVector<int> m_levelBounds;	//每一层在 m_boxes 中的结束偏移
+
+	// wrap() 时指向外部内存
+	bool m_external;
+	const double* m_externalBoxes;
+	const int* m_externalIndices;
+	const int* m_externalLevelBounds;
+	int m_externalNodeCount;
+	int m_externalLevelCount;
+};
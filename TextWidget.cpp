@@ -1,11 +1,8 @@
 // TextWidget.cpp
 #include "TextWidget.h"
 #include <QVBoxLayout>
-#include <QFileInfo>
-#include <gdal.h>
-#include <gdal_priv.h>
-#include <ogrsf_frmts.h>
-#include <cpl_string.h>
+#include <QDebug>
+#include "LayerMetadata.h"
 
 TextWidget::TextWidget(QWidget* parent)
     : QDockWidget("文本编辑器", parent) // 设置停靠窗口标题
@@ -31,76 +28,36 @@ TextWidget::TextWidget(QWidget* parent)
 }
 
 void TextWidget::dataPathReceived(QString datapath) {
-    // 判断文件类型
-    QFileInfo fileInfo(datapath);
-    QString fileExtension = fileInfo.suffix().toLower();
-
-    if (fileExtension == "tif") {
-
-        std::string s_rasterData = datapath.toStdString();
-        const char* c_rasterData = s_rasterData.c_str();
-
-        m_textEdit->append("文件类型: 栅格文件 (.tif)\n文件路径: " + datapath);
-        //GDAL读取数据
-        GDALDataset* rasterDataset = (GDALDataset*)GDALOpen(c_rasterData, GA_ReadOnly);
-
-        int width = rasterDataset->GetRasterXSize();
-        QString rasterXsize = QString::number(width);
-
-        int length = rasterDataset->GetRasterYSize();
-        QString rasterYsize = QString::number(length);
-
-        int rasterCount = rasterDataset->GetRasterCount();
-        QString rasterNum = QString::number(rasterCount);
-
-        GDALRasterBand* band = rasterDataset->GetRasterBand(1);
-
-        QString dataType = QString::fromUtf8(GDALGetDataTypeName(band->GetRasterDataType()));
-
-        m_textEdit->append("宽度: " + rasterYsize);
-        m_textEdit->append("高度: " + rasterYsize);
-        m_textEdit->append("图层数量: " + rasterNum);
-        m_textEdit->append("数据类型: " + dataType);
+    // 元数据在文件加入列表时已读取，这里只取缓存结果
+    const T_LayerMetadata metadata = LayerMetadata::scan(datapath);
+    if (!metadata.isValid) {
+        m_textEdit->setText("文件类型: 未知文件类型\n文件路径: " + datapath);
+        qDebug() << "GDAL 打开失败，文件路径：" << datapath;
+        return;
+    }
 
+    if (metadata.fileType == "Raster") {
+        m_textEdit->setText("文件类型: 栅格文件 (.tif)\n文件路径: " + datapath);
+        m_textEdit->append("宽度: " + QString::number(metadata.width));
+        m_textEdit->append("高度: " + QString::number(metadata.height));
+        m_textEdit->append("图层数量: " + QString::number(metadata.bands.size()));
+        m_textEdit->append("数据类型: " + (metadata.bands.isEmpty() ? QString() : metadata.bands.first().dataType));
     }
-    else if (fileExtension == "shp") {
+    else {
         m_textEdit->setText("文件类型: 矢量文件 (.shp)\n文件路径: " + datapath);
-        std::string s_vectorData = datapath.toStdString();
-        const char* c_vectorData = s_vectorData.c_str();
-
-        GDALDataset* vectorDataset = (GDALDataset*)GDALOpenEx(c_vectorData, GDAL_OF_VECTOR, nullptr, nullptr, nullptr);
-        if (!vectorDataset) {
-            qDebug() << "GDAL 打开失败，文件路径：" << datapath;
-            return;
-        }
-
-        int layerCount = vectorDataset->GetLayerCount();
-        QString layerNum = QString::number(layerCount);
-
-        m_textEdit->append("图层数: " + layerNum);
-
-        // 获取投影信息
-        OGRLayer* layer = vectorDataset->GetLayer(0); // 获取第一个图层
-        if (layer) {
-            OGRSpatialReference* spatialRef = layer->GetSpatialRef();
-            if (spatialRef) {
-                char* projWkt = nullptr;
-                spatialRef->exportToWkt(&projWkt); // 导出为WKT格式
-                m_textEdit->append("投影信息 (WKT):");
-                m_textEdit->append(QString::fromUtf8(projWkt));
-                CPLFree(projWkt); // 释放内存
-            }
-            else {
-                m_textEdit->append("投影信息: 无");
-            }
-        }
-        else {
-            m_textEdit->append("无法获取图层信息");
-        }
+        m_textEdit->append("图层数: " + QString::number(metadata.layerCount));
+        m_textEdit->append("几何类型: " + metadata.geometryType);
+        m_textEdit->append("要素数: " + QString::number(metadata.featureCount));
+    }
 
-        GDALClose(vectorDataset); // 关闭数据集
+    m_textEdit->append(QString("范围: (%1, %2) - (%3, %4)")
+        .arg(metadata.extent.left(), 0, 'f', 3).arg(metadata.extent.top(), 0, 'f', 3)
+        .arg(metadata.extent.right(), 0, 'f', 3).arg(metadata.extent.bottom(), 0, 'f', 3));
+    if (!metadata.crsWkt.isEmpty()) {
+        m_textEdit->append("投影信息 (WKT):");
+        m_textEdit->append(metadata.crsWkt);
     }
     else {
-        m_textEdit->setText("文件类型: 未知文件类型\n文件路径: " + datapath);
+        m_textEdit->append("投影信息: 无");
     }
-}
\ No newline at end of file
+}
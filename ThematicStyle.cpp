@@ -0,0 +1,231 @@
+#include "ThematicStyle.h"
+#include <QHash>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+#include "FlatGeometry.h"
+#include "DatasetPool.h"
+#include "GdalRuntime.h"
+
+namespace {
+	const int kChunkSize = 1 << 16;	//并行处理的分块大小（要素数）
+
+	// 一个分块及其局部结果
+	struct T_Chunk {
+		int begin;
+		int end;
+		double minimum;
+		double maximum;
+	};
+
+	QVector<T_Chunk> makeChunks(int count) {
+		QVector<T_Chunk> chunks;
+		for (int begin = 0; begin < count; begin += kChunkSize) {
+			chunks.append(T_Chunk{ begin, std::min(count, begin + kChunkSize),
+				std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() });
+		}
+		return chunks;
+	}
+
+	// 有效值排序：各块并行排序后两两归并
+	QVector<double> sortedValues(const QVector<double>& values) {
+		QVector<double> sorted;
+		sorted.reserve(values.size());
+		for (double value : values) {
+			if (!std::isnan(value)) sorted.append(value);
+		}
+		double* data = sorted.data();	//各线程只访问自己的区间
+		QVector<T_Chunk> runs = makeChunks(sorted.size());
+		QtConcurrent::blockingMap(GdalRuntime::analysisPool(), runs, [data](const T_Chunk& run) {
+			std::sort(data + run.begin, data + run.end);
+			});
+		while (runs.size() > 1) {
+			QVector<T_Chunk> merged;
+			for (int i = 0; i + 1 < runs.size(); i += 2) {
+				merged.append(T_Chunk{ runs[i].begin, runs[i + 1].end, 0.0, 0.0 });
+			}
+			QVector<int> middles;
+			for (int i = 0; i + 1 < runs.size(); i += 2) middles.append(runs[i].end);
+			QVector<int> pairs(merged.size());
+			for (int i = 0; i < pairs.size(); ++i) pairs[i] = i;
+			QtConcurrent::blockingMap(GdalRuntime::analysisPool(), pairs, [&](int i) {
+				std::inplace_merge(data + merged[i].begin, data + middles[i], data + merged[i].end);
+				});
+			if (runs.size() % 2) merged.append(runs.last());
+			runs = merged;
+		}
+		return sorted;
+	}
+
+	// 分级色带：浅黄 -> 橙 -> 深红
+	QColor rampColor(int index, int count) {
+		const QColor stops[] = { QColor(255, 255, 178), QColor(253, 141, 60), QColor(189, 0, 38) };
+		const double t = count > 1 ? static_cast<double>(index) / (count - 1) : 0.5;
+		const int segment = t < 0.5 ? 0 : 1;
+		const double local = t < 0.5 ? t * 2.0 : (t - 0.5) * 2.0;
+		const QColor& a = stops[segment];
+		const QColor& b = stops[segment + 1];
+		return QColor(qRound(a.red() + (b.red() - a.red()) * local), qRound(a.green() + (b.green() - a.green()) * local),
+			qRound(a.blue() + (b.blue() - a.blue()) * local));
+	}
+
+	// 分类颜色：色相按黄金角递增，相邻类别区分明显
+	QColor categoryColor(int index) {
+		return QColor::fromHsv(static_cast<int>(std::fmod(index * 137.508, 360.0)), 170, 225);
+	}
+
+	QString formatValue(double value) {
+		return QString::number(value, 'g', 8);
+	}
+}
+
+QString ThematicStyle::readColumn(const QString& filePath, const QString& field, const FlatGeometry& geometry, T_AttributeColumn& column) {
+	DatasetHandle dataset = DatasetPool::instance().acquire(filePath);
+	if (!dataset || !dataset->GetLayer(0)) return QString("无法打开矢量图层：%1").arg(filePath);
+	OGRLayer* layer = dataset->GetLayer(0);
+	OGRFeatureDefn* definition = layer->GetLayerDefn();
+	const int fieldIndex = definition->GetFieldIndex(field.toUtf8().constData());
+	if (fieldIndex < 0) return QString("字段 %1 不存在").arg(field);
+	const OGRFieldType fieldType = definition->GetFieldDefn(fieldIndex)->GetType();
+
+	column = T_AttributeColumn();
+	column.field = field;
+	column.isNumeric = fieldType == OFTInteger || fieldType == OFTInteger64 || fieldType == OFTReal;
+	if (column.isNumeric) column.numbers.fill(std::numeric_limits<double>::quiet_NaN(), geometry.featureCount());
+	else column.codes.fill(-1, geometry.featureCount());
+
+	// 只解析这一个字段，几何也不读；数据集句柄在线程内共享，读取结束后恢复
+	char** ignoredFields = CSLAddString(nullptr, "OGR_GEOMETRY");
+	ignoredFields = CSLAddString(ignoredFields, "OGR_STYLE");
+	for (int i = 0; i < definition->GetFieldCount(); ++i) {
+		if (i != fieldIndex) ignoredFields = CSLAddString(ignoredFields, definition->GetFieldDefn(i)->GetNameRef());
+	}
+	layer->SetIgnoredFields(const_cast<const char**>(ignoredFields));
+	CSLDestroy(ignoredFields);
+
+	QHash<QString, qint32> codeOf;
+	layer->ResetReading();
+	while (OGRFeature* feature = layer->GetNextFeature()) {
+		const int slot = geometry.slotOf(static_cast<qint64>(feature->GetFID()));	//没有几何的要素不在图层中
+		if (slot >= 0 && feature->IsFieldSetAndNotNull(fieldIndex)) {
+			if (column.isNumeric) {
+				column.numbers[slot] = feature->GetFieldAsDouble(fieldIndex);
+			}
+			else {
+				const QString text = QString::fromUtf8(feature->GetFieldAsString(fieldIndex));
+				auto it = codeOf.find(text);
+				if (it == codeOf.end()) {
+					it = codeOf.insert(text, column.codeNames.size());
+					column.codeNames.append(text);
+				}
+				column.codes[slot] = it.value();
+			}
+		}
+		OGRFeature::DestroyFeature(feature);
+	}
+	layer->SetIgnoredFields(nullptr);
+	return QString();
+}
+
+T_ThematicStyle ThematicStyle::classify(const T_AttributeColumn& column, const T_VectorStyle& style) {
+	T_ThematicStyle result;
+	const int count = column.isNumeric ? column.numbers.size() : column.codes.size();
+	result.slotClass.fill(T_ThematicStyle::NoClass, count);
+	quint16* slotClass = result.slotClass.data();	//各线程只写自己的分块
+	QVector<T_Chunk> chunks = makeChunks(count);
+
+	if (style.mode == Categorized && !column.isNumeric) {
+		// 文本字段：读取时已编号，按编号直接归类
+		const int categories = std::min<int>(column.codeNames.size(), MaxCategories);
+		const bool hasOther = column.codeNames.size() > MaxCategories;
+		for (int i = 0; i < categories - (hasOther ? 1 : 0); ++i) {
+			result.classes.append(T_ThematicClass{ categoryColor(i), column.codeNames[i] });
+		}
+		if (hasOther) result.classes.append(T_ThematicClass{ QColor(170, 170, 170), QString("其他") });
+		const int otherClass = result.classes.size() - 1;
+		QtConcurrent::blockingMap(GdalRuntime::analysisPool(), chunks, [&](const T_Chunk& chunk) {
+			for (int slot = chunk.begin; slot < chunk.end; ++slot) {
+				const qint32 code = column.codes[slot];
+				if (code < 0) continue;
+				slotClass[slot] = static_cast<quint16>(hasOther && code >= otherClass ? otherClass : code);
+			}
+			});
+		return result;
+	}
+
+	if (!column.isNumeric) return result;	//文本字段不能分级
+
+	if (style.mode == Categorized) {
+		// 数值字段：排序去重得到唯一值，逐要素二分查找所属类别
+		QVector<double> uniques = sortedValues(column.numbers);
+		uniques.erase(std::unique(uniques.begin(), uniques.end()), uniques.end());
+		const bool hasOther = uniques.size() > MaxCategories;
+		const int named = hasOther ? MaxCategories - 1 : uniques.size();
+		for (int i = 0; i < named; ++i) {
+			result.classes.append(T_ThematicClass{ categoryColor(i), formatValue(uniques[i]) });
+		}
+		if (hasOther) result.classes.append(T_ThematicClass{ QColor(170, 170, 170), QString("其他") });
+		QtConcurrent::blockingMap(GdalRuntime::analysisPool(), chunks, [&](const T_Chunk& chunk) {
+			for (int slot = chunk.begin; slot < chunk.end; ++slot) {
+				const double value = column.numbers[slot];
+				if (std::isnan(value)) continue;
+				const int index = static_cast<int>(std::lower_bound(uniques.cbegin(), uniques.cend(), value) - uniques.cbegin());
+				slotClass[slot] = static_cast<quint16>(std::min(index, named));
+			}
+			});
+		return result;
+	}
+
+	if (style.mode != Graduated) return result;
+
+	// 分级：先求断点（等间距只需取值范围，分位数需要排序），再逐要素归级
+	const int classCount = std::max(1, std::min(style.classCount, 32));
+	QVector<double> breaks(classCount + 1);
+	if (style.method == Quantile) {
+		const QVector<double> sorted = sortedValues(column.numbers);
+		if (sorted.isEmpty()) return result;
+		for (int i = 0; i <= classCount; ++i) {
+			breaks[i] = sorted[std::min<qsizetype>(sorted.size() - 1, static_cast<qsizetype>(sorted.size()) * i / classCount)];
+		}
+		breaks[classCount] = sorted.last();
+	}
+	else {
+		QtConcurrent::blockingMap(GdalRuntime::analysisPool(), chunks, [&column](T_Chunk& chunk) {
+			for (int slot = chunk.begin; slot < chunk.end; ++slot) {
+				const double value = column.numbers[slot];
+				if (std::isnan(value)) continue;
+				chunk.minimum = std::min(chunk.minimum, value);
+				chunk.maximum = std::max(chunk.maximum, value);
+			}
+			});
+		double minimum = std::numeric_limits<double>::max();
+		double maximum = std::numeric_limits<double>::lowest();
+		for (const T_Chunk& chunk : chunks) {
+			minimum = std::min(minimum, chunk.minimum);
+			maximum = std::max(maximum, chunk.maximum);
+		}
+		if (minimum > maximum) return result;
+		for (int i = 0; i <= classCount; ++i) {
+			breaks[i] = minimum + (maximum - minimum) * i / classCount;
+		}
+	}
+
+	for (int i = 0; i < classCount; ++i) {
+		result.classes.append(T_ThematicClass{ rampColor(i, classCount),
+			QString("%1 - %2").arg(formatValue(breaks[i]), formatValue(breaks[i + 1])) });
+	}
+	QtConcurrent::blockingMap(GdalRuntime::analysisPool(), chunks, [&](const T_Chunk& chunk) {
+		for (int slot = chunk.begin; slot < chunk.end; ++slot) {
+			const double value = column.numbers[slot];
+			if (std::isnan(value)) continue;
+			// 落在内部断点上的值归入上一级，最大值归入最高级
+			const int index = static_cast<int>(std::upper_bound(breaks.cbegin() + 1, breaks.cend() - 1, value) - (breaks.cbegin() + 1));
+			slotClass[slot] = static_cast<quint16>(std::min(index, classCount - 1));
+		}
+		});
+	return result;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QColor>
+#include "Public.h"
+
+class FlatGeometry;
+
+// 属性列：按 FlatGeometry 的条目编号排列，只读取一次，之后换样式只重新分级
+struct T_AttributeColumn {
+	QString field;
+	bool isNumeric = false;
+	QVector<double> numbers;	//数值字段的值，空值为 NaN
+	QVector<qint32> codes;	//文本字段的类别编号，空值为 -1
+	QStringList codeNames;	//类别编号 -> 文本
+};
+
+// 一个类别 / 级别
+struct T_ThematicClass {
+	QColor color;
+	QString label;
+};
+
+// 分类 / 分级结果：每个要素所属的类别，绘制时按类别设置画笔
+struct T_ThematicStyle {
+	static const quint16 NoClass = 0xFFFF;	//空值等不属于任何类别，按图层颜色绘制
+
+	QVector<T_ThematicClass> classes;
+	QVector<quint16> slotClass;	//按条目编号排列
+	bool isEmpty() const { return classes.isEmpty(); }
+};
+
+// 矢量专题符号化：分类（唯一值）与分级（等间距 / 分位数）
+namespace ThematicStyle {
+	enum Mode {
+		Single,	//单一颜色
+		Categorized,	//按唯一值分类
+		Graduated	//数值字段分级
+	};
+
+	enum Method {
+		EqualInterval,	//等间距
+		Quantile	//分位数（各级要素数相近）
+	};
+
+	const int MaxCategories = 64;	//超出的唯一值归入“其他”
+
+	// 只读取一个字段（忽略几何与其他字段），按 FID 对应到条目编号。成功返回空字符串
+	QString readColumn(const QString& filePath, const QString& field, const FlatGeometry& geometry, T_AttributeColumn& column);
+
+	// 计算类别与每个要素所属的类别；取值范围、排序与归类在线程池中分块并行
+	T_ThematicStyle classify(const T_AttributeColumn& column, const T_VectorStyle& style);
+}
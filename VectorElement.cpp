@@ -2,23 +2,34 @@
 #include <gdal.h>
 #include <gdal_priv.h>
 #include <ogrsf_frmts.h>
+#include "DatasetPool.h"
 #include <QStandardItemModel>
+#include <QItemSelection>
 #include <QList>
+#include <QSet>
+#include <algorithm>
+
+// 表格行头中保存要素真实 FID 的数据角色
+static const int FeatureIdRole = Qt::UserRole + 1;
 
 VectorElement::VectorElement(QWidget* parent)
-	: QMainWindow(parent), m_elementView(nullptr) {
+	: QMainWindow(parent), m_elementView(nullptr), b_isSyncing(false) {
 
-    QMenuBar* m_MenuBar = new QMenuBar(this);
+    m_MenuBar = new QMenuBar(this);
     setMenuBar(m_MenuBar);
 
 
     // 创建菜单项
     m_deleteAction = new QAction(tr("&Detele"), this);
     m_saveAction = new QAction(tr("&Save"), this);
+    m_repackAction = new QAction(tr("&Repack"), this);
+    m_repackAction->setCheckable(true);
+    m_repackAction->setChecked(true); // 默认保存后压缩 .dbf/.shp，避免残留已删除记录
 
     // 添加菜单项到 File 菜单
     m_MenuBar->addAction(m_deleteAction);
     m_MenuBar->addAction(m_saveAction);
+    m_MenuBar->addAction(m_repackAction);
 
 	m_elementView = new QTableView(this);
 	setCentralWidget(m_elementView);
@@ -30,14 +41,10 @@ VectorElement::VectorElement(QWidget* parent)
 }
 
 void VectorElement::vectorElementInfo(const QString filePath) {
-    GDALAllRegister(); // 注册所有驱动  
-
     m_filePath = filePath; // 保存文件路径
+    m_deletedFeatureIds.clear(); // 重新加载后旧的删除标记失效
 
-    std::string s_VectorData = filePath.toStdString();
-    const char* c_VectorData = s_VectorData.c_str();
-
-    GDALDataset* poDS = (GDALDataset*)GDALOpenEx(c_VectorData, GDAL_OF_VECTOR, nullptr, nullptr, nullptr);
+    DatasetHandle poDS = DatasetPool::instance().acquire(filePath);
     if (!poDS) {
         qDebug() << "文件打开失败";
         return;
@@ -46,7 +53,6 @@ void VectorElement::vectorElementInfo(const QString filePath) {
     OGRLayer* poLayer = poDS->GetLayer(0); // 获取第一个图层  
     if (!poLayer) {
         qDebug() << "无法获取图层";
-        GDALClose(poDS);
         return;
     }
 
@@ -69,26 +75,100 @@ void VectorElement::vectorElementInfo(const QString filePath) {
         model->setHeaderData(i, Qt::Horizontal, fieldNames[i]);
     }
 
-    // 遍历要素并填充模型
+    // 遍历要素并填充模型，行头保存要素真实 FID
+    poLayer->ResetReading();
     OGRFeature* poFeature = poLayer->GetNextFeature();
     int row = 0;
     while (poFeature != nullptr) {
-        model->insertRow(row);
+        QList<QStandardItem*> rowItems;
         for (int iField = 0; iField < poFeature->GetFieldCount(); iField++) {
+            QString fieldValue;
             if (poFeature->IsFieldSet(iField)) {
-                QString fieldValue = QString::fromUtf8(poFeature->GetFieldAsString(iField));
-                model->setItem(row, iField, new QStandardItem(fieldValue));
+                fieldValue = QString::fromUtf8(poFeature->GetFieldAsString(iField));
             }
+            rowItems.append(new QStandardItem(fieldValue));
         }
+        model->appendRow(rowItems);
+
+        const qint64 featureId = static_cast<qint64>(poFeature->GetFID());
+        QStandardItem* headerItem = new QStandardItem(QString::number(featureId));
+        headerItem->setData(featureId, FeatureIdRole);
+        model->setVerticalHeaderItem(row, headerItem);
+
         OGRFeature::DestroyFeature(poFeature);
         poFeature = poLayer->GetNextFeature();
         row++;
     }
 
-    GDALClose(poDS); // 关闭数据集  
+    poDS.reset(); // 归还数据集
 
     // 将模型设置到 QTableView
+    QAbstractItemModel* oldModel = m_elementView->model();
+    QItemSelectionModel* oldSelectionModel = m_elementView->selectionModel(); // setModel 不会删除旧的选择模型
     m_elementView->setModel(model);
+    m_elementView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    if (oldSelectionModel) oldSelectionModel->deleteLater();
+    if (oldModel) oldModel->deleteLater();
+
+    connect(m_elementView->selectionModel(), &QItemSelectionModel::selectionChanged,
+        this, &VectorElement::onSelectionChanged);
+}
+
+void VectorElement::selectFeatures(const QString& filePath, const QList<qint64>& featureIds) {
+    if (filePath.isEmpty()) {
+        if (m_elementView->selectionModel()) m_elementView->selectionModel()->clearSelection();
+        return;
+    }
+    if (filePath != m_filePath || !m_elementView->model()) {
+        vectorElementInfo(filePath);
+    }
+
+    QStandardItemModel* model = qobject_cast<QStandardItemModel*>(m_elementView->model());
+    if (!model) return;
+
+    // 将命中的行合并为连续区间，一次性设置选择
+    QSet<qint64> wanted(featureIds.begin(), featureIds.end());
+    QItemSelection selection;
+    int firstVisibleRow = -1;
+    int rangeStart = -1;
+    const int lastColumn = model->columnCount() - 1;
+    for (int row = 0; row <= model->rowCount(); ++row) {
+        bool hit = false;
+        if (row < model->rowCount()) {
+            QStandardItem* headerItem = model->verticalHeaderItem(row);
+            hit = headerItem && wanted.contains(headerItem->data(FeatureIdRole).toLongLong());
+        }
+        if (hit && rangeStart < 0) {
+            rangeStart = row;
+            if (firstVisibleRow < 0) firstVisibleRow = row;
+        }
+        else if (!hit && rangeStart >= 0) {
+            selection.select(model->index(rangeStart, 0), model->index(row - 1, lastColumn));
+            rangeStart = -1;
+        }
+    }
+
+    b_isSyncing = true;
+    m_elementView->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+    b_isSyncing = false;
+    if (firstVisibleRow >= 0) {
+        m_elementView->scrollTo(model->index(firstVisibleRow, 0));
+    }
+}
+
+void VectorElement::onSelectionChanged() {
+    if (b_isSyncing) return;
+
+    QStandardItemModel* model = qobject_cast<QStandardItemModel*>(m_elementView->model());
+    if (!model) return;
+
+    QList<qint64> featureIds;
+    const QModelIndexList selectedIndexes = m_elementView->selectionModel()->selectedRows();
+    for (const QModelIndex& index : selectedIndexes) {
+        QStandardItem* headerItem = model->verticalHeaderItem(index.row());
+        if (headerItem) featureIds.append(headerItem->data(FeatureIdRole).toLongLong());
+    }
+    emit featuresSelected(m_filePath, featureIds);
 }
 
 void VectorElement::deleteElement() {
@@ -112,23 +192,28 @@ void VectorElement::deleteElement() {
         return;
     }
 
-    // 遍历选中的行并记录要素 ID
+    // 先按行号降序排列，保证删除时前面的行号不发生偏移
+    QList<int> rows;
     for (const QModelIndex& index : selectedIndexes) {
-        int row = index.row();
-
-        // 假设模型的第一列存储的是要素 ID
-        QString featureIdStr = model->item(row, 0)->text();
-        int featureId = featureIdStr.toInt();
-
-        // 将要素 ID 添加到删除列表
-        m_deletedFeatureIds.append(featureId);
-
-        // 从模型中移除行
-        model->removeRow(row);
+        rows.append(index.row());
+    }
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+
+    // 记录真实 FID，并把连续的行合并成一次 removeRows
+    int i = 0;
+    while (i < rows.size()) {
+        int last = rows[i];
+        int first = last;
+        while (i < rows.size() && rows[i] == first) {
+            QStandardItem* headerItem = model->verticalHeaderItem(first);
+            if (headerItem) {
+                m_deletedFeatureIds.append(headerItem->data(FeatureIdRole).toLongLong());
+            }
+            --first;
+            ++i;
+        }
+        model->removeRows(first + 1, last - first);
     }
-
-    // 更新视图
-    m_elementView->reset();
 
     qDebug() << "已标记删除的要素 ID：" << m_deletedFeatureIds;
 }
@@ -144,7 +229,8 @@ void VectorElement::saveElement() {
         return;
     }
 
-    // 打开矢量数据集
+    // 关闭池中的只读句柄后以更新模式打开，REPACK 需要独占文件
+    DatasetPool::instance().invalidate(m_filePath);
     GDALDataset* poDS = (GDALDataset*)GDALOpenEx(m_filePath.toStdString().c_str(), GDAL_OF_VECTOR | GDAL_OF_UPDATE, nullptr, nullptr, nullptr);
     if (!poDS) {
         qDebug() << "无法打开矢量数据集";
@@ -158,16 +244,41 @@ void VectorElement::saveElement() {
         return;
     }
 
-    // 删除标记的要素
-    for (int featureId : m_deletedFeatureIds) {
-        if (poLayer->DeleteFeature(featureId) != OGRERR_NONE) {
+    // 在一个事务中批量删除；不支持事务的驱动（如 Shapefile）直接逐条删除
+    const bool inTransaction = (poDS->StartTransaction() == OGRERR_NONE);
+
+    int failedCount = 0;
+    for (qint64 featureId : m_deletedFeatureIds) {
+        if (poLayer->DeleteFeature(static_cast<GIntBig>(featureId)) != OGRERR_NONE) {
             qDebug() << "删除要素失败，ID：" << featureId;
+            ++failedCount;
+        }
+    }
+
+    if (inTransaction) {
+        if (failedCount > 0) {
+            poDS->RollbackTransaction();
+            qDebug() << "删除失败，已回滚事务";
+            GDALClose(poDS);
+            return;
         }
-        else {
-            qDebug() << "成功删除要素，ID：" << featureId;
+        if (poDS->CommitTransaction() != OGRERR_NONE) {
+            qDebug() << "提交事务失败";
+            GDALClose(poDS);
+            return;
         }
     }
 
+    // Shapefile 删除只是打标记，REPACK 后才真正从 .dbf/.shp 中移除记录
+    const bool isShapefile = EQUAL(poDS->GetDriverName(), "ESRI Shapefile");
+    if (isShapefile && m_repackAction->isChecked()) {
+        QString sql = QString("REPACK \"%1\"").arg(QString::fromUtf8(poLayer->GetName()));
+        OGRLayer* poResult = poDS->ExecuteSQL(sql.toUtf8().constData(), nullptr, nullptr);
+        if (poResult) poDS->ReleaseResultSet(poResult);
+    }
+
+    qDebug() << "已删除要素数：" << m_deletedFeatureIds.size() - failedCount;
+
     // 清空删除列表
     m_deletedFeatureIds.clear();
 
@@ -175,4 +286,10 @@ void VectorElement::saveElement() {
     GDALClose(poDS);
 
     qDebug() << "保存完成";
+
+    // REPACK 后 FID 会重新编号，重新加载表格
+    if (isShapefile && m_repackAction->isChecked()) {
+        vectorElementInfo(m_filePath);
+    }
+    emit elementSaved(m_filePath);
 }
\ No newline at end of file
@@ -13,11 +13,22 @@ public:
 	void deleteElement();
 	void saveElement();
 
+	void selectFeatures(const QString& filePath, const QList<qint64>& featureIds); // 按 FID 选中表格行
+
+signals:
+	void elementSaved(const QString& filePath); // 要素删除已写回文件
+
+	void featuresSelected(const QString& filePath, const QList<qint64>& featureIds); // 表格中选中的要素
+
 private:
+	void onSelectionChanged();
+
 	QTableView* m_elementView;
 	QMenuBar* m_MenuBar;
 	QAction* m_deleteAction;
 	QAction* m_saveAction;
+	QAction* m_repackAction; // 保存后是否压缩 Shapefile
 	QString m_filePath; // 用于存储文件路径
-	QList<int> m_deletedFeatureIds; // 存储被删除的要素 ID
-};
\ No newline at end of file
+	QList<qint64> m_deletedFeatureIds; // 存储被删除的要素 FID
+	bool b_isSyncing; // 正在按地图选择同步表格，不回发信号
+};
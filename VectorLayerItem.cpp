@@ -0,0 +1,411 @@
+#include "VectorLayerItem.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QLineF>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <gdal.h>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+#include "RenderProfiler.h"
+#include "DatasetPool.h"
+
+// 地理坐标 -> 场景坐标（Y 轴翻转，使北方朝上）
+static inline QPointF toScene(double x, double y) {
+	return QPointF(x, -y);
+}
+
+// 线段与矩形是否相交
+static bool segmentIntersectsRect(const QPointF& p1, const QPointF& p2, const QRectF& rect) {
+	if (rect.contains(p1) || rect.contains(p2)) return true;
+
+	const QLineF segment(p1, p2);
+	const QLineF edges[4] = {
+		QLineF(rect.topLeft(), rect.topRight()),
+		QLineF(rect.topRight(), rect.bottomRight()),
+		QLineF(rect.bottomRight(), rect.bottomLeft()),
+		QLineF(rect.bottomLeft(), rect.topLeft())
+	};
+	for (const QLineF& edge : edges) {
+		if (segment.intersects(edge, nullptr) == QLineF::BoundedIntersection) return true;
+	}
+	return false;
+}
+
+VectorLayerItem::VectorLayerItem(const QString& filePath, QGraphicsItem* parent)
+	: QGraphicsItem(parent), m_filePath(filePath), m_color(Qt::blue), m_columns(64) {
+	setData(0, filePath);
+	setFlag(QGraphicsItem::ItemUsesExtendedStyleOption); // paint 中需要 exposedRect 做裁剪
+	setCacheMode(QGraphicsItem::DeviceCoordinateCache); // 按当前视图变换缓存为离屏图像
+}
+
+bool VectorLayerItem::load() {
+	ProfileScope scope(m_filePath, RenderProfiler::LoadStage);
+	prepareGeometryChange();
+
+	// 几何缓存与源文件一致时直接映射，不打开数据源
+	if (GeometryCache::load(m_filePath, m_geometry)) {
+		m_extent = m_geometry.extent();
+		update();
+		return true;
+	}
+
+	RenderProfiler& profiler = RenderProfiler::instance();
+	const bool profiling = profiler.isEnabled();
+	const qint64 loadStart = profiling ? profiler.now() : 0;
+	qint64 decodeNs = 0; // 累计 GetNextFeature 耗时
+	qint64 convertNs = 0; // 累计几何转换耗时
+	QElapsedTimer stageTimer;
+
+	DatasetHandle poDS = DatasetPool::instance().acquire(m_filePath);
+	if (!poDS) {
+		qDebug() << "打开SHP文件失败" << m_filePath;
+		return false;
+	}
+
+	OGRLayer* poLayer = poDS->GetLayer(0);
+	if (!poLayer) return false;
+
+	m_geometry.clear();
+	m_geometry.reserve(static_cast<int>(poLayer->GetFeatureCount()));
+
+	// 绘制只需要几何：忽略全部属性字段，OGR 不再为每个要素解析并分配属性值。
+	// 数据集句柄在线程内共享，读取结束后恢复
+	char** ignoredFields = CSLAddString(nullptr, "OGR_STYLE");
+	OGRFeatureDefn* poDefn = poLayer->GetLayerDefn();
+	for (int i = 0; i < poDefn->GetFieldCount(); ++i) {
+		ignoredFields = CSLAddString(ignoredFields, poDefn->GetFieldDefn(i)->GetNameRef());
+	}
+	poLayer->SetIgnoredFields(const_cast<const char**>(ignoredFields));
+	CSLDestroy(ignoredFields);
+
+	// 遍历要素，坐标转换为场景坐标后直接写入扁平数组的内存区，不为要素创建中间对象
+	poLayer->ResetReading();
+	OGRFeature* poFeature;
+	for (;;) {
+		if (profiling) stageTimer.start();
+		poFeature = poLayer->GetNextFeature();
+		if (profiling) decodeNs += stageTimer.nsecsElapsed();
+		if (!poFeature) break;
+
+		const OGRGeometry* poGeometry = poFeature->GetGeometryRef();
+		if (poGeometry) {
+			if (profiling) stageTimer.start();
+			GeometryKind kind = PolygonKind;
+			m_geometry.beginFeature(static_cast<qint64>(poFeature->GetFID()));
+			appendGeometry(poGeometry, kind);
+			m_geometry.endFeature(static_cast<uchar>(kind));
+			if (profiling) convertNs += stageTimer.nsecsElapsed();
+		}
+		OGRFeature::DestroyFeature(poFeature);
+	}
+	poLayer->SetIgnoredFields(nullptr);
+	poDS.reset();
+
+	m_geometry.finish();
+	m_extent = m_geometry.extent();
+	GeometryCache::store(m_filePath, m_geometry); // 下次打开时直接映射
+	update();
+
+	if (profiling) {
+		profiler.record(m_filePath, RenderProfiler::DecodeStage, loadStart, decodeNs);
+		profiler.record(m_filePath, RenderProfiler::ConvertStage, loadStart, convertNs);
+	}
+	return true;
+}
+
+void VectorLayerItem::appendGeometry(const OGRGeometry* geom, GeometryKind& kind) {
+	// 每个点、每条折线、每个环各为一个部件
+	auto appendCurve = [this](const OGRSimpleCurve* curve) {
+		if (!curve) return;
+		const int count = curve->getNumPoints();
+		QPointF* out = m_geometry.appendPart(count);
+		for (int i = 0; i < count; ++i) {
+			out[i] = toScene(curve->getX(i), curve->getY(i));
+		}
+	};
+
+	switch (wkbFlatten(geom->getGeometryType())) {
+	case wkbPoint: {
+		const OGRPoint* p = static_cast<const OGRPoint*>(geom);
+		*m_geometry.appendPart(1) = toScene(p->getX(), p->getY());
+		kind = PointKind;
+		break;
+	}
+	case wkbLineString:
+		appendCurve(static_cast<const OGRLineString*>(geom));
+		kind = LineKind;
+		break;
+	case wkbPolygon: {
+		// 外环与内环（洞）都作为部件，按奇偶规则填充
+		const OGRPolygon* poly = static_cast<const OGRPolygon*>(geom);
+		appendCurve(poly->getExteriorRing());
+		for (int i = 0; i < poly->getNumInteriorRings(); ++i) {
+			appendCurve(poly->getInteriorRing(i));
+		}
+		kind = PolygonKind;
+		break;
+	}
+	case wkbMultiPoint:
+	case wkbMultiLineString:
+	case wkbMultiPolygon:
+	case wkbGeometryCollection: {
+		const OGRGeometryCollection* collection = static_cast<const OGRGeometryCollection*>(geom);
+		for (int i = 0; i < collection->getNumGeometries(); ++i) {
+			appendGeometry(collection->getGeometryRef(i), kind);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void VectorLayerItem::buildPath(int slot, QPainterPath& path) const {
+	path.clear();
+	path.setFillRule(Qt::OddEvenFill);
+	const uchar kind = m_geometry.kind(slot);
+	for (qint64 part = m_geometry.partBegin(slot); part < m_geometry.partEnd(slot); ++part) {
+		const QPointF* points = m_geometry.partPoints(part);
+		const int count = m_geometry.partSize(part);
+		if (kind == PointKind) {
+			// 点要素用极短线段表示，由圆头画笔绘制成圆点
+			for (int i = 0; i < count; ++i) {
+				path.moveTo(points[i]);
+				path.lineTo(points[i] + QPointF(1e-9, 0));
+			}
+			continue;
+		}
+		if (count == 0) continue;
+		path.moveTo(points[0]);
+		for (int i = 1; i < count; ++i) {
+			path.lineTo(points[i]);
+		}
+		if (kind == PolygonKind) path.closeSubpath();
+	}
+}
+
+QRectF VectorLayerItem::boundingRect() const {
+	if (m_extent.isNull() && m_geometry.featureCount() == 0) return QRectF();
+	// 留出少量边距，避免边缘处的点符号与线宽被裁掉
+	const double margin = std::max(std::max(m_extent.width(), m_extent.height()) * 0.005, 1e-6);
+	return m_extent.adjusted(-margin, -margin, margin, margin);
+}
+
+void VectorLayerItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+	Q_UNUSED(widget);
+	ProfileScope scope(m_filePath, RenderProfiler::PaintStage);
+
+	const QTransform deviceTransform = painter->worldTransform();
+	const double lod = option->levelOfDetailFromTransform(deviceTransform);
+	const double pixelSize = lod > 0 ? 1.0 / lod : 0.0; // 一个设备像素对应的场景尺寸
+
+	// 只绘制与暴露区域相交的要素，按原始顺序绘制
+	const FlatGeometry& geometry = m_geometry;
+	QVector<int> visibleSlots = geometry.index().search(option->exposedRect);
+	std::sort(visibleSlots.begin(), visibleSlots.end());
+
+	if (m_thematic.isEmpty() || m_thematic.slotClass.size() != geometry.featureCount()) {
+		drawSlots(painter, visibleSlots, pixelSize, m_color, QColor(0, 255, 0, 50)); // 填充只对面要素生效
+	}
+	else {
+		drawThematic(painter, visibleSlots, pixelSize);
+	}
+
+	// 标注画在要素之上，布局按缩放级别缓存
+	m_labels.draw(painter, geometry, option->exposedRect, lod);
+}
+
+void VectorLayerItem::drawThematic(QPainter* painter, const QVector<int>& visibleSlots, double pixelSize) {
+	// 专题样式：可见要素按类别分组（组内保持原始顺序），每组只设置一次画笔；无类别的要素按图层颜色先画
+	const int classCount = m_thematic.classes.size();
+	QVector<QVector<int>> groups(classCount + 1);
+	for (int slot : visibleSlots) {
+		const quint16 classIndex = m_thematic.slotClass[slot];
+		groups[classIndex == T_ThematicStyle::NoClass ? classCount : classIndex].append(slot);
+	}
+	drawSlots(painter, groups[classCount], pixelSize, m_color, QColor(0, 255, 0, 50));
+	for (int i = 0; i < classCount; ++i) {
+		if (groups[i].isEmpty()) continue;
+		QColor fill = m_thematic.classes[i].color;
+		fill.setAlpha(170);
+		drawSlots(painter, groups[i], pixelSize, m_thematic.classes[i].color, fill);
+	}
+}
+
+void VectorLayerItem::drawSlots(QPainter* painter, const QVector<int>& slots, double pixelSize, const QColor& stroke, const QColor& fill) {
+	if (slots.isEmpty()) return;
+	const FlatGeometry& geometry = m_geometry;
+	const QTransform deviceTransform = painter->worldTransform();
+
+	QPen pen(stroke, 1);
+	pen.setCosmetic(true);
+	painter->setPen(pen);
+	painter->setBrush(fill);
+
+	// 坐标直接取自扁平数组（可能是映射的缓存文件），不为要素构造路径
+	QVector<QPointF> points;
+	for (int slot : slots) {
+		const QRectF& bounds = geometry.bounds(slot);
+		const qint64 partBegin = geometry.partBegin(slot);
+		const qint64 partEnd = geometry.partEnd(slot);
+		switch (geometry.kind(slot)) {
+		case PointKind: {
+			for (qint64 part = partBegin; part < partEnd; ++part) {
+				const QPointF* pts = geometry.partPoints(part);
+				for (int i = 0; i < geometry.partSize(part); ++i) {
+					points.append(deviceTransform.map(pts[i]));
+				}
+			}
+			break;
+		}
+		case LineKind: {
+			// 小于一个像素的要素只画一个点
+			if (bounds.width() < pixelSize && bounds.height() < pixelSize) {
+				painter->drawPoint(bounds.center());
+				break;
+			}
+			for (qint64 part = partBegin; part < partEnd; ++part) {
+				painter->drawPolyline(geometry.partPoints(part), geometry.partSize(part));
+			}
+			break;
+		}
+		case PolygonKind: {
+			if (bounds.width() < pixelSize && bounds.height() < pixelSize) {
+				painter->drawPoint(bounds.center());
+				break;
+			}
+			// 单环直接绘制，带洞或多部件的面合成一条路径
+			if (partEnd - partBegin == 1) {
+				painter->drawPolygon(geometry.partPoints(partBegin), geometry.partSize(partBegin), Qt::OddEvenFill);
+			}
+			else {
+				buildPath(slot, m_scratchPath);
+				painter->drawPath(m_scratchPath);
+			}
+			break;
+		}
+		}
+	}
+
+	// 点符号在设备坐标下绘制，大小不随缩放变化
+	if (!points.isEmpty()) {
+		painter->save();
+		painter->setWorldTransform(QTransform());
+		painter->setBrush(stroke);
+		for (const QPointF& pt : points) {
+			painter->drawEllipse(pt, 2.0, 2.0);
+		}
+		painter->restore();
+	}
+}
+
+void VectorLayerItem::setColor(const QColor& color) {
+	if (m_color == color) return;
+	m_color = color;
+	update(); // 使缓存失效，下次绘制时重新生成
+}
+
+QString VectorLayerItem::setStyle(const T_VectorStyle& style) {
+	if (m_style == style) return QString();
+	if (style.mode == ThematicStyle::Single || style.field.isEmpty()) {
+		m_style = style;
+		m_thematic = T_ThematicStyle();
+		update();
+		return QString();
+	}
+
+	// 属性列按字段缓存，换分级数或方法时不再访问数据源
+	const T_AttributeColumn* column = nullptr;
+	const QString error = attributeColumn(style.field, column);
+	if (!error.isEmpty()) return error;
+	if (style.mode == ThematicStyle::Graduated && !column->isNumeric) return QString("字段 %1 不是数值字段，不能分级").arg(style.field);
+
+	m_style = style;
+	m_thematic = ThematicStyle::classify(*column, style);
+	update(); // 只改变绘制状态，几何不重新读取
+	return QString();
+}
+
+QString VectorLayerItem::setLabel(const T_LabelStyle& label) {
+	if (m_labelStyle == label) return QString();
+	if (label.field.isEmpty()) {
+		m_labelStyle = label;
+		m_labels.clear();
+		update();
+		return QString();
+	}
+
+	if (label.field != m_labelStyle.field) {
+		const T_AttributeColumn* column = nullptr;
+		const QString error = attributeColumn(label.field, column);
+		if (!error.isEmpty()) return error;
+		m_labels.setColumn(*column);
+	}
+	m_labels.setStyle(label.fontSize, label.maxResolution);
+	m_labelStyle = label;
+	update();
+	return QString();
+}
+
+QString VectorLayerItem::attributeColumn(const QString& field, const T_AttributeColumn*& column) {
+	column = m_columns.object(field);
+	if (column) return QString();
+	T_AttributeColumn* entry = new T_AttributeColumn;
+	const QString error = ThematicStyle::readColumn(m_filePath, field, m_geometry, *entry);
+	if (!error.isEmpty()) {
+		delete entry;
+		return error;
+	}
+	// 代价以 MB 计，超过上限的列也保留（挤出其他列）
+	const qsizetype bytes = entry->numbers.size() * qsizetype(sizeof(double)) + entry->codes.size() * qsizetype(sizeof(qint32));
+	column = entry;
+	m_columns.insert(field, entry, std::clamp<qsizetype>(bytes >> 20, 1, m_columns.maxCost()));
+	return QString();
+}
+
+bool VectorLayerItem::hitTest(int slot, const QRectF& sceneRect) const {
+	switch (m_geometry.kind(slot)) {
+	case PointKind:
+		for (qint64 part = m_geometry.partBegin(slot); part < m_geometry.partEnd(slot); ++part) {
+			const QPointF* points = m_geometry.partPoints(part);
+			for (int i = 0; i < m_geometry.partSize(part); ++i) {
+				if (sceneRect.contains(points[i])) return true;
+			}
+		}
+		return false;
+	case LineKind:
+		for (qint64 part = m_geometry.partBegin(slot); part < m_geometry.partEnd(slot); ++part) {
+			const QPointF* points = m_geometry.partPoints(part);
+			for (int i = 1; i < m_geometry.partSize(part); ++i) {
+				if (segmentIntersectsRect(points[i - 1], points[i], sceneRect)) return true;
+			}
+		}
+		return false;
+	default: {
+		QPainterPath path;
+		buildPath(slot, path);
+		return path.intersects(sceneRect);
+	}
+	}
+}
+
+QList<qint64> VectorLayerItem::featuresIn(const QRectF& sceneRect) const {
+	// 先用空间索引取候选，再对几何精确判断
+	QList<qint64> featureIds;
+	const QVector<int> candidates = m_geometry.index().search(sceneRect);
+	for (int slot : candidates) {
+		if (hitTest(slot, sceneRect)) featureIds.append(m_geometry.featureId(slot));
+	}
+	return featureIds;
+}
+
+QPainterPath VectorLayerItem::featurePath(qint64 featureId) const {
+	const int slot = m_geometry.slotOf(featureId);
+	if (slot < 0) return QPainterPath();
+
+	QPainterPath path;
+	buildPath(slot, path);
+	return path;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <QGraphicsItem>
+#include <QPainterPath>
+#include <QColor>
+#include <QVector>
+#include <QCache>
+#include "FlatGeometry.h"
+#include "ThematicStyle.h"
+#include "LabelEngine.h"
+
+class OGRGeometry;
+
+// 一个矢量图层对应一个图形项：全部要素在 paint 中绘制，
+// 配合 DeviceCoordinateCache 缓存为离屏图像，只有数据、样式或视图比例变化时才重绘。
+// 几何存放在扁平数组中，有几何缓存时直接映射缓存文件，不经过 OGR
+class VectorLayerItem : public QGraphicsItem {
+public:
+	enum { Type = UserType + 1 };
+
+	// 要素几何类别
+	enum GeometryKind {
+		PointKind,
+		LineKind,
+		PolygonKind
+	};
+
+	explicit VectorLayerItem(const QString& filePath, QGraphicsItem* parent = nullptr);
+
+	bool load();	//映射几何缓存，或读取全部要素、建立空间索引并写入缓存
+
+	int type() const override { return Type; }
+	QRectF boundingRect() const override;
+	void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+	QString filePath() const { return m_filePath; }
+	int featureCount() const { return m_geometry.featureCount(); }
+	qint64 memoryUsage() const { return m_geometry.memoryUsage(); }	//几何占用的内存（映射缓存时为 0）
+
+	void setColor(const QColor& color);	//只改变绘制状态，不重新读取几何
+	QColor color() const { return m_color; }
+
+	// 分类 / 分级符号化：字段值只在第一次使用时读取（不读几何），之后换字段或分级只重新归类；
+	// 成功返回空字符串
+	QString setStyle(const T_VectorStyle& style);
+	T_VectorStyle style() const { return m_style; }
+	const QVector<T_ThematicClass>& styleClasses() const { return m_thematic.classes; }	//图例
+
+	QString setLabel(const T_LabelStyle& label);	//字段为空时不显示标注；成功返回空字符串
+	T_LabelStyle label() const { return m_labelStyle; }
+	int cachedLabelLevels() const { return m_labels.cachedLevels(); }
+
+	QList<qint64> featuresIn(const QRectF& sceneRect) const;	//与范围相交的要素 FID
+	QPainterPath featurePath(qint64 featureId) const;	//要素轮廓（用于高亮）
+
+private:
+	void appendGeometry(const OGRGeometry* geom, GeometryKind& kind);
+	void buildPath(int slot, QPainterPath& path) const;	//多环面要素的绘制路径
+	bool hitTest(int slot, const QRectF& sceneRect) const;
+	void drawSlots(QPainter* painter, const QVector<int>& slots, double pixelSize, const QColor& stroke, const QColor& fill);
+	void drawThematic(QPainter* painter, const QVector<int>& visibleSlots, double pixelSize);
+	QString attributeColumn(const QString& field, const T_AttributeColumn*& column);	//读取或取缓存的属性列
+
+	QString m_filePath;
+	QColor m_color;
+	QRectF m_extent;	//场景坐标下的图层范围
+
+	FlatGeometry m_geometry;	//场景坐标下的要素几何、FID 与空间索引
+	QPainterPath m_scratchPath;	//绘制多环面时复用
+
+	T_VectorStyle m_style;
+	T_ThematicStyle m_thematic;	//每个要素所属的类别
+	QCache<QString, T_AttributeColumn> m_columns;	//最近使用的属性列，按 MB 计，上限 64 MB
+
+	T_LabelStyle m_labelStyle;
+	LabelEngine m_labels;
+};
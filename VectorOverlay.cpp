@@ -0,0 +1,308 @@
+#include "VectorOverlay.h"
+#include <QPromise>
+#include <QFileInfo>
+#include <QRectF>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <vector>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+#include <ogr_spatialref.h>
+#include "DatasetPool.h"
+#include "GdalRuntime.h"
+#include "SpatialIndex.h"
+
+namespace {
+	const int kBatchSize = 4096;	//每批读取、计算、写出的输入要素数
+
+	struct T_FeatureDeleter {
+		void operator()(OGRFeature* feature) const { OGRFeature::DestroyFeature(feature); }
+	};
+	typedef std::unique_ptr<OGRFeature, T_FeatureDeleter> FeaturePtr;
+
+	struct T_PreparedDeleter {
+		void operator()(OGRPreparedGeometry* prepared) const { OGRDestroyPreparedGeometry(prepared); }
+	};
+
+	// 一条输出：几何与来源要素
+	struct T_OverlayPart {
+		std::unique_ptr<OGRGeometry> geometry;
+		int overlayIndex;	//相交时对应的面要素，其余为 -1
+	};
+
+	QRectF envelopeRect(const OGRGeometry* geometry) {
+		OGREnvelope envelope;
+		geometry->getEnvelope(&envelope);
+		return QRectF(QPointF(envelope.MinX, envelope.MinY), QPointF(envelope.MaxX, envelope.MaxY));
+	}
+
+	// 从运算结果中取出与输入同维度的部分（如面与面相交得到的边界线被丢弃），统一为多部件
+	OGRGeometry* extractDimension(const OGRGeometry* geometry, int dimension) {
+		if (!geometry || geometry->IsEmpty()) return nullptr;
+		const OGRwkbGeometryType type = wkbFlatten(geometry->getGeometryType());
+		if (OGR_GT_IsSubClassOf(type, wkbGeometryCollection)) {
+			const OGRGeometryCollection* collection = geometry->toGeometryCollection();
+			OGRGeometryCollection* result = dimension == 2 ? static_cast<OGRGeometryCollection*>(new OGRMultiPolygon)
+				: dimension == 1 ? static_cast<OGRGeometryCollection*>(new OGRMultiLineString)
+				: static_cast<OGRGeometryCollection*>(new OGRMultiPoint);
+			for (int i = 0; i < collection->getNumGeometries(); ++i) {
+				std::unique_ptr<OGRGeometry> part(extractDimension(collection->getGeometryRef(i), dimension));
+				if (!part) continue;
+				const OGRGeometryCollection* parts = part->toGeometryCollection();
+				for (int j = 0; j < parts->getNumGeometries(); ++j) result->addGeometry(parts->getGeometryRef(j));
+			}
+			if (result->IsEmpty()) {
+				delete result;
+				return nullptr;
+			}
+			return result;
+		}
+		if (geometry->getDimension() != dimension) return nullptr;
+		switch (dimension) {
+		case 2: return OGRGeometryFactory::forceToMultiPolygon(geometry->clone());
+		case 1: return OGRGeometryFactory::forceToMultiLineString(geometry->clone());
+		default: return OGRGeometryFactory::forceToMultiPoint(geometry->clone());
+		}
+	}
+
+	// 面图层：几何（已变换到输入坐标系）、属性与 R 树
+	struct T_OverlayLayer {
+		std::vector<FeaturePtr> features;
+		std::vector<std::unique_ptr<OGRGeometry>> geometries;
+		SpatialIndex index;
+	};
+
+	// 计算一个输入要素与候选面的叠加结果
+	std::vector<T_OverlayPart> overlayFeature(VectorOverlay::Operation operation, const OGRGeometry* geometry,
+		const T_OverlayLayer& overlay) {
+		std::vector<T_OverlayPart> parts;
+		if (!geometry || geometry->IsEmpty()) return parts;
+		const int dimension = geometry->getDimension();
+
+		// R 树给出外包矩形相交的候选，再用预处理几何精确判断
+		std::vector<int> hits;
+		const QVector<int> candidates = overlay.index.search(envelopeRect(geometry));
+		if (!candidates.isEmpty()) {
+			std::unique_ptr<OGRPreparedGeometry, T_PreparedDeleter> prepared(OGRCreatePreparedGeometry(geometry));
+			for (int candidate : candidates) {
+				const OGRGeometry* other = overlay.geometries[candidate].get();
+				if (prepared ? OGRPreparedGeometryIntersects(prepared.get(), other) : geometry->Intersects(other)) {
+					hits.push_back(candidate);
+				}
+			}
+		}
+
+		if (operation == VectorOverlay::Intersect) {
+			std::sort(hits.begin(), hits.end());
+			for (int hit : hits) {
+				std::unique_ptr<OGRGeometry> intersection(geometry->Intersection(overlay.geometries[hit].get()));
+				OGRGeometry* part = extractDimension(intersection.get(), dimension);
+				if (part) parts.push_back(T_OverlayPart{ std::unique_ptr<OGRGeometry>(part), hit });
+			}
+			return parts;
+		}
+
+		// 裁剪与擦除：与全部相交面的并集运算一次
+		if (hits.empty()) {
+			if (operation == VectorOverlay::Difference) {
+				OGRGeometry* part = extractDimension(geometry, dimension);
+				if (part) parts.push_back(T_OverlayPart{ std::unique_ptr<OGRGeometry>(part), -1 });
+			}
+			return parts;
+		}
+		std::unique_ptr<OGRGeometry> mask;
+		if (hits.size() == 1) {
+			mask.reset(overlay.geometries[hits.front()]->clone());
+		}
+		else {
+			OGRMultiPolygon polygons;
+			for (int hit : hits) {
+				const OGRGeometryCollection* collection = overlay.geometries[hit]->toGeometryCollection();
+				for (int i = 0; i < collection->getNumGeometries(); ++i) polygons.addGeometry(collection->getGeometryRef(i));
+			}
+			mask.reset(polygons.UnionCascaded());
+		}
+		if (!mask) return parts;
+
+		std::unique_ptr<OGRGeometry> result(operation == VectorOverlay::Clip
+			? geometry->Intersection(mask.get()) : geometry->Difference(mask.get()));
+		OGRGeometry* part = extractDimension(result.get(), dimension);
+		if (part) parts.push_back(T_OverlayPart{ std::unique_ptr<OGRGeometry>(part), -1 });
+		return parts;
+	}
+}
+
+QString VectorOverlay::run(Operation operation, const QString& inputPath, const QString& overlayPath, const QString& outputPath,
+	QPromise<QString>* promise) {
+	const QString outputFile = QFileInfo(outputPath).absoluteFilePath();
+	if (outputFile == QFileInfo(inputPath).absoluteFilePath() || outputFile == QFileInfo(overlayPath).absoluteFilePath()) {
+		return QString("输出文件不能覆盖输入图层");
+	}
+
+	DatasetHandle input = DatasetPool::instance().acquire(inputPath);
+	if (!input || !input->GetLayer(0)) return QString("无法打开输入图层：%1").arg(inputPath);
+	DatasetHandle overlaySource = DatasetPool::instance().acquire(overlayPath);
+	if (!overlaySource || !overlaySource->GetLayer(0)) return QString("无法打开面图层：%1").arg(overlayPath);
+	OGRLayer* inputLayer = input->GetLayer(0);
+	OGRLayer* overlayLayer = overlaySource->GetLayer(0);
+
+	const OGRwkbGeometryType overlayType = wkbFlatten(overlayLayer->GetGeomType());
+	if (!OGR_GT_IsSubClassOf(overlayType, wkbCurvePolygon) && !OGR_GT_IsSubClassOf(overlayType, wkbMultiSurface)) {
+		return QString("叠加图层须为面图层");
+	}
+
+	// 面图层坐标系不同时变换到输入坐标系
+	std::unique_ptr<OGRCoordinateTransformation> transform;
+	const OGRSpatialReference* inputSrs = inputLayer->GetSpatialRef();
+	const OGRSpatialReference* overlaySrs = overlayLayer->GetSpatialRef();
+	if (inputSrs && overlaySrs && !inputSrs->IsSame(overlaySrs)) {
+		OGRSpatialReference sourceSrs(*overlaySrs);
+		OGRSpatialReference targetSrs(*inputSrs);
+		sourceSrs.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+		targetSrs.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+		transform.reset(OGRCreateCoordinateTransformation(&sourceSrs, &targetSrs));
+		if (!transform) return QString("无法把面图层变换到输入坐标系");
+	}
+
+	// 面图层整体读入，统一为多面后建立 R 树
+	T_OverlayLayer overlay;
+	overlayLayer->ResetReading();
+	while (OGRFeature* feature = overlayLayer->GetNextFeature()) {
+		FeaturePtr owned(feature);
+		OGRGeometry* geometry = feature->StealGeometry();
+		if (!geometry) continue;
+		if (geometry->hasCurveGeometry()) {
+			OGRGeometry* linear = geometry->getLinearGeometry();
+			delete geometry;
+			geometry = linear;
+		}
+		if (transform && geometry->transform(transform.get()) != OGRERR_NONE) {
+			delete geometry;
+			continue;
+		}
+		std::unique_ptr<OGRGeometry> polygons(extractDimension(geometry, 2));
+		delete geometry;
+		if (!polygons) continue;
+		overlay.index.add(envelopeRect(polygons.get()));
+		overlay.geometries.push_back(std::move(polygons));
+		overlay.features.push_back(std::move(owned));
+	}
+	overlay.index.finish();
+
+	// 输出图层：输入字段（相交时再加面图层字段）
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("ESRI Shapefile");
+	if (!driver) return QString("无法获取 Shapefile 驱动");
+	DatasetPool::instance().prepareOutput(outputPath, driver);
+	GDALDataset* output = driver->Create(outputPath.toUtf8().constData(), 0, 0, 0, GDT_Unknown, nullptr);
+	if (!output) return QString("无法创建输出文件：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+
+	const OGRwkbGeometryType inputType = wkbFlatten(inputLayer->GetGeomType());
+	const OGRwkbGeometryType outputType = OGR_GT_IsSubClassOf(inputType, wkbCurvePolygon) || OGR_GT_IsSubClassOf(inputType, wkbMultiSurface)
+		? wkbMultiPolygon
+		: OGR_GT_IsSubClassOf(inputType, wkbCurve) || OGR_GT_IsSubClassOf(inputType, wkbMultiCurve) ? wkbMultiLineString
+		: inputType == wkbUnknown ? wkbUnknown : wkbMultiPoint;
+	OGRLayer* outputLayer = output->CreateLayer(QFileInfo(outputPath).completeBaseName().toUtf8().constData(),
+		inputLayer->GetSpatialRef(), outputType, nullptr);
+	if (!outputLayer) {
+		GDALClose(output);
+		return QString("无法创建输出图层");
+	}
+
+	// 字段映射按创建后的字段序号记录：驱动可能改写字段名（截短、替换字符），不能再按名称查找
+	auto createField = [outputLayer](OGRFieldDefn* field) {
+		return outputLayer->CreateField(field) == OGRERR_NONE ? outputLayer->GetLayerDefn()->GetFieldCount() - 1 : -1;
+	};
+	OGRFeatureDefn* inputDefn = inputLayer->GetLayerDefn();
+	std::vector<int> inputFieldMap(inputDefn->GetFieldCount());	//输入字段 -> 输出字段
+	for (int i = 0; i < inputDefn->GetFieldCount(); ++i) inputFieldMap[i] = createField(inputDefn->GetFieldDefn(i));
+	std::vector<int> overlayFieldMap;	//面图层字段 -> 输出字段
+	if (operation == Intersect) {
+		OGRFeatureDefn* overlayDefn = overlayLayer->GetLayerDefn();
+		for (int i = 0; i < overlayDefn->GetFieldCount(); ++i) {
+			OGRFieldDefn field(overlayDefn->GetFieldDefn(i));
+			// Shapefile 字段名最长 10 个字符：先截短，重名时再截短后加序号
+			const QString original = QString::fromUtf8(field.GetNameRef());
+			QString name = original.left(10);
+			for (int suffix = 1; outputLayer->GetLayerDefn()->GetFieldIndex(name.toUtf8().constData()) >= 0; ++suffix) {
+				const QString tail = QString("_%1").arg(suffix);
+				name = original.left(10 - tail.size()) + tail;
+			}
+			field.SetName(name.toUtf8().constData());
+			overlayFieldMap.push_back(createField(&field));
+		}
+	}
+
+	const qint64 featureTotal = inputLayer->GetFeatureCount();
+	if (promise && featureTotal > 0) promise->setProgressRange(0, static_cast<int>(std::min<qint64>(featureTotal, INT_MAX)));
+
+	// 分批：读取（当前线程）-> 并行计算 -> 按输入顺序在一个事务内写出
+	QString error;
+	qint64 processed = 0;
+	std::vector<FeaturePtr> batch;
+	std::vector<std::vector<T_OverlayPart>> results;
+	QVector<int> indices;
+	inputLayer->ResetReading();
+	bool finished = false;
+	while (!finished && error.isEmpty()) {
+		if (promise && promise->isCanceled()) break;
+
+		batch.clear();
+		while (static_cast<int>(batch.size()) < kBatchSize) {
+			OGRFeature* feature = inputLayer->GetNextFeature();
+			if (!feature) {
+				finished = true;
+				break;
+			}
+			if (OGRGeometry* geometry = feature->GetGeometryRef()) {
+				if (geometry->hasCurveGeometry()) feature->SetGeometryDirectly(geometry->getLinearGeometry());
+			}
+			batch.push_back(FeaturePtr(feature));
+		}
+		if (batch.empty()) break;
+
+		results.assign(batch.size(), std::vector<T_OverlayPart>());
+		indices.resize(static_cast<int>(batch.size()));
+		for (int i = 0; i < indices.size(); ++i) indices[i] = i;
+		QtConcurrent::blockingMap(GdalRuntime::analysisPool(), indices, [&](int slot) {
+			results[slot] = overlayFeature(operation, batch[slot]->GetGeometryRef(), overlay);
+			});
+
+		output->StartTransaction();
+		for (size_t i = 0; i < batch.size() && error.isEmpty(); ++i) {
+			for (T_OverlayPart& part : results[i]) {
+				OGRFeature feature(outputLayer->GetLayerDefn());
+				feature.SetFieldsFrom(batch[i].get(), inputFieldMap.data());
+				if (part.overlayIndex >= 0) {
+					const OGRFeature* overlayFeature = overlay.features[part.overlayIndex].get();
+					for (size_t f = 0; f < overlayFieldMap.size(); ++f) {
+						if (overlayFieldMap[f] >= 0 && overlayFeature->IsFieldSetAndNotNull(static_cast<int>(f))) {
+							feature.SetField(overlayFieldMap[f], overlayFeature->GetRawFieldRef(static_cast<int>(f)));
+						}
+					}
+				}
+				feature.SetGeometryDirectly(part.geometry.release());
+				if (outputLayer->CreateFeature(&feature) != OGRERR_NONE) {
+					error = QString("写入要素失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+					break;
+				}
+			}
+		}
+		output->CommitTransaction();
+
+		processed += static_cast<qint64>(batch.size());
+		if (promise) promise->setProgressValue(static_cast<int>(std::min<qint64>(processed, INT_MAX)));
+	}
+	batch.clear();
+	GDALClose(output);
+
+	if (error.isEmpty() && promise && promise->isCanceled()) error = QString("已取消");
+	if (!error.isEmpty()) {
+		CPLPushErrorHandler(CPLQuietErrorHandler);
+		driver->Delete(outputPath.toUtf8().constData());
+		CPLPopErrorHandler();
+	}
+	return error;
+}
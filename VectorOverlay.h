@@ -0,0 +1,22 @@
+#pragma once
+#include <QString>
+
+template<typename T> class QPromise;
+
+// 矢量叠加分析：输入图层（任意几何）与面图层求交、裁剪、擦除。
+// 面图层整体读入并建立 R 树，输入图层分批流式读取；每个输入要素只与 R 树给出的候选面比较，
+// 先用预处理几何（prepared geometry）快速判断相交，再做精确的几何运算。各批在工作线程中并行计算，
+// 结果按输入顺序分批写出
+namespace VectorOverlay {
+	enum Operation {
+		Intersect,	//相交部分，属性为两图层字段之和（重名的面图层字段加后缀）
+		Clip,	//输入要素落在面内的部分，只保留输入字段
+		Difference	//输入要素落在面外的部分，只保留输入字段
+	};
+
+	// 输出 Shapefile，几何类型与输入相同（统一为多部件）。面图层坐标系不同时变换到输入坐标系。
+	// 成功返回空字符串，否则返回错误信息。promise 非空时汇报进度（已处理的输入要素数）并响应取消。
+	// 耗时较长，应在后台线程调用
+	QString run(Operation operation, const QString& inputPath, const QString& overlayPath, const QString& outputPath,
+		QPromise<QString>* promise = nullptr);
+}
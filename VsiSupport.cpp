@@ -0,0 +1,66 @@
+#include "VsiSupport.h"
+#include <QFileInfo>
+#include <QUrl>
+#include <cpl_conv.h>
+#include <cpl_vsi.h>
+
+namespace {
+	const QStringList kDataSuffixes = { "tif", "tiff", "vrt", "shp" };
+}
+
+bool VsiSupport::isVirtualPath(const QString& path) {
+	return path.startsWith("/vsi");
+}
+
+QString VsiSupport::toGdalPath(const QString& input) {
+	const QString path = input.trimmed();
+	if (isVirtualPath(path)) return path;
+	if (path.startsWith("http://", Qt::CaseInsensitive) || path.startsWith("https://", Qt::CaseInsensitive)) {
+		return "/vsicurl/" + path;
+	}
+	if (path.endsWith(".gz", Qt::CaseInsensitive) && !path.endsWith(".tar.gz", Qt::CaseInsensitive)) {
+		return "/vsigzip/" + path;
+	}
+	return path;
+}
+
+QStringList VsiSupport::expandArchive(const QString& localPath) {
+	const QString lower = localPath.toLower();
+	QString prefix;
+	if (lower.endsWith(".zip")) {
+		prefix = "/vsizip/";
+	}
+	else if (lower.endsWith(".tar") || lower.endsWith(".tgz") || lower.endsWith(".tar.gz")) {
+		prefix = "/vsitar/";
+	}
+	else if (lower.endsWith(".gz")) {
+		return QStringList{ "/vsigzip/" + localPath };	//单个压缩文件
+	}
+	else {
+		return QStringList();
+	}
+
+	// 列出压缩包内的全部文件，只保留可加载的数据文件
+	const QString archive = prefix + localPath;
+	QStringList paths;
+	char** entries = VSIReadDirRecursive(archive.toUtf8().constData());
+	for (char** entry = entries; entry && *entry; ++entry) {
+		const QString name = QString::fromUtf8(*entry);
+		if (kDataSuffixes.contains(QFileInfo(name).suffix().toLower())) {
+			paths.append(archive + "/" + name);
+		}
+	}
+	CSLDestroy(entries);
+	return paths;
+}
+
+QString VsiSupport::layerSuffix(const QString& path) {
+	QString name = path;
+	if (path.startsWith("/vsicurl/")) {
+		name = QUrl(path.mid(9)).path();	//去掉查询参数
+	}
+	else if (path.startsWith("/vsigzip/") && name.endsWith(".gz", Qt::CaseInsensitive)) {
+		name.chop(3);
+	}
+	return QFileInfo(name).suffix().toLower();
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+
+// GDAL 虚拟文件系统路径：/vsizip、/vsitar、/vsigzip 读取压缩包，/vsicurl 按需以 HTTP Range 请求读取远程文件。
+// 配合 COG（云优化 GeoTIFF）时，只下载当前视图所需的金字塔块
+namespace VsiSupport {
+	bool isVirtualPath(const QString& path);	//以 /vsi 开头的 GDAL 路径
+
+	// 用户输入转换为 GDAL 路径：http(s):// -> /vsicurl/，本地 .gz -> /vsigzip/，其余原样返回
+	QString toGdalPath(const QString& input);
+
+	// 本地压缩包（.zip / .tar / .tgz / .gz）展开为其中的数据文件路径；不是压缩包时返回空列表
+	QStringList expandArchive(const QString& localPath);
+
+	// 路径中数据文件本身的扩展名（忽略 /vsigzip 的 .gz 与 URL 查询参数）
+	QString layerSuffix(const QString& path);
+}
@@ -3,6 +3,16 @@
 #include <gdal.h>
 #include <gdal_priv.h>
 #include <ogrsf_frmts.h>
+#include <QActionGroup>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+#include "RenderProfiler.h"
+#include "GdalRuntime.h"
+#include "GdalSettingsDialog.h"
+#include "ProjectSession.h"
 #include "YGIS.h"
 
 YGIS::YGIS(QWidget* parent) : QMainWindow(parent) {
@@ -30,38 +40,184 @@ YGIS::YGIS(QWidget* parent) : QMainWindow(parent) {
     // 设置最小尺寸
     setMinimumSize(800, 600);
 
-    // 初始化GDAL/OGR库 
-    GDALAllRegister();
-    OGRRegisterAll();
+    // 注册 GDAL/OGR 驱动并应用块缓存、线程数与虚拟文件系统设置（只执行一次）
+    GdalRuntime::initialize();
 
 /*----------------------------------------------------------以下为信号槽连接部分----------------------------------------------------------------*/
 
     connect(m_openFileAction, &QAction::triggered, m_fileWidget, &FileWidget::appendFile);  //打开并添加文件
+    connect(m_openFolderAction, &QAction::triggered, m_fileWidget, &FileWidget::appendFolder);  //添加文件夹中的全部文件
+    connect(m_openPathAction, &QAction::triggered, m_fileWidget, &FileWidget::appendVirtualPath);  //打开压缩包内或远程文件
+    connect(m_newMosaicAction, &QAction::triggered, m_fileWidget, &FileWidget::newMosaic);  //由一组栅格生成镶嵌图层
+    connect(m_openProjectAction, &QAction::triggered, this, [=] {
+        QString projectPath = QFileDialog::getOpenFileName(this, "打开工程", m_projectPath, "YGIS 工程 (*.ygis)");
+        if (!projectPath.isEmpty()) openProject(projectPath);
+        });
+    connect(m_saveProjectAction, &QAction::triggered, this, [=] {
+        QString projectPath = QFileDialog::getSaveFileName(this, "保存工程",
+            m_projectPath.isEmpty() ? "project.ygis" : m_projectPath, "YGIS 工程 (*.ygis)");
+        if (!projectPath.isEmpty()) saveProject(projectPath);
+        });
     connect(m_fileWidget, &FileWidget::filePathDelivered, m_textWidget, &TextWidget::dataPathReceived);  //传输路径给编辑框  
     connect(m_fileWidget, &FileWidget::fileListUpdated, m_mapWidget, &MapWidget::updateFilePathList); //同步文件列表与mapCanvas文件列表
+    connect(m_fileWidget, &FileWidget::layerDataChanged, m_mapWidget, &MapWidget::reloadLayer); //图层数据修改后重建该图层
     connect(m_fileWidget, &FileWidget::bufferPathDeliverer, m_mapWidget, &MapWidget::bufferVector);  //传输生成缓冲区的矢量路径
     connect(m_mapWidget, &MapWidget::bufferCompleted, m_fileWidget, &FileWidget::addBufferFile);
+    connect(m_mapWidget, &MapWidget::featuresSelected, m_fileWidget, &FileWidget::selectFeatures);  //地图选择同步到要素表
+    connect(m_fileWidget, &FileWidget::featuresSelected, m_mapWidget, &MapWidget::highlightFeatures);  //要素表选择同步到地图
+    connect(m_panToolAction, &QAction::triggered, this, [=] { m_mapWidget->setMapTool(MapCanvas::PanTool); });
+    connect(m_selectToolAction, &QAction::triggered, this, [=] { m_mapWidget->setMapTool(MapCanvas::SelectTool); });
+    connect(m_clipToolAction, &QAction::triggered, this, [=] { m_mapWidget->setMapTool(MapCanvas::ClipTool); });
+    connect(m_identifyToolAction, &QAction::triggered, this, [=] { m_mapWidget->setMapTool(MapCanvas::IdentifyTool); });
+    connect(m_profileToolAction, &QAction::triggered, this, [=] { m_mapWidget->setMapTool(MapCanvas::ProfileTool); });
+    connect(m_mapWidget, &MapWidget::clipExtentRequested, m_fileWidget, &FileWidget::clipRasterToExtent);  //框选范围裁剪栅格
+    connect(m_profilerAction, &QAction::toggled, m_mapWidget, &MapWidget::setProfilerVisible);  //性能统计叠加层
+    connect(m_gdalSettingsAction, &QAction::triggered, this, [=] {
+        GdalSettingsDialog dialog(this);
+        dialog.exec();
+        });
+    connect(m_exportTraceAction, &QAction::triggered, this, [=] {
+        QString tracePath = QFileDialog::getSaveFileName(this, "导出性能跟踪", "render_trace.json", "JSON (*.json)");
+        if (tracePath.isEmpty()) return;
+        if (!RenderProfiler::instance().writeTrace(tracePath)) {
+            QMessageBox::critical(this, "错误", QString("无法写入文件：\n%1").arg(tracePath));
+        }
+        });
 }
 
 YGIS::~YGIS()
 {}
 
+bool YGIS::openProject(const QString& projectPath) {
+    T_Project project;
+    const QString error = ProjectSession::load(projectPath, project);
+    if (!error.isEmpty()) {
+        QMessageBox::critical(this, "错误", error);
+        return false;
+    }
+
+    // 先设置缓存目录与视图范围，随后加入的图层按保存时的状态显示
+    const QString cacheDir = ProjectSession::cacheDirectory(projectPath);
+    m_mapWidget->setProjectCacheDirectory(QFileInfo(cacheDir).isDir() ? cacheDir : QString());
+    m_mapWidget->setViewExtent(project.viewExtent);
+    m_fileWidget->restoreLayers(project.layers);
+
+    m_projectPath = projectPath;
+    updateProjectTitle(project.crsName);
+    return true;
+}
+
+void YGIS::updateProjectTitle(const QString& crsName) {
+    setWindowTitle(QString("YGIS - %1%2").arg(QFileInfo(m_projectPath).completeBaseName())
+        .arg(crsName.isEmpty() ? QString() : QString(" [%1]").arg(crsName)));
+}
+
+bool YGIS::saveProject(const QString& projectPath) {
+    T_Project project;
+    project.layers = m_fileWidget->projectLayers();
+    project.viewExtent = m_mapWidget->viewExtent();
+    // 地图不做投影变换，以第一个带坐标系的图层为准
+    for (const T_ProjectLayer& layer : project.layers) {
+        if (layer.metadata.crsWkt.isEmpty()) continue;
+        project.crsName = layer.metadata.crsName;
+        project.crsWkt = layer.metadata.crsWkt;
+        break;
+    }
+
+    const QString error = ProjectSession::save(projectPath, project);
+    if (!error.isEmpty()) {
+        QMessageBox::critical(this, "错误", error);
+        return false;
+    }
+
+    const QString cacheDir = ProjectSession::cacheDirectory(projectPath);
+    if (m_projectCacheAction->isChecked()) {
+        // 缓存只对应当前图层列表：清掉移除的图层与源文件已变化的子目录，其余合并
+        QStringList filePaths;
+        for (const T_ProjectLayer& layer : project.layers) filePaths.append(layer.filePath);
+        ProjectSession::pruneTileCache(cacheDir, filePaths);
+        const int layers = m_mapWidget->saveTileCache(cacheDir);
+        qDebug() << "已保存渲染缓存：" << layers << "个图层";
+        m_mapWidget->setProjectCacheDirectory(cacheDir);
+    }
+    else {
+        m_mapWidget->setProjectCacheDirectory(QString());
+        QDir(cacheDir).removeRecursively();
+    }
+
+    m_projectPath = projectPath;
+    updateProjectTitle(project.crsName);
+    return true;
+}
+
 void YGIS::createMenus() {
     // 获取主窗口的菜单栏（自动创建）
     QMenuBar* mainMenuBar = menuBar();
 
     // 创建菜单
     QMenu* fileMenu = mainMenuBar->addMenu(tr("&File"));
+    QMenu* toolMenu = mainMenuBar->addMenu(tr("&Tools"));
+    QMenu* viewMenu = mainMenuBar->addMenu(tr("&View"));
     QMenu* aboutMenu = mainMenuBar->addMenu(tr("&About"));
 
     // 创建菜单项
     m_openFileAction = new QAction(tr("&Open File"), this);
+    m_openFolderAction = new QAction(tr("Open &Folder"), this);
+    m_openPathAction = new QAction(tr("Open &Path or URL..."), this);
+    m_newMosaicAction = new QAction(tr("New &Mosaic..."), this);
+    m_openProjectAction = new QAction(tr("Open Pro&ject..."), this);
+    m_saveProjectAction = new QAction(tr("&Save Project..."), this);
+    m_projectCacheAction = new QAction(tr("Save Render &Cache with Project"), this);
+    m_projectCacheAction->setCheckable(true);
+    m_projectCacheAction->setChecked(true);
     m_refreshAction = new QAction(tr("&Refresh"), this);
 
     // 添加菜单项到 File 菜单
     fileMenu->addAction(m_openFileAction);
+    fileMenu->addAction(m_openFolderAction);
+    fileMenu->addAction(m_openPathAction);
+    fileMenu->addAction(m_newMosaicAction);
+    fileMenu->addSeparator();
+    fileMenu->addAction(m_openProjectAction);
+    fileMenu->addAction(m_saveProjectAction);
+    fileMenu->addAction(m_projectCacheAction);
+    fileMenu->addSeparator();
     fileMenu->addAction(m_refreshAction);
 
+    // 地图工具（互斥）
+    m_panToolAction = new QAction(tr("&Pan"), this);
+    m_selectToolAction = new QAction(tr("&Select Features"), this);
+    m_clipToolAction = new QAction(tr("&Clip Raster by Rectangle"), this);
+    m_identifyToolAction = new QAction(tr("&Identify Pixel"), this);
+    m_profileToolAction = new QAction(tr("Raster &Profile"), this);
+    m_panToolAction->setCheckable(true);
+    m_selectToolAction->setCheckable(true);
+    m_clipToolAction->setCheckable(true);
+    m_identifyToolAction->setCheckable(true);
+    m_profileToolAction->setCheckable(true);
+    m_panToolAction->setChecked(true);
+    QActionGroup* toolGroup = new QActionGroup(this);
+    toolGroup->addAction(m_panToolAction);
+    toolGroup->addAction(m_selectToolAction);
+    toolGroup->addAction(m_clipToolAction);
+    toolGroup->addAction(m_identifyToolAction);
+    toolGroup->addAction(m_profileToolAction);
+    toolMenu->addAction(m_panToolAction);
+    toolMenu->addAction(m_selectToolAction);
+    toolMenu->addAction(m_clipToolAction);
+    toolMenu->addAction(m_identifyToolAction);
+    toolMenu->addAction(m_profileToolAction);
+    toolMenu->addSeparator();
+    m_gdalSettingsAction = new QAction(tr("&GDAL Settings..."), this);
+    toolMenu->addAction(m_gdalSettingsAction);
+
+    // 性能统计
+    m_profilerAction = new QAction(tr("&Profiler Overlay"), this);
+    m_profilerAction->setCheckable(true);
+    m_exportTraceAction = new QAction(tr("&Export Render Trace..."), this);
+    viewMenu->addAction(m_profilerAction);
+    viewMenu->addAction(m_exportTraceAction);
+
     // 添加分隔线
     //fileMenu->addSeparator();
 }
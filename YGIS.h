@@ -20,12 +20,32 @@ public:
 
     void createMenus();
 
+    bool openProject(const QString& projectPath); // 恢复图层列表、样式与视图范围
+    bool saveProject(const QString& projectPath);
+
 
 private:
+    void updateProjectTitle(const QString& crsName); // 标题显示工程名与坐标系
+
     QAction* m_openFileAction;
+    QAction* m_openFolderAction;
+    QAction* m_openPathAction;
+    QAction* m_newMosaicAction;
+    QAction* m_openProjectAction;
+    QAction* m_saveProjectAction;
+    QAction* m_projectCacheAction; // 保存工程时是否一并保存渲染缓存
     QAction* m_refreshAction;
+    QAction* m_panToolAction;
+    QAction* m_selectToolAction;
+    QAction* m_clipToolAction;
+    QAction* m_identifyToolAction;
+    QAction* m_profileToolAction;
+    QAction* m_gdalSettingsAction; // 块缓存、线程数与 I/O 选项
+    QAction* m_profilerAction;
+    QAction* m_exportTraceAction;
 
     MapWidget* m_mapWidget;
     FileWidget* m_fileWidget;
     TextWidget* m_textWidget;
+    QString m_projectPath; // 当前工程文件
 };
@@ -0,0 +1,325 @@
+#include "ZonalStatistics.h"
+#include <QPromise>
+#include <QFileInfo>
+#include <QMutex>
+#include <QPointF>
+#include <QRect>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+#include <ogr_spatialref.h>
+#include "DatasetPool.h"
+#include "GdalRuntime.h"
+
+namespace {
+	const int kWindowPixels = 1 << 20;	//每次读取的像素上限
+	const int kBatchSize = 64;	//每批要素数
+
+	struct T_FeatureDeleter {
+		void operator()(OGRFeature* feature) const { OGRFeature::DestroyFeature(feature); }
+	};
+
+	// 一个分区（面要素）
+	struct T_Zone {
+		std::unique_ptr<OGRFeature, T_FeatureDeleter> feature;	//原要素，输出时原样写出
+		std::vector<QPointF> vertices;	//全部环的顶点（像素坐标）
+		std::vector<int> ringEnds;	//环 i 的顶点为 [ringEnds[i - 1], ringEnds[i])
+		QRect window;	//像素外包窗口（已裁剪到栅格范围），为空表示与栅格不相交
+
+		qint64 count = 0;
+		double sum = 0.0;
+		double min = std::numeric_limits<double>::infinity();
+		double max = -std::numeric_limits<double>::infinity();
+	};
+
+	// 扫描线的一条边，y0 < y1
+	struct T_Edge {
+		double y0, y1;
+		double x0;	//y0 处的 x
+		double slope;	//dx / dy
+	};
+
+	// 一行中落在面内的像元 [column0, column1)
+	struct T_Span {
+		int row;
+		int column0, column1;
+	};
+
+	// 收集面（含多面、集合）的全部环，转为像素坐标
+	void collectRings(const OGRGeometry* geometry, const double* geoTransform, T_Zone& zone) {
+		const OGRwkbGeometryType type = wkbFlatten(geometry->getGeometryType());
+		if (type == wkbPolygon) {
+			const OGRPolygon* polygon = geometry->toPolygon();
+			for (int r = -1; r < polygon->getNumInteriorRings(); ++r) {
+				const OGRLinearRing* ring = r < 0 ? polygon->getExteriorRing() : polygon->getInteriorRing(r);
+				if (!ring || ring->getNumPoints() < 3) continue;
+				for (int i = 0; i < ring->getNumPoints(); ++i) {
+					zone.vertices.emplace_back((ring->getX(i) - geoTransform[0]) / geoTransform[1],
+						(ring->getY(i) - geoTransform[3]) / geoTransform[5]);
+				}
+				zone.ringEnds.push_back(static_cast<int>(zone.vertices.size()));
+			}
+		}
+		else if (OGR_GT_IsSubClassOf(type, wkbGeometryCollection)) {
+			const OGRGeometryCollection* collection = geometry->toGeometryCollection();
+			for (int i = 0; i < collection->getNumGeometries(); ++i) {
+				collectRings(collection->getGeometryRef(i), geoTransform, zone);
+			}
+		}
+	}
+
+	// 统计一个分区：逐行求面内的像元区间，按块对齐的行段读取并累加
+	bool accumulateZone(T_Zone& zone, GDALRasterBand* band, int blockHeight, bool hasNoData, double noData,
+		std::vector<double>& buffer) {
+		std::vector<T_Edge> edges;
+		int begin = 0;
+		for (int end : zone.ringEnds) {
+			for (int i = begin; i < end; ++i) {
+				const QPointF& a = zone.vertices[i];
+				const QPointF& b = zone.vertices[i + 1 < end ? i + 1 : begin];
+				if (a.y() == b.y()) continue;
+				const QPointF& low = a.y() < b.y() ? a : b;
+				const QPointF& high = a.y() < b.y() ? b : a;
+				edges.push_back(T_Edge{ low.y(), high.y(), low.x(), (high.x() - low.x()) / (high.y() - low.y()) });
+			}
+			begin = end;
+		}
+		std::sort(edges.begin(), edges.end(), [](const T_Edge& a, const T_Edge& b) { return a.y0 < b.y0; });
+
+		const QRect& window = zone.window;
+		const int chunkRows = std::max(blockHeight, kWindowPixels / std::max(1, window.width()) / blockHeight * blockHeight);
+		std::vector<const T_Edge*> active;
+		std::vector<double> crossings;
+		std::vector<T_Span> spans;
+		size_t nextEdge = 0;
+
+		// 行段的起点对齐到块边界，同一块只被一个行段读取
+		int chunkTop = window.top();
+		while (chunkTop <= window.bottom()) {
+			const int chunkBottom = std::min(window.bottom() + 1, (chunkTop / blockHeight) * blockHeight + chunkRows);
+			spans.clear();
+			int column0 = window.right() + 1, column1 = window.left();
+			for (int row = chunkTop; row < chunkBottom; ++row) {
+				const double y = row + 0.5;	//像元中心
+				while (nextEdge < edges.size() && edges[nextEdge].y0 <= y) active.push_back(&edges[nextEdge++]);
+				active.erase(std::remove_if(active.begin(), active.end(), [y](const T_Edge* e) { return e->y1 <= y; }), active.end());
+
+				crossings.clear();
+				for (const T_Edge* e : active) crossings.push_back(e->x0 + (y - e->y0) * e->slope);
+				std::sort(crossings.begin(), crossings.end());
+				for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+					const int c0 = std::max(window.left(), static_cast<int>(std::ceil(crossings[i] - 0.5)));
+					const int c1 = std::min(window.right() + 1, static_cast<int>(std::ceil(crossings[i + 1] - 0.5)));
+					if (c0 >= c1) continue;
+					spans.push_back(T_Span{ row, c0, c1 });
+					column0 = std::min(column0, c0);
+					column1 = std::max(column1, c1);
+				}
+			}
+
+			// 面没有覆盖这一行段时不读取
+			if (!spans.empty()) {
+				const int top = spans.front().row;
+				const int rows = spans.back().row - top + 1;
+				const int columns = column1 - column0;
+				buffer.resize(static_cast<size_t>(rows) * columns);
+				if (band->RasterIO(GF_Read, column0, top, columns, rows, buffer.data(), columns, rows,
+					GDT_Float64, 0, 0, nullptr) != CE_None) {
+					return false;
+				}
+				for (const T_Span& span : spans) {
+					const double* line = buffer.data() + static_cast<size_t>(span.row - top) * columns - column0;
+					for (int c = span.column0; c < span.column1; ++c) {
+						const double value = line[c];
+						if (std::isnan(value) || (hasNoData && value == noData)) continue;
+						++zone.count;
+						zone.sum += value;
+						zone.min = std::min(zone.min, value);
+						zone.max = std::max(zone.max, value);
+					}
+				}
+			}
+			chunkTop = chunkBottom;
+		}
+		return true;
+	}
+}
+
+QString ZonalStatistics::compute(const QString& rasterPath, int bandIndex, const QString& zonePath, const QString& outputPath,
+	QPromise<QString>* promise) {
+	if (QFileInfo(outputPath).absoluteFilePath() == QFileInfo(zonePath).absoluteFilePath()) {
+		return QString("输出文件不能覆盖面图层");
+	}
+
+	// 栅格参数
+	DatasetHandle raster = DatasetPool::instance().acquire(rasterPath);
+	if (!raster) return QString("无法打开栅格：%1").arg(rasterPath);
+	if (bandIndex < 1 || bandIndex > raster->GetRasterCount()) return QString("波段 %1 不存在").arg(bandIndex);
+	double geoTransform[6];
+	if (raster->GetGeoTransform(geoTransform) != CE_None) return QString("栅格没有地理参考");
+	if (geoTransform[2] != 0.0 || geoTransform[4] != 0.0) return QString("不支持带旋转的栅格");
+	const QRect rasterRect(0, 0, raster->GetRasterXSize(), raster->GetRasterYSize());
+	int blockWidth = 0, blockHeight = 0;
+	raster->GetRasterBand(bandIndex)->GetBlockSize(&blockWidth, &blockHeight);
+	blockHeight = std::max(1, blockHeight);
+	int noDataSet = FALSE;
+	const double noData = raster->GetRasterBand(bandIndex)->GetNoDataValue(&noDataSet);
+	OGRSpatialReference rasterSrs;
+	const char* rasterWkt = raster->GetProjectionRef();
+	const bool hasRasterSrs = rasterWkt && rasterWkt[0] && rasterSrs.importFromWkt(rasterWkt) == OGRERR_NONE;
+	raster.reset();
+
+	// 读取全部面要素；坐标系不同时变换到栅格坐标系
+	DatasetHandle zones = DatasetPool::instance().acquire(zonePath);
+	if (!zones || !zones->GetLayer(0)) return QString("无法打开面图层：%1").arg(zonePath);
+	OGRLayer* zoneLayer = zones->GetLayer(0);
+
+	std::unique_ptr<OGRCoordinateTransformation> transform;
+	const OGRSpatialReference* zoneSrs = zoneLayer->GetSpatialRef();
+	if (hasRasterSrs && zoneSrs && !zoneSrs->IsSame(&rasterSrs)) {
+		OGRSpatialReference source(*zoneSrs);
+		source.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+		rasterSrs.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+		transform.reset(OGRCreateCoordinateTransformation(&source, &rasterSrs));
+		if (!transform) return QString("无法把面图层变换到栅格坐标系");
+	}
+
+	std::vector<T_Zone> zoneList;
+	zoneLayer->ResetReading();
+	while (OGRFeature* feature = zoneLayer->GetNextFeature()) {
+		T_Zone zone;
+		zone.feature.reset(feature);
+		if (const OGRGeometry* geometry = feature->GetGeometryRef()) {
+			std::unique_ptr<OGRGeometry> linear;
+			if (geometry->hasCurveGeometry()) {
+				linear.reset(geometry->getLinearGeometry());
+				geometry = linear.get();
+			}
+			if (transform) {
+				if (!linear) linear.reset(geometry->clone());
+				if (linear->transform(transform.get()) != OGRERR_NONE) linear.reset();
+				geometry = linear.get();
+			}
+			if (geometry) collectRings(geometry, geoTransform, zone);
+		}
+		if (!zone.vertices.empty()) {
+			double x0 = zone.vertices.front().x(), x1 = x0, y0 = zone.vertices.front().y(), y1 = y0;
+			for (const QPointF& p : zone.vertices) {
+				x0 = std::min(x0, p.x()); x1 = std::max(x1, p.x());
+				y0 = std::min(y0, p.y()); y1 = std::max(y1, p.y());
+			}
+			const QRect bounds(QPoint(static_cast<int>(std::floor(x0)), static_cast<int>(std::floor(y0))),
+				QPoint(static_cast<int>(std::ceil(x1)) - 1, static_cast<int>(std::ceil(y1)) - 1));
+			zone.window = bounds.intersected(rasterRect);
+		}
+		zoneList.push_back(std::move(zone));
+	}
+
+	// 按块行、列排序后分批，同一批的相邻要素大多落在相同的块上
+	std::vector<int> order;
+	for (int i = 0; i < static_cast<int>(zoneList.size()); ++i) {
+		if (!zoneList[i].window.isEmpty()) order.push_back(i);
+	}
+	std::sort(order.begin(), order.end(), [&zoneList, blockHeight](int a, int b) {
+		const QRect& wa = zoneList[a].window;
+		const QRect& wb = zoneList[b].window;
+		const int ra = wa.top() / blockHeight, rb = wb.top() / blockHeight;
+		return ra != rb ? ra < rb : wa.left() < wb.left();
+	});
+	QVector<QPair<int, int>> batches;
+	for (int i = 0; i < static_cast<int>(order.size()); i += kBatchSize) {
+		batches.append(qMakePair(i, std::min(static_cast<int>(order.size()), i + kBatchSize)));
+	}
+	if (promise) promise->setProgressRange(0, batches.size());
+
+	QMutex errorMutex;
+	QString workerError;
+	std::atomic<bool> failed(false);
+	std::atomic<int> finished(0);
+	QtConcurrent::blockingMap(GdalRuntime::analysisPool(), batches, [&](const QPair<int, int>& batch) {
+		if (failed.load() || (promise && promise->isCanceled())) return;
+
+		// 每个工作线程使用自己的栅格句柄
+		DatasetHandle dataset = DatasetPool::instance().acquire(rasterPath);
+		GDALRasterBand* band = dataset ? dataset->GetRasterBand(bandIndex) : nullptr;
+		thread_local std::vector<double> buffer;
+		for (int i = batch.first; band && i < batch.second; ++i) {
+			if (!accumulateZone(zoneList[order[i]], band, blockHeight, noDataSet, noData, buffer)) band = nullptr;
+		}
+		if (!band) {
+			QMutexLocker locker(&errorMutex);
+			if (!failed.exchange(true)) workerError = QString("读取栅格失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+			return;
+		}
+		if (promise) promise->setProgressValue(++finished);
+		});
+	if (promise && promise->isCanceled()) return QString("已取消");
+	if (failed.load()) return workerError;
+
+	// 写出：原字段 + 统计字段，一个事务内批量写入
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("ESRI Shapefile");
+	if (!driver) return QString("无法获取 Shapefile 驱动");
+	DatasetPool::instance().prepareOutput(outputPath, driver);
+	GDALDataset* output = driver->Create(outputPath.toUtf8().constData(), 0, 0, 0, GDT_Unknown, nullptr);
+	if (!output) return QString("无法创建输出文件：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+
+	OGRLayer* outputLayer = output->CreateLayer(QFileInfo(outputPath).completeBaseName().toUtf8().constData(),
+		zoneLayer->GetSpatialRef(), zoneLayer->GetGeomType(), nullptr);
+	if (!outputLayer) {
+		GDALClose(output);
+		return QString("无法创建输出图层");
+	}
+	// 按实际创建的位置记录输出字段，驱动拒绝的字段映射为 -1，不会错位
+	auto createField = [outputLayer](OGRFieldDefn* field) {
+		return outputLayer->CreateField(field) == OGRERR_NONE ? outputLayer->GetLayerDefn()->GetFieldCount() - 1 : -1;
+	};
+	OGRFeatureDefn* zoneDefn = zoneLayer->GetLayerDefn();
+	std::vector<int> fieldMap(zoneDefn->GetFieldCount());	//面图层字段 -> 输出字段
+	for (int i = 0; i < zoneDefn->GetFieldCount(); ++i) fieldMap[i] = createField(zoneDefn->GetFieldDefn(i));
+
+	// 面图层已带统计字段（如对结果再次统计）时覆盖原值
+	const char* statNames[] = { "zs_count", "zs_sum", "zs_mean", "zs_min", "zs_max" };
+	int statFields[5];
+	for (int i = 0; i < 5; ++i) {
+		statFields[i] = outputLayer->GetLayerDefn()->GetFieldIndex(statNames[i]);
+		if (statFields[i] < 0) {
+			OGRFieldDefn field(statNames[i], i == 0 ? OFTInteger64 : OFTReal);
+			statFields[i] = createField(&field);
+			if (statFields[i] < 0) {
+				GDALClose(output);
+				return QString("无法创建字段 %1").arg(statNames[i]);
+			}
+		}
+	}
+
+	QString error;
+	output->StartTransaction();
+	for (const T_Zone& zone : zoneList) {
+		OGRFeature feature(outputLayer->GetLayerDefn());
+		feature.SetFrom(zone.feature.get(), fieldMap.data());
+		feature.SetField(statFields[0], static_cast<GIntBig>(zone.count));
+		if (zone.count > 0) {
+			feature.SetField(statFields[1], zone.sum);
+			feature.SetField(statFields[2], zone.sum / zone.count);
+			feature.SetField(statFields[3], zone.min);
+			feature.SetField(statFields[4], zone.max);
+		}
+		else {
+			for (int i = 1; i < 5; ++i) feature.SetFieldNull(statFields[i]);
+		}
+		if (outputLayer->CreateFeature(&feature) != OGRERR_NONE) {
+			error = QString("写入要素失败：%1").arg(QString::fromUtf8(CPLGetLastErrorMsg()));
+			break;
+		}
+	}
+	output->CommitTransaction();
+	GDALClose(output);
+	return error;
+}
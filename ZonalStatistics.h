@@ -0,0 +1,15 @@
+#pragma once
+#include <QString>
+
+template<typename T> class QPromise;
+
+// 分区统计：对面图层的每个要素统计栅格一个波段的像素数、总和、均值、最小值与最大值。
+// 面在各自的外包窗口内逐行栅格化（像元中心落在面内即计入），只读取被面覆盖的块；
+// 要素按空间顺序分批并行处理，同一批相邻要素共用工作线程的块缓存
+namespace ZonalStatistics {
+	// 输出 Shapefile 保留面图层的全部字段与几何，追加 zs_count、zs_sum、zs_mean、zs_min、zs_max。
+	// 面图层与栅格坐标系不同时先把面变换到栅格坐标系。成功返回空字符串，否则返回错误信息。
+	// promise 非空时汇报进度（批次数）并响应取消。耗时较长，应在后台线程调用
+	QString compute(const QString& rasterPath, int bandIndex, const QString& zonePath, const QString& outputPath,
+		QPromise<QString>* promise = nullptr);
+}
@@ -0,0 +1,111 @@
+#include "LocalHttpServer.h"
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <algorithm>
+
+LocalHttpServer::LocalHttpServer(const QString& rootDir)
+	: m_rootDir(rootDir), m_context(nullptr), m_server(nullptr), m_port(0),
+	m_bytesServed(0), m_requestCount(0) {
+}
+
+LocalHttpServer::~LocalHttpServer() {
+	if (m_context) {
+		QMetaObject::invokeMethod(m_context, [this]() {
+			delete m_server;
+			m_server = nullptr;
+			}, Qt::BlockingQueuedConnection);
+		m_context->deleteLater();
+	}
+	m_thread.quit();
+	m_thread.wait();
+}
+
+bool LocalHttpServer::start() {
+	m_thread.start();
+	m_context = new QObject;
+	m_context->moveToThread(&m_thread);
+
+	bool listening = false;
+	QMetaObject::invokeMethod(m_context, [this, &listening]() {
+		m_server = new QTcpServer;
+		QObject::connect(m_server, &QTcpServer::newConnection, m_server, [this]() { handleConnection(); });
+		listening = m_server->listen(QHostAddress::LocalHost, 0);
+		m_port = m_server->serverPort();
+		}, Qt::BlockingQueuedConnection);
+	return listening;
+}
+
+QString LocalHttpServer::urlFor(const QString& fileName) const {
+	return QString("http://127.0.0.1:%1/%2").arg(m_port).arg(fileName);
+}
+
+void LocalHttpServer::resetCounters() {
+	m_bytesServed = 0;
+	m_requestCount = 0;
+}
+
+void LocalHttpServer::handleConnection() {
+	while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+		QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+		QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+			// 连接保持打开，一次可能收到多个请求
+			QByteArray pending = socket->property("pending").toByteArray() + socket->readAll();
+			int headerEnd;
+			while ((headerEnd = pending.indexOf("\r\n\r\n")) >= 0) {
+				const QByteArray header = pending.left(headerEnd);
+				pending.remove(0, headerEnd + 4);
+				++m_requestCount;
+
+				const QList<QByteArray> lines = header.split('\n');
+				const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+				const QByteArray method = requestLine.value(0);
+				const QString name = QString::fromUtf8(QByteArray::fromPercentEncoding(requestLine.value(1).mid(1)));
+
+				QFile file(QDir(m_rootDir).filePath(name));
+				if (name.contains("..") || !file.open(QIODevice::ReadOnly)) {
+					socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+					continue;
+				}
+				const qint64 size = file.size();
+
+				// 只支持单段 Range：bytes=start-end
+				qint64 start = 0, end = size - 1;
+				bool partial = false;
+				static const QRegularExpression rangePattern("^range:\\s*bytes=(\\d*)-(\\d*)", QRegularExpression::CaseInsensitiveOption);
+				for (const QByteArray& line : lines) {
+					const QRegularExpressionMatch match = rangePattern.match(QString::fromLatin1(line.trimmed()));
+					if (!match.hasMatch()) continue;
+					if (!match.captured(1).isEmpty()) start = match.captured(1).toLongLong();
+					if (!match.captured(2).isEmpty()) end = std::min(size - 1, match.captured(2).toLongLong());
+					partial = true;
+				}
+				if (start > end || start >= size) {
+					socket->write(QString("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%1\r\nContent-Length: 0\r\n\r\n")
+						.arg(size).toLatin1());
+					continue;
+				}
+
+				const qint64 length = end - start + 1;
+				QByteArray response = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+				response += "Accept-Ranges: bytes\r\nContent-Type: application/octet-stream\r\n";
+				response += "Content-Length: " + QByteArray::number(method == "HEAD" ? size : length) + "\r\n";
+				if (partial) {
+					response += "Content-Range: bytes " + QByteArray::number(start) + "-" + QByteArray::number(end) +
+						"/" + QByteArray::number(size) + "\r\n";
+				}
+				response += "\r\n";
+				socket->write(response);
+
+				if (method != "HEAD") {
+					file.seek(start);
+					socket->write(file.read(length));
+					m_bytesServed += length;
+				}
+			}
+			socket->setProperty("pending", pending);
+			});
+	}
+}
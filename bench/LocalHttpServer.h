@@ -0,0 +1,33 @@
+#pragma once
+#include <QString>
+#include <QThread>
+#include <atomic>
+
+class QTcpServer;
+class QObject;
+
+// 基准测试用的本地 HTTP 服务：在独立线程中提供目录下的文件，支持 HEAD 与单段 Range 请求，
+// 统计实际传输的字节数，用于验证 /vsicurl 只读取了所需的数据块
+class LocalHttpServer {
+public:
+	explicit LocalHttpServer(const QString& rootDir);
+	~LocalHttpServer();
+
+	bool start();
+	QString urlFor(const QString& fileName) const;
+
+	qint64 bytesServed() const { return m_bytesServed.load(); }
+	int requestCount() const { return m_requestCount.load(); }
+	void resetCounters();
+
+private:
+	void handleConnection();
+
+	QString m_rootDir;
+	QThread m_thread;
+	QObject* m_context;	//在服务线程中执行的回调的上下文
+	QTcpServer* m_server;
+	quint16 m_port;
+	std::atomic<qint64> m_bytesServed;
+	std::atomic<int> m_requestCount;
+};
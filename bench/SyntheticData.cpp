@@ -0,0 +1,195 @@
+#include "SyntheticData.h"
+#include <QDir>
+#include <QFileInfo>
+#include <cmath>
+#include <vector>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+
+namespace {
+	// 所有合成数据共用的地理参考：UTM 50N 下 10 米分辨率
+	const double kOriginX = 500000.0;
+	const double kOriginY = 4000000.0;
+	const double kPixelSize = 10.0;
+
+	void setBenchSpatialRef(OGRSpatialReference& srs) {
+		srs.SetWellKnownGeogCS("WGS84");
+		srs.SetUTM(50, TRUE);
+	}
+}
+
+QString SyntheticData::createRaster(const QString& dir, int width, int height, int bandCount,
+	GDALDataType dataType, bool withOverviews) {
+	const QString path = QDir(dir).filePath(QString("raster_%1x%2_b%3_%4%5.tif")
+		.arg(width).arg(height).arg(bandCount).arg(GDALGetDataTypeName(dataType))
+		.arg(withOverviews ? "_ovr" : ""));
+	if (QFileInfo::exists(path)) return path;
+
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+	if (!driver) return QString();
+
+	char** options = nullptr;
+	options = CSLSetNameValue(options, "TILED", "YES");
+	options = CSLSetNameValue(options, "BIGTIFF", "IF_NEEDED");
+	GDALDataset* dataset = driver->Create(path.toUtf8().constData(), width, height, bandCount, dataType, options);
+	CSLDestroy(options);
+	if (!dataset) return QString();
+
+	double geoTransform[6] = { kOriginX, kPixelSize, 0.0, kOriginY, 0.0, -kPixelSize };
+	dataset->SetGeoTransform(geoTransform);
+	OGRSpatialReference srs;
+	setBenchSpatialRef(srs);
+	char* wkt = nullptr;
+	srs.exportToWkt(&wkt);
+	dataset->SetProjection(wkt);
+	CPLFree(wkt);
+
+	// 按 256 行一批写入，避免整幅影像常驻内存
+	const double maxValue = dataType == GDT_UInt16 ? 65535.0 : 255.0;
+	const int rowsPerChunk = 256;
+	std::vector<double> buffer(static_cast<size_t>(width) * rowsPerChunk);
+	for (int band = 1; band <= bandCount; ++band) {
+		GDALRasterBand* rasterBand = dataset->GetRasterBand(band);
+		for (int row0 = 0; row0 < height; row0 += rowsPerChunk) {
+			const int rows = std::min(rowsPerChunk, height - row0);
+			for (int r = 0; r < rows; ++r) {
+				for (int c = 0; c < width; ++c) {
+					const double gradient = 0.5 + 0.25 * std::sin((c + band * 97) * 0.01) + 0.25 * std::cos((row0 + r) * 0.013);
+					const double noise = ((c * 7919 + (row0 + r) * 104729 + band * 31) % 97) / 970.0;
+					buffer[static_cast<size_t>(r) * width + c] = std::min(1.0, gradient + noise) * maxValue;
+				}
+			}
+			if (rasterBand->RasterIO(GF_Write, 0, row0, width, rows, buffer.data(), width, rows, GDT_Float64, 0, 0, nullptr) != CE_None) {
+				GDALClose(dataset);
+				return QString();
+			}
+		}
+	}
+
+	if (withOverviews) {
+		int levels[] = { 2, 4, 8, 16, 32 };
+		dataset->BuildOverviews("AVERAGE", 5, levels, 0, nullptr, GDALDummyProgress, nullptr);
+	}
+	GDALClose(dataset);
+	return path;
+}
+
+QString SyntheticData::createNoDataVrt(const QString& dir, const QString& sourcePath, double noData) {
+	const QString path = QDir(dir).filePath(QFileInfo(sourcePath).completeBaseName() + "_nodata.vrt");
+	if (QFileInfo::exists(path)) return path;
+
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("VRT");
+	GDALDataset* source = static_cast<GDALDataset*>(GDALOpen(sourcePath.toUtf8().constData(), GA_ReadOnly));
+	if (!driver || !source) {
+		if (source) GDALClose(source);
+		return QString();
+	}
+	GDALDataset* vrt = driver->CreateCopy(path.toUtf8().constData(), source, FALSE, nullptr, GDALDummyProgress, nullptr);
+	GDALClose(source);
+	if (!vrt) return QString();
+	for (int band = 1; band <= vrt->GetRasterCount(); ++band) {
+		vrt->GetRasterBand(band)->SetNoDataValue(noData);
+	}
+	GDALClose(vrt);	//关闭时写出 VRT 文件
+	return path;
+}
+
+QString SyntheticData::createCog(const QString& dir, const QString& sourcePath) {
+	const QString path = QDir(dir).filePath(QFileInfo(sourcePath).completeBaseName() + "_cog.tif");
+	if (QFileInfo::exists(path)) return path;
+
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+	GDALDataset* source = static_cast<GDALDataset*>(GDALOpen(sourcePath.toUtf8().constData(), GA_ReadOnly));
+	if (!driver || !source) {
+		if (source) GDALClose(source);
+		return QString();
+	}
+
+	char** options = nullptr;
+	options = CSLSetNameValue(options, "TILED", "YES");
+	options = CSLSetNameValue(options, "BLOCKXSIZE", "256");
+	options = CSLSetNameValue(options, "BLOCKYSIZE", "256");
+	options = CSLSetNameValue(options, "COMPRESS", "DEFLATE");
+	options = CSLSetNameValue(options, "COPY_SRC_OVERVIEWS", "YES");
+	options = CSLSetNameValue(options, "BIGTIFF", "IF_NEEDED");
+	GDALDataset* cog = driver->CreateCopy(path.toUtf8().constData(), source, FALSE, options, GDALDummyProgress, nullptr);
+	CSLDestroy(options);
+	GDALClose(source);
+	if (!cog) return QString();
+	GDALClose(cog);
+	return path;
+}
+
+QString SyntheticData::createShapefile(const QString& dir, int featureCount, OGRwkbGeometryType geometryType, double offset) {
+	const QString path = QDir(dir).filePath(QString("vector_%1_%2%3.shp")
+		.arg(featureCount).arg(OGRGeometryTypeToName(geometryType))
+		.arg(offset != 0.0 ? QString("_offset%1").arg(offset) : QString()).remove(' '));
+	if (QFileInfo::exists(path)) return path;
+
+	GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("ESRI Shapefile");
+	if (!driver) return QString();
+	GDALDataset* dataset = driver->Create(path.toUtf8().constData(), 0, 0, 0, GDT_Unknown, nullptr);
+	if (!dataset) return QString();
+
+	OGRSpatialReference srs;
+	setBenchSpatialRef(srs);
+	OGRLayer* layer = dataset->CreateLayer("bench", &srs, geometryType, nullptr);
+	if (!layer) {
+		GDALClose(dataset);
+		return QString();
+	}
+
+	OGRFieldDefn idField("id", OFTInteger);
+	OGRFieldDefn nameField("name", OFTString);
+	nameField.SetWidth(16);
+	OGRFieldDefn valueField("value", OFTReal);
+	layer->CreateField(&idField);
+	layer->CreateField(&nameField);
+	layer->CreateField(&valueField);
+
+	// 要素排成近似正方形的网格，单元大小 100 米
+	const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(featureCount)))));
+	const double cell = 100.0;
+	OGRFeature* feature = OGRFeature::CreateFeature(layer->GetLayerDefn());
+	for (int i = 0; i < featureCount; ++i) {
+		const double x = kOriginX + offset + (i % columns) * cell;
+		const double y = kOriginY - offset - (i / columns) * cell;
+
+		feature->SetFID(OGRNullFID);
+		feature->SetField(0, i);
+		feature->SetField(1, QString("class_%1").arg(i % 12).toUtf8().constData());
+		feature->SetField(2, std::fmod(i * 0.618, 100.0));
+
+		switch (wkbFlatten(geometryType)) {
+		case wkbPoint: {
+			OGRPoint point(x + cell / 2, y - cell / 2);
+			feature->SetGeometry(&point);
+			break;
+		}
+		case wkbLineString: {
+			OGRLineString line;
+			for (int v = 0; v < 10; ++v) {
+				line.addPoint(x + v * cell / 10, y - ((v % 2) ? cell * 0.8 : cell * 0.2));
+			}
+			feature->SetGeometry(&line);
+			break;
+		}
+		default: {
+			OGRLinearRing ring;
+			ring.addPoint(x + 10, y - 10);
+			ring.addPoint(x + cell - 10, y - 10);
+			ring.addPoint(x + cell - 10, y - cell + 10);
+			ring.addPoint(x + 10, y - cell + 10);
+			ring.closeRings();
+			OGRPolygon polygon;
+			polygon.addRing(&ring);
+			feature->SetGeometry(&polygon);
+			break;
+		}
+		}
+		layer->CreateFeature(feature);
+	}
+	OGRFeature::DestroyFeature(feature);
+	GDALClose(dataset);
+	return path;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <QString>
+#include <gdal.h>
+#include <ogr_core.h>
+
+// 基准测试用的合成数据：按尺寸、波段数、数据类型生成 GeoTIFF，按要素数、几何类型生成 Shapefile
+namespace SyntheticData {
+	// 生成 width x height 的分块 GeoTIFF，像素为渐变加噪声；withOverviews 时同时建立金字塔
+	QString createRaster(const QString& dir, int width, int height, int bandCount,
+		GDALDataType dataType, bool withOverviews = true);
+
+	// 由带金字塔的栅格生成云优化 GeoTIFF（分块、DEFLATE 压缩，金字塔内嵌在文件开头之后）
+	QString createCog(const QString& dir, const QString& sourcePath);
+
+	// 引用源栅格的 VRT，各波段设置 NoData，解码时需要读取掩膜
+	QString createNoDataVrt(const QString& dir, const QString& sourcePath, double noData);
+
+	// 在规则网格上生成 featureCount 个要素（点 / 折线 / 正方形面），带 id、name、value 三个字段；
+	// offset 为网格整体向东南平移的距离（米），用于生成相互错开的叠加图层
+	QString createShapefile(const QString& dir, int featureCount, OGRwkbGeometryType geometryType, double offset = 0.0);
+}
@@ -0,0 +1,653 @@
+// YGIS 无界面基准测试
+// 用法：QT_QPA_PLATFORM=offscreen ./ygis_bench [--benchmark_filter=...]
+// 环境变量 YGIS_BENCH_SCALE 按比例放大/缩小合成数据（默认 1）
+#include <benchmark/benchmark.h>
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QImage>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QDir>
+#include <QDebug>
+#include <QSettings>
+#include <QFileInfo>
+#include <cstdio>
+#include <gdal_priv.h>
+#include <ogrsf_frmts.h>
+#include <cpl_vsi.h>
+#include "SyntheticData.h"
+#include "LocalHttpServer.h"
+#include "RasterLayerItem.h"
+#include "VectorLayerItem.h"
+#include "MapWidget.h"
+#include "RasterInfoWidget.h"
+#include "VectorElement.h"
+#include "VsiSupport.h"
+#include "GdalRuntime.h"
+#include "RasterCalculator.h"
+#include "ZonalStatistics.h"
+#include "RasterClip.h"
+#include "VectorOverlay.h"
+#include "DataConversion.h"
+#include "PixelSampler.h"
+#include "ThematicStyle.h"
+#include "DatasetPool.h"
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace {
+	QString g_dataDir;
+	LocalHttpServer* g_httpServer = nullptr;
+
+	// 进程峰值常驻内存（MB）；Linux 下 ru_maxrss 单位为 KB
+	double peakRssMB() {
+#ifdef __linux__
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) == 0) return usage.ru_maxrss / 1024.0;
+#endif
+		return 0.0;
+	}
+
+	void reportPeakRss(benchmark::State& state) {
+		state.counters["peak_rss_MB"] = benchmark::Counter(peakRssMB());
+	}
+
+	int scaled(int value) {
+		bool ok = false;
+		const double scale = qEnvironmentVariable("YGIS_BENCH_SCALE").toDouble(&ok);
+		return ok && scale > 0 ? std::max(1, static_cast<int>(value * scale)) : value;
+	}
+
+	void deleteDataset(const QString& path, const char* driverName) {
+		if (GDALDriver* driver = GetGDALDriverManager()->GetDriverByName(driverName)) {
+			CPLPushErrorHandler(CPLQuietErrorHandler);
+			driver->Delete(path.toUtf8().constData());
+			CPLPopErrorHandler();
+		}
+	}
+
+	// 全分辨率逐块解码整幅影像（与 RasterLayerItem 瓦片线程的读取路径一致）
+	void BM_DecodeRaster(benchmark::State& state, QString path) {
+		GDALDataset* dataset = static_cast<GDALDataset*>(GDALOpen(path.toUtf8().constData(), GA_ReadOnly));
+		if (!dataset) {
+			state.SkipWithError("无法打开栅格");
+			return;
+		}
+		const int width = dataset->GetRasterXSize();
+		const int height = dataset->GetRasterYSize();
+		const int tile = RasterLayerItem::TileSize;
+		const int bytesPerPixel = GDALGetDataTypeSizeBytes(dataset->GetRasterBand(1)->GetRasterDataType()) * dataset->GetRasterCount();
+
+		// 单波段（任意数据类型）须解码为灰度：每个像素的 R、G、B 相同
+		if (dataset->GetRasterCount() == 1) {
+			const QImage first = RasterLayerItem::decodeTile(dataset, QRect(0, 0, std::min(tile, width), std::min(tile, height)),
+				QSize(std::min(tile, width), std::min(tile, height)));
+			for (int y = 0; y < first.height(); ++y) {
+				const QRgb* pixels = reinterpret_cast<const QRgb*>(first.constScanLine(y));
+				for (int x = 0; x < first.width(); ++x) {
+					if (qRed(pixels[x]) != qGreen(pixels[x]) || qGreen(pixels[x]) != qBlue(pixels[x])) {
+						state.SkipWithError("单波段解码结果不是灰度");
+						GDALClose(dataset);
+						return;
+					}
+				}
+			}
+		}
+
+		for (auto _ : state) {
+			for (int y = 0; y < height; y += tile) {
+				for (int x = 0; x < width; x += tile) {
+					const QRect window(x, y, std::min(tile, width - x), std::min(tile, height - y));
+					QImage image = RasterLayerItem::decodeTile(dataset, window, window.size());
+					benchmark::DoNotOptimize(image.constBits());
+				}
+			}
+		}
+		state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(width) * height * bytesPerPixel);
+		reportPeakRss(state);
+		GDALClose(dataset);
+	}
+
+	// 瓦片合成：64 块预乘 ARGB 瓦片以给定混合方式与 60% 不透明度画到底图上
+	void BM_ComposeTiles(benchmark::State& state, QPainter::CompositionMode mode) {
+		const int tile = RasterLayerItem::TileSize;
+		QImage canvas(tile * 8, tile * 8, QImage::Format_ARGB32_Premultiplied);
+		QImage source(tile, tile, QImage::Format_ARGB32_Premultiplied);
+		for (int y = 0; y < tile; ++y) {
+			QRgb* pixels = reinterpret_cast<QRgb*>(source.scanLine(y));
+			for (int x = 0; x < tile; ++x) {
+				pixels[x] = (x + y) % 16 == 0 ? 0 : qRgba(x, y, 128, 255);	//夹杂透明像素
+			}
+		}
+		for (auto _ : state) {
+			canvas.fill(QColor(200, 180, 160));
+			QPainter painter(&canvas);
+			painter.setOpacity(0.6);
+			painter.setCompositionMode(mode);
+			for (int ty = 0; ty < 8; ++ty) {
+				for (int tx = 0; tx < 8; ++tx) {
+					painter.drawImage(tx * tile, ty * tile, source);
+				}
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * 64 * tile * tile);
+	}
+
+	// 浮点 DEM 全分辨率逐块计算地形瓦片（带一个像元的边缘）
+	void BM_DecodeTerrain(benchmark::State& state, QString path, RasterLayerItem::RenderMode mode) {
+		GDALDataset* dataset = static_cast<GDALDataset*>(GDALOpen(path.toUtf8().constData(), GA_ReadOnly));
+		if (!dataset) {
+			state.SkipWithError("无法打开栅格");
+			return;
+		}
+		const int width = dataset->GetRasterXSize();
+		const int height = dataset->GetRasterYSize();
+		const int tile = RasterLayerItem::TileSize;
+		RasterLayerItem::T_TerrainParams params;
+		params.mode = mode;
+		params.cellWidth = params.cellHeight = 10.0;
+
+		for (auto _ : state) {
+			for (int y = 0; y < height; y += tile) {
+				for (int x = 0; x < width; x += tile) {
+					const QRect window(x, y, std::min(tile, width - x), std::min(tile, height - y));
+					QImage image = RasterLayerItem::decodeTerrain(dataset, window, window.size(), params);
+					benchmark::DoNotOptimize(image.constBits());
+				}
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(width) * height);
+		reportPeakRss(state);
+		GDALClose(dataset);
+	}
+
+	// 缩小到 1/16 显示：通过缓冲区降采样读取，GDAL 自动选用金字塔
+	void BM_DecodeOverview(benchmark::State& state, QString path) {
+		GDALDataset* dataset = static_cast<GDALDataset*>(GDALOpen(path.toUtf8().constData(), GA_ReadOnly));
+		if (!dataset) {
+			state.SkipWithError("无法打开栅格");
+			return;
+		}
+		const int width = dataset->GetRasterXSize();
+		const int height = dataset->GetRasterYSize();
+		const int span = RasterLayerItem::TileSize * 16;
+		int64_t tiles = 0;
+
+		for (auto _ : state) {
+			for (int y = 0; y < height; y += span) {
+				for (int x = 0; x < width; x += span) {
+					const QRect window(x, y, std::min(span, width - x), std::min(span, height - y));
+					const QSize bufSize(std::max(1, window.width() / 16), std::max(1, window.height() / 16));
+					QImage image = RasterLayerItem::decodeTile(dataset, window, bufSize);
+					benchmark::DoNotOptimize(image.constBits());
+					++tiles;
+				}
+			}
+		}
+		state.SetItemsProcessed(tiles);
+		reportPeakRss(state);
+		GDALClose(dataset);
+	}
+
+	// 通过 /vsicurl 从本地 HTTP 服务读取云优化 GeoTIFF；每轮清空 curl 缓存，
+	// 统计实际传输字节数与文件大小之比，验证只取回了所需的金字塔块 / 瓦片
+	void streamCog(benchmark::State& state, const QString& fileName, bool overview) {
+		const qint64 fileSize = QFileInfo(QDir(g_dataDir).filePath(fileName)).size();
+		const QString gdalPath = VsiSupport::toGdalPath(g_httpServer->urlFor(fileName));
+		g_httpServer->resetCounters();
+		int64_t iterations = 0;
+
+		for (auto _ : state) {
+			VSICurlClearCache();
+			GDALDataset* dataset = static_cast<GDALDataset*>(GDALOpen(gdalPath.toUtf8().constData(), GA_ReadOnly));
+			if (!dataset) {
+				state.SkipWithError("无法通过 /vsicurl 打开栅格");
+				return;
+			}
+			const int width = dataset->GetRasterXSize();
+			const int height = dataset->GetRasterYSize();
+			const int tile = RasterLayerItem::TileSize;
+			// overview：整幅影像缩到一张瓦片；否则读取中心处一张全分辨率瓦片
+			const QRect window = overview ? QRect(0, 0, width, height)
+				: QRect((width / 2 / tile) * tile, (height / 2 / tile) * tile, std::min(tile, width), std::min(tile, height));
+			QImage image = RasterLayerItem::decodeTile(dataset, window, overview ? QSize(tile, tile) : window.size());
+			benchmark::DoNotOptimize(image.constBits());
+			GDALClose(dataset);
+			++iterations;
+		}
+		const double bytesPerIteration = iterations > 0 ? static_cast<double>(g_httpServer->bytesServed()) / iterations : 0.0;
+		state.counters["fetched_KB"] = benchmark::Counter(bytesPerIteration / 1024.0);
+		state.counters["fetched_ratio"] = benchmark::Counter(fileSize > 0 ? bytesPerIteration / fileSize : 0.0);
+		state.counters["requests"] = benchmark::Counter(iterations > 0 ? static_cast<double>(g_httpServer->requestCount()) / iterations : 0.0);
+		reportPeakRss(state);
+	}
+
+	void BM_StreamCogOverview(benchmark::State& state, QString fileName) {
+		streamCog(state, fileName, true);
+	}
+
+	void BM_StreamCogWindow(benchmark::State& state, QString fileName) {
+		streamCog(state, fileName, false);
+	}
+
+	// 读取全部要素、转换为场景几何并建立空间索引（关闭几何缓存，每轮都经过 OGR）
+	void BM_VectorLoad(benchmark::State& state, QString path) {
+		QSettings().setValue("vector/geometryCache", false);
+		int features = 0;
+		qint64 geometryBytes = 0;
+		for (auto _ : state) {
+			VectorLayerItem item(path);
+			if (!item.load()) {
+				state.SkipWithError("无法读取矢量");
+				return;
+			}
+			features = item.featureCount();
+			geometryBytes = item.memoryUsage();
+			benchmark::DoNotOptimize(features);
+		}
+		state.SetItemsProcessed(state.iterations() * features);
+		state.counters["geometry_MB"] = benchmark::Counter(geometryBytes / (1024.0 * 1024.0));
+		reportPeakRss(state);
+	}
+
+	// 几何缓存已写好时的打开耗时：只映射缓存文件，不经过 OGR
+	void BM_VectorLoadMapped(benchmark::State& state, QString path) {
+		QSettings().setValue("vector/geometryCache", true);
+		{
+			VectorLayerItem warmup(path);	//首次打开写入缓存
+			if (!warmup.load()) {
+				state.SkipWithError("无法读取矢量");
+				return;
+			}
+		}
+		int features = 0;
+		for (auto _ : state) {
+			VectorLayerItem item(path);
+			item.load();
+			features = item.featureCount();
+			benchmark::DoNotOptimize(features);
+		}
+		state.SetItemsProcessed(state.iterations() * features);
+		reportPeakRss(state);
+	}
+
+	// 将整个图层绘制到 1920x1080 的离屏图像
+	void BM_VectorPaint(benchmark::State& state, QString path) {
+		VectorLayerItem item(path);
+		if (!item.load()) {
+			state.SkipWithError("无法读取矢量");
+			return;
+		}
+		QImage canvas(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+		const QRectF extent = item.boundingRect();
+		const double scale = std::min(canvas.width() / extent.width(), canvas.height() / extent.height());
+
+		QStyleOptionGraphicsItem option;
+		option.exposedRect = extent;
+		for (auto _ : state) {
+			canvas.fill(Qt::white);
+			QPainter painter(&canvas);
+			painter.setRenderHint(QPainter::Antialiasing);
+			painter.scale(scale, scale);
+			painter.translate(-extent.topLeft());
+			item.paint(&painter, &option, nullptr);
+		}
+		state.SetItemsProcessed(state.iterations() * item.featureCount());
+		reportPeakRss(state);
+	}
+
+	void BM_CreateBuffer(benchmark::State& state, QString path) {
+		MapWidget mapWidget;
+		const QString outputPath = QDir(g_dataDir).filePath("bench_buffer.shp");
+		for (auto _ : state) {
+			state.PauseTiming();
+			deleteDataset(outputPath, "ESRI Shapefile");
+			state.ResumeTiming();
+			if (!mapWidget.createBuffer(path, outputPath, 20.0)) {
+				state.SkipWithError("缓冲区分析失败");
+				return;
+			}
+		}
+		reportPeakRss(state);
+	}
+
+	void BM_ResampleRaster(benchmark::State& state, QString path) {
+		RasterInfoWidget rasterInfo;
+		const QString outputPath = QDir(g_dataDir).filePath("bench_resampled.tif");
+		for (auto _ : state) {
+			state.PauseTiming();
+			deleteDataset(outputPath, "GTiff");
+			state.ResumeTiming();
+			if (!rasterInfo.ResampleRaster(path, outputPath, GRA_Bilinear, 0.5)) {
+				state.SkipWithError("重采样失败");
+				return;
+			}
+		}
+		reportPeakRss(state);
+	}
+
+	// 栅格计算器：按块流式求 NDVI 类表达式并写出压缩 GeoTIFF
+	void BM_RasterCalculator(benchmark::State& state, QString path) {
+		const QString outputPath = QDir(g_dataDir).filePath("bench_calc.tif");
+		for (auto _ : state) {
+			state.PauseTiming();
+			deleteDataset(outputPath, "GTiff");
+			state.ResumeTiming();
+			const QString error = RasterCalculator::calculate(path, "(B3-B2)/(B3+B2)", outputPath);
+			if (!error.isEmpty()) {
+				state.SkipWithError(error.toUtf8().constData());
+				return;
+			}
+		}
+		reportPeakRss(state);
+	}
+
+	// 分区统计：面网格覆盖在栅格上，逐面栅格化并只读取覆盖的块
+	void BM_ZonalStatistics(benchmark::State& state, QString rasterPath, QString zonePath) {
+		const QString outputPath = QDir(g_dataDir).filePath("bench_zonal.shp");
+		for (auto _ : state) {
+			const QString error = ZonalStatistics::compute(rasterPath, 1, zonePath, outputPath);
+			if (!error.isEmpty()) {
+				state.SkipWithError(error.toUtf8().constData());
+				return;
+			}
+		}
+		reportPeakRss(state);
+	}
+
+	// 栅格裁剪：从大幅影像中截取 512 x 512 像元，耗时应与源影像大小无关
+	void BM_ClipRaster(benchmark::State& state, QString path) {
+		const QString outputPath = QDir(g_dataDir).filePath("bench_clip.tif");
+		DatasetHandle dataset = DatasetPool::instance().acquire(path);
+		double geoTransform[6];
+		if (!dataset || dataset->GetGeoTransform(geoTransform) != CE_None) {
+			state.SkipWithError("无法打开栅格");
+			return;
+		}
+		const double centerX = geoTransform[0] + dataset->GetRasterXSize() / 2 * geoTransform[1];
+		const double centerY = geoTransform[3] + dataset->GetRasterYSize() / 2 * geoTransform[5];
+		const double halfSize = 256 * geoTransform[1];
+		dataset.reset();
+		const QRectF extent(centerX - halfSize, centerY - halfSize, 2 * halfSize, 2 * halfSize);
+		for (auto _ : state) {
+			const QString error = RasterClip::clipToExtent(path, extent, outputPath);
+			if (!error.isEmpty()) {
+				state.SkipWithError(error.toUtf8().constData());
+				return;
+			}
+		}
+		reportPeakRss(state);
+	}
+
+	// 叠加分析：面网格与错开半个单元的面网格求交，每个输入要素与 4 个面相交
+	void BM_VectorOverlay(benchmark::State& state, QString inputPath, QString overlayPath) {
+		const QString outputPath = QDir(g_dataDir).filePath("bench_overlay.shp");
+		for (auto _ : state) {
+			const QString error = VectorOverlay::run(VectorOverlay::Intersect, inputPath, overlayPath, outputPath);
+			if (!error.isEmpty()) {
+				state.SkipWithError(error.toUtf8().constData());
+				return;
+			}
+		}
+		reportPeakRss(state);
+	}
+
+	// 面要素按数值字段栅格化（分块并行）
+	void BM_Rasterize(benchmark::State& state, QString vectorPath, double pixelSize) {
+		const QString outputPath = QDir(g_dataDir).filePath("bench_rasterize.tif");
+		for (auto _ : state) {
+			const QString error = DataConversion::rasterize(vectorPath, "value", pixelSize, outputPath);
+			if (!error.isEmpty()) {
+				state.SkipWithError(error.toUtf8().constData());
+				return;
+			}
+		}
+		reportPeakRss(state);
+	}
+
+	// 专题符号化：字段在计时前读取并缓存，计时的是换分级数时的重新归类（求断点并为每个要素归类）
+	void BM_ThematicClassify(benchmark::State& state, QString path, int method) {
+		VectorLayerItem item(path);
+		T_VectorStyle style;
+		style.mode = ThematicStyle::Graduated;
+		style.field = "value";
+		style.method = method;
+		if (!item.load() || !item.setStyle(style).isEmpty()) {
+			state.SkipWithError("无法读取字段");
+			return;
+		}
+		for (auto _ : state) {
+			style.classCount = style.classCount == 5 ? 7 : 5;	//每轮样式不同，避免直接返回
+			const QString error = item.setStyle(style);
+			if (!error.isEmpty()) {
+				state.SkipWithError(error.toUtf8().constData());
+				return;
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * item.featureCount());
+		reportPeakRss(state);
+	}
+
+	// 标注：放大到图层的 1/4 后逐帧平移。warm 时布局沿用上一帧，cold 时每帧改字号使布局作废
+	void BM_LabelPan(benchmark::State& state, QString path, bool warm) {
+		VectorLayerItem item(path);
+		T_LabelStyle label;
+		label.field = "name";
+		if (!item.load() || !item.setLabel(label).isEmpty()) {
+			state.SkipWithError("无法读取字段");
+			return;
+		}
+		QImage canvas(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+		const QRectF extent = item.boundingRect();
+		const double scale = 4.0 * std::min(canvas.width() / extent.width(), canvas.height() / extent.height());
+
+		QStyleOptionGraphicsItem option;
+		int frame = 0;
+		for (auto _ : state) {
+			if (!warm) {
+				label.fontSize = label.fontSize == 9 ? 10 : 9;
+				item.setLabel(label);
+			}
+			const QPointF origin = extent.topLeft() + QPointF((frame++ % 64) * 10.0 / scale, 0.0);
+			option.exposedRect = QRectF(origin, QSizeF(canvas.width() / scale, canvas.height() / scale));
+			canvas.fill(Qt::white);
+			QPainter painter(&canvas);
+			painter.scale(scale, scale);
+			painter.translate(-origin);
+			item.paint(&painter, &option, nullptr);
+		}
+		state.counters["cached_levels"] = benchmark::Counter(item.cachedLabelLevels());
+		reportPeakRss(state);
+	}
+
+	// 模拟鼠标悬停：沿一条折线逐像元移动取值，块缓存命中时不访问文件
+	void BM_PixelHover(benchmark::State& state, QString path) {
+		PixelSampler sampler(path);
+		if (!sampler.open()) {
+			state.SkipWithError("无法打开栅格");
+			return;
+		}
+		int64_t samples = 0;
+		int column = sampler.width() / 3;
+		int row = sampler.height() / 3;
+		for (auto _ : state) {
+			column = (column + 1) % sampler.width();
+			if (samples % 7 == 0) row = (row + 1) % sampler.height();
+			benchmark::DoNotOptimize(sampler.sample(column, row));
+			++samples;
+		}
+		state.SetItemsProcessed(samples);
+		state.counters["cached_blocks"] = benchmark::Counter(sampler.cachedBlocks());
+	}
+
+	// 整幅影像对角线剖面：只读取沿线经过的块
+	void BM_RasterProfile(benchmark::State& state, QString path) {
+		for (auto _ : state) {
+			PixelSampler sampler(path);	//每轮新建，统计的是冷缓存下的读取
+			if (!sampler.open()) {
+				state.SkipWithError("无法打开栅格");
+				return;
+			}
+			const QVector<QPointF> points = sampler.profile(QPointF(0.5, 0.5), QPointF(sampler.width() - 0.5, sampler.height() - 0.5), 0);
+			benchmark::DoNotOptimize(points.constData());
+			state.counters["cached_blocks"] = benchmark::Counter(sampler.cachedBlocks());
+		}
+		reportPeakRss(state);
+	}
+
+	// 属性表填充
+	void BM_VectorElementInfo(benchmark::State& state, QString path) {
+		VectorElement element;
+		for (auto _ : state) {
+			element.vectorElementInfo(path);
+		}
+		reportPeakRss(state);
+	}
+}
+
+int main(int argc, char** argv) {
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+	QApplication app(argc, argv);
+	app.setApplicationName("ygis_bench"); // 设置与缓存目录和正式程序分开
+	benchmark::Initialize(&argc, argv);
+
+	GdalRuntime::initialize();
+	// 被测函数的逐步 qDebug 日志会淹没结果，只保留警告与错误
+	qInstallMessageHandler([](QtMsgType type, const QMessageLogContext&, const QString& message) {
+		if (type != QtDebugMsg && type != QtInfoMsg) fprintf(stderr, "%s\n", qPrintable(message));
+		});
+
+	QTemporaryDir tempDir;
+	if (!tempDir.isValid()) return 1;
+	g_dataDir = tempDir.path();
+
+	// 栅格：不同数据类型与波段数
+	struct RasterCase { const char* name; int size; int bands; GDALDataType type; };
+	const RasterCase rasterCases[] = {
+		{ "Byte_1band", scaled(4096), 1, GDT_Byte },
+		{ "Byte_3band", scaled(4096), 3, GDT_Byte },
+		{ "UInt16_1band", scaled(4096), 1, GDT_UInt16 },
+		{ "UInt16_3band", scaled(4096), 3, GDT_UInt16 },
+	};
+	for (const RasterCase& c : rasterCases) {
+		const QString path = SyntheticData::createRaster(g_dataDir, c.size, c.size, c.bands, c.type);
+		if (path.isEmpty()) return 1;
+		const std::string suffix = std::string(c.name) + "/" + std::to_string(c.size);
+		benchmark::RegisterBenchmark(("BM_DecodeRaster/" + suffix).c_str(), BM_DecodeRaster, path)->Unit(benchmark::kMillisecond);
+		benchmark::RegisterBenchmark(("BM_DecodeOverview/" + suffix).c_str(), BM_DecodeOverview, path)->Unit(benchmark::kMillisecond);
+	}
+
+	// 带 NoData 的 RGB 与灰度：解码时读取掩膜、转为透明并预乘；16 位与浮点单波段同时核对灰度
+	const RasterCase noDataCases[] = {
+		{ "Byte_1band", scaled(4096), 1, GDT_Byte },
+		{ "Byte_3band", scaled(4096), 3, GDT_Byte },
+		{ "UInt16_1band", scaled(4096), 1, GDT_UInt16 },
+		{ "Float32_1band", scaled(4096), 1, GDT_Float32 },
+	};
+	for (const RasterCase& c : noDataCases) {
+		const QString source = SyntheticData::createRaster(g_dataDir, c.size, c.size, c.bands, c.type);
+		const QString masked = SyntheticData::createNoDataVrt(g_dataDir, source, 128.0);
+		if (masked.isEmpty()) return 1;
+		benchmark::RegisterBenchmark(("BM_DecodeRaster/" + std::string(c.name) + "_nodata/" + std::to_string(c.size)).c_str(),
+			BM_DecodeRaster, masked)->Unit(benchmark::kMillisecond);
+	}
+	benchmark::RegisterBenchmark("BM_ComposeTiles/SourceOver", BM_ComposeTiles, QPainter::CompositionMode_SourceOver);
+	benchmark::RegisterBenchmark("BM_ComposeTiles/Multiply", BM_ComposeTiles, QPainter::CompositionMode_Multiply);
+
+	// 浮点 DEM：拉伸显示与三种地形显示
+	const QString demInput = SyntheticData::createRaster(g_dataDir, scaled(4096), scaled(4096), 1, GDT_Float32);
+	if (demInput.isEmpty()) return 1;
+	const std::string demSuffix = "Float32_1band/" + std::to_string(scaled(4096));
+	benchmark::RegisterBenchmark(("BM_DecodeRaster/" + demSuffix).c_str(), BM_DecodeRaster, demInput)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark(("BM_DecodeTerrain/Hillshade/" + demSuffix).c_str(), BM_DecodeTerrain, demInput,
+		RasterLayerItem::Hillshade)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark(("BM_DecodeTerrain/Slope/" + demSuffix).c_str(), BM_DecodeTerrain, demInput,
+		RasterLayerItem::Slope)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark(("BM_DecodeTerrain/Aspect/" + demSuffix).c_str(), BM_DecodeTerrain, demInput,
+		RasterLayerItem::Aspect)->Unit(benchmark::kMillisecond);
+
+	// 云优化 GeoTIFF 经本地 HTTP 服务流式读取
+	LocalHttpServer httpServer(g_dataDir);
+	if (httpServer.start()) {
+		g_httpServer = &httpServer;
+		const QString source = SyntheticData::createRaster(g_dataDir, scaled(8192), scaled(8192), 3, GDT_Byte);
+		const QString cog = SyntheticData::createCog(g_dataDir, source);
+		if (cog.isEmpty()) return 1;
+		const QString fileName = QFileInfo(cog).fileName();
+		const std::string suffix = "Byte_3band/" + std::to_string(scaled(8192));
+		benchmark::RegisterBenchmark(("BM_StreamCogOverview/" + suffix).c_str(), BM_StreamCogOverview, fileName)->Unit(benchmark::kMillisecond);
+		benchmark::RegisterBenchmark(("BM_StreamCogWindow/" + suffix).c_str(), BM_StreamCogWindow, fileName)->Unit(benchmark::kMillisecond);
+	}
+
+	const QString resampleInput = SyntheticData::createRaster(g_dataDir, scaled(2048), scaled(2048), 3, GDT_Byte, false);
+	benchmark::RegisterBenchmark("BM_ResampleRaster/Byte_3band/bilinear_0.5", BM_ResampleRaster, resampleInput)
+		->Unit(benchmark::kMillisecond);
+
+	const QString calculatorInput = SyntheticData::createRaster(g_dataDir, scaled(8192), scaled(8192), 3, GDT_UInt16, false);
+	benchmark::RegisterBenchmark(("BM_RasterCalculator/UInt16_3band/" + std::to_string(scaled(8192))).c_str(),
+		BM_RasterCalculator, calculatorInput)->Unit(benchmark::kMillisecond);
+
+	benchmark::RegisterBenchmark(("BM_PixelHover/UInt16_3band/" + std::to_string(scaled(8192))).c_str(),
+		BM_PixelHover, calculatorInput);
+	benchmark::RegisterBenchmark(("BM_RasterProfile/UInt16_3band/" + std::to_string(scaled(8192))).c_str(),
+		BM_RasterProfile, calculatorInput)->Unit(benchmark::kMillisecond);
+
+	const QString zoneInput = SyntheticData::createShapefile(g_dataDir, scaled(100000), wkbPolygon);
+	benchmark::RegisterBenchmark(("BM_ZonalStatistics/Polygon/" + std::to_string(scaled(100000))).c_str(),
+		BM_ZonalStatistics, calculatorInput, zoneInput)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark(("BM_ClipRaster/UInt16_3band/" + std::to_string(scaled(8192)) + "/512").c_str(),
+		BM_ClipRaster, calculatorInput)->Unit(benchmark::kMillisecond);
+
+	// 矢量：点 / 线 / 面，不同要素数
+	struct VectorCase { const char* name; OGRwkbGeometryType type; };
+	const VectorCase vectorCases[] = {
+		{ "Point", wkbPoint },
+		{ "LineString", wkbLineString },
+		{ "Polygon", wkbPolygon },
+	};
+	for (const VectorCase& c : vectorCases) {
+		for (int count : { scaled(10000), scaled(100000) }) {
+			const QString path = SyntheticData::createShapefile(g_dataDir, count, c.type);
+			if (path.isEmpty()) return 1;
+			const std::string suffix = std::string(c.name) + "/" + std::to_string(count);
+			benchmark::RegisterBenchmark(("BM_VectorLoad/" + suffix).c_str(), BM_VectorLoad, path)->Unit(benchmark::kMillisecond);
+			benchmark::RegisterBenchmark(("BM_VectorLoadMapped/" + suffix).c_str(), BM_VectorLoadMapped, path)->Unit(benchmark::kMillisecond);
+			benchmark::RegisterBenchmark(("BM_VectorPaint/" + suffix).c_str(), BM_VectorPaint, path)->Unit(benchmark::kMillisecond);
+		}
+	}
+
+	// 百万面要素：几何写入内存区、不解析属性时的加载耗时与峰值内存
+	const QString millionInput = SyntheticData::createShapefile(g_dataDir, scaled(1000000), wkbPolygon);
+	if (millionInput.isEmpty()) return 1;
+	benchmark::RegisterBenchmark(("BM_VectorLoad/Polygon/" + std::to_string(scaled(1000000))).c_str(), BM_VectorLoad, millionInput)
+		->Unit(benchmark::kMillisecond);
+
+	benchmark::RegisterBenchmark(("BM_ThematicClassify/EqualInterval/" + std::to_string(scaled(1000000))).c_str(),
+		BM_ThematicClassify, millionInput, int(ThematicStyle::EqualInterval))->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark(("BM_ThematicClassify/Quantile/" + std::to_string(scaled(1000000))).c_str(),
+		BM_ThematicClassify, millionInput, int(ThematicStyle::Quantile))->Unit(benchmark::kMillisecond);
+
+	const QString bufferInput = SyntheticData::createShapefile(g_dataDir, scaled(10000), wkbPoint);
+	benchmark::RegisterBenchmark(("BM_CreateBuffer/Point/" + std::to_string(scaled(10000))).c_str(), BM_CreateBuffer, bufferInput)
+		->Unit(benchmark::kMillisecond);
+
+	const QString overlayInput = SyntheticData::createShapefile(g_dataDir, scaled(100000), wkbPolygon, 50.0);
+	benchmark::RegisterBenchmark(("BM_VectorOverlay/Intersect/" + std::to_string(scaled(100000))).c_str(),
+		BM_VectorOverlay, zoneInput, overlayInput)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark(("BM_Rasterize/Polygon/" + std::to_string(scaled(100000))).c_str(),
+		BM_Rasterize, zoneInput, 5.0)->Unit(benchmark::kMillisecond);
+
+	for (bool warm : { false, true }) {
+		benchmark::RegisterBenchmark(((warm ? "BM_LabelPan/Warm/" : "BM_LabelPan/Cold/") + std::to_string(scaled(100000))).c_str(),
+			BM_LabelPan, zoneInput, warm)->Unit(benchmark::kMillisecond);
+	}
+
+	const QString tableInput = SyntheticData::createShapefile(g_dataDir, scaled(10000), wkbPolygon);
+	benchmark::RegisterBenchmark(("BM_VectorElementInfo/Polygon/" + std::to_string(scaled(10000))).c_str(), BM_VectorElementInfo, tableInput)
+		->Unit(benchmark::kMillisecond);
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
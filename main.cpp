@@ -4,8 +4,10 @@
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    a.setApplicationName("YGIS"); // 缓存目录与设置均按应用名存放
     YGIS w;
     w.setFixedSize(800, 600);
     w.show();
+    if (argc > 1) w.openProject(QString::fromLocal8Bit(argv[1])); // ygis project.ygis
     return a.exec();
 }